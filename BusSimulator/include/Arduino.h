@@ -0,0 +1,97 @@
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+/*
+ * Host shim for the subset of the Arduino/ESP8266 core used by the sketches.
+ * Time comes from the simulator clock, Serial output is counted and dropped
+ * (or echoed with --verbose).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x00
+#define OUTPUT 0x01
+#define INPUT_PULLUP 0x02
+
+#define MSBFIRST 1
+#define LSBFIRST 0
+
+// D1 mini pin labels (GPIO numbers)
+#define D0 16
+#define D1 5
+#define D2 4
+#define D3 0
+#define D4 2
+#define D5 14
+#define D6 12
+#define D7 13
+#define D8 15
+#define A0 17
+#define LED_BUILTIN 2
+
+#define F(x) (x)
+#define IRAM_ATTR
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+long random(long howbig);
+long random(long howsmall, long howbig);
+
+class HardwareSerial {
+public:
+    void begin(unsigned long baud);
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* buffer, size_t size);
+    int availableForWrite();
+    size_t print(const char* s);
+    size_t print(char c);
+    size_t print(long n);
+    size_t print(unsigned long n);
+    size_t print(int n) { return print((long)n); }
+    size_t print(unsigned int n) { return print((unsigned long)n); }
+    size_t print(double n, int digits = 2);
+    size_t println();
+    template <typename T>
+    size_t println(const T& value) { size_t n = print(value); return n + println(); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    void flush() {}
+    explicit operator bool() const { return true; }
+
+    /** Total bytes the sketch tried to push through this port. */
+    unsigned long bytesWritten() const { return _bytesWritten; }
+
+private:
+    size_t emit(const char* s, size_t len);
+    unsigned long _bytesWritten = 0;
+};
+
+extern HardwareSerial Serial;
+
+#endif // SIM_ARDUINO_H
@@ -0,0 +1,115 @@
+#ifndef SIM_PERIPHERAL_FACTORY_H
+#define SIM_PERIPHERAL_FACTORY_H
+
+/*
+ * Host shim for PeripheralsLib: actuators only remember their last state
+ * and count hardware writes so the simulator can report them.
+ */
+
+#include <Arduino.h>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class Peripheral {
+public:
+    virtual ~Peripheral() {}
+    virtual void update() {}
+};
+
+class RGBLED : public Peripheral {
+public:
+    RGBLED(uint8_t pin, uint16_t numPixels) : _pin(pin), _numPixels(numPixels) {}
+
+    void setColor(uint8_t r, uint8_t g, uint8_t b) { _r = r; _g = g; _b = b; }
+    void setBrightness(uint8_t brightness) { _brightness = brightness; }
+    void show() { _shows++; }
+
+    unsigned long shows() const { return _shows; }
+
+private:
+    uint8_t _pin;
+    uint16_t _numPixels;
+    uint8_t _r = 0, _g = 0, _b = 0;
+    uint8_t _brightness = 255;
+    unsigned long _shows = 0;
+};
+
+class Motor : public Peripheral {
+public:
+    Motor(int pinIA, int pinIB, int frequency) : _pinIA(pinIA), _pinIB(pinIB), _frequency(frequency) {}
+
+    void forward(int speed) { _duty = constrain(speed, 0, 1023); _writes++; }
+    void backward(int speed) { _duty = -constrain(speed, 0, 1023); _writes++; }
+    void stop() { _duty = 0; _writes++; }
+    void enableSpeedup(bool enable) { _speedup = enable; }
+    void setSpeedupConfig(float multiplier, unsigned long durationMs) { (void)multiplier; (void)durationMs; }
+    bool isSpeedupActive() const { return false; }
+
+    int duty() const { return _duty; }
+    unsigned long writes() const { return _writes; }
+
+private:
+    int _pinIA, _pinIB, _frequency;
+    int _duty = 0;
+    bool _speedup = false;
+    unsigned long _writes = 0;
+};
+
+class Atomizer : public Peripheral {
+public:
+    explicit Atomizer(uint8_t pin) : _pin(pin) {}
+
+    void toggle() { _target = !_target; }
+    bool getTargetState() const { return _target; }
+
+private:
+    uint8_t _pin;
+    bool _target = false;
+};
+
+// Calls a function every interval from update(), like PeripheralsLib's Periodic
+class Periodic : public Peripheral {
+public:
+    Periodic(unsigned long intervalMs, std::function<void()> callback)
+        : _intervalMs(intervalMs), _callback(callback), _last(millis()) {}
+
+    void update() override {
+        if (millis() - _last >= _intervalMs) {
+            _last += _intervalMs;
+            _callback();
+        }
+    }
+
+private:
+    unsigned long _intervalMs;
+    std::function<void()> _callback;
+    unsigned long _last;
+};
+
+class PeripheralFactory {
+public:
+    RGBLED* createRGBLED(uint8_t pin, uint16_t numPixels = 1) { return add(new RGBLED(pin, numPixels)); }
+    Motor* createMotor(int pinIA, int pinIB, int frequency = 1000) { return add(new Motor(pinIA, pinIB, frequency)); }
+    Atomizer* createAtomizer(uint8_t pin) { return add(new Atomizer(pin)); }
+    Periodic* createPeriodic(unsigned long intervalMs, std::function<void()> callback) {
+        return add(new Periodic(intervalMs, callback));
+    }
+
+    void update() {
+        for (auto& peripheral : _peripherals) {
+            peripheral->update();
+        }
+    }
+
+private:
+    template <typename T>
+    T* add(T* peripheral) {
+        _peripherals.emplace_back(peripheral);
+        return peripheral;
+    }
+
+    std::vector<std::unique_ptr<Peripheral>> _peripherals;
+};
+
+#endif // SIM_PERIPHERAL_FACTORY_H
@@ -0,0 +1,158 @@
+#ifndef SIM_COM_PROT_H
+#define SIM_COM_PROT_H
+
+/*
+ * Host shim for com-prot. ComProtMaster follows the PJON master branch used
+ * by OneWireHost, ComProtSlave the StarWire "twowire" branch used by
+ * OneWireSlave. Both speak the same frames as the library:
+ *   heartbeat [0x03, slaveId, slaveType, extension...]
+ *             [0x03, slaveId, slaveType | 0x80, interval, extension...] with a schedule
+ *   command   [0x04, targetType (0 = unicast), command, data...]
+ *   tdma sync [0x04, 0, STARWIRE_CMD_TDMA_SYNC, layout...] in slotted mode
+ * but move them over the simulated bus instead of GPIO. linkCounters() are
+ * what the bus model counted for the node.
+ */
+
+#include <Arduino.h>
+#include <heartbeat_schedule.h>
+#include <link_stats.h>
+#include <tdma.h>
+#include <vector>
+
+#define COM_PROT_HEARTBEAT 0x03
+#define COM_PROT_COMMAND 0x04
+#define COM_PROT_RESPONSE 0x05
+#define COM_PROT_HEARTBEAT_TIMEOUT 2000
+
+// ComProtSlave::setHeartbeatExtension() is available: bytes a sketch
+// returns are appended to every heartbeat, the master ignores them.
+#define COM_PROT_HEARTBEAT_EXTENSION 1
+#define COM_PROT_HEARTBEAT_EXTENSION_MAX 8
+
+// ComProtSlave::setHeartbeatSchedule() is available: heartbeats follow a
+// HeartbeatScheduler and announce their interval, the master times every
+// slave out on what it announced.
+#define COM_PROT_HEARTBEAT_SCHEDULE 1
+
+// ComProtMaster::setTdma() is available: the master beacons a TdmaLayout,
+// sends commands in its window only, and slaves that hear the beacon keep
+// to their slots on their own.
+#define COM_PROT_TDMA 1
+
+// ComProtMaster::linkCounters() and ComProtSlave::linkCounters() are
+// available: frames, bytes, CRC errors and busy retries since boot.
+#define COM_PROT_LINK_STATS 1
+
+typedef void (*DebugReceiveHandler)(uint8_t* payload, uint16_t length, uint8_t senderId, uint8_t messageType);
+
+namespace sim {
+class MasterPort;
+}
+
+struct SlaveInfo {
+    uint8_t id;
+    uint8_t type;
+    unsigned long lastHeartbeat;
+    uint32_t timeoutMs;
+};
+
+class ComProtMaster {
+public:
+    ComProtMaster(uint8_t masterId, uint8_t pin);
+
+    void begin();
+    void update();
+
+    void setDebugReceiveHandler(DebugReceiveHandler handler) { _debugHandler = handler; }
+    void removeDebugReceiveHandler() { _debugHandler = nullptr; }
+
+    /** Switches the bus to slotted mode from begin() on. */
+    void setTdma(const TdmaLayout& layout) {
+        _tdmaLayout = layout;
+        _tdma = true;
+    }
+
+    bool sendCommandToSlaveType(uint8_t slaveType, uint8_t command, const uint8_t* data = nullptr, uint8_t dataLen = 0);
+    bool sendCommandToSlaveId(uint8_t slaveId, uint8_t command, const uint8_t* data = nullptr, uint8_t dataLen = 0);
+
+    const LinkCounters& linkCounters() const;
+
+    std::vector<SlaveInfo> getConnectedSlaves() const;
+    std::vector<SlaveInfo> getSlavesByType(uint8_t slaveType) const;
+    bool isSlaveConnected(uint8_t slaveId) const;
+    uint8_t getSlaveCount() const;
+
+private:
+    bool sendCommand(uint8_t dst, uint8_t targetType, uint8_t command, const uint8_t* data, uint8_t dataLen);
+    void handleHeartbeat(uint8_t slaveId, uint8_t slaveType, uint32_t timeoutMs);
+    void removeTimedOutSlaves();
+
+    uint8_t _id;
+    sim::MasterPort* _port = nullptr;
+    DebugReceiveHandler _debugHandler = nullptr;
+    std::vector<SlaveInfo> _slaves;
+    TdmaLayout _tdmaLayout;
+    bool _tdma = false;
+};
+
+namespace StarWire {
+
+typedef void (*CommandHandler)(uint8_t cmd4, uint8_t senderId);
+
+/** Fills up to @p maxLength bytes to append to the heartbeat being sent, returns how many. */
+typedef uint8_t (*HeartbeatExtension)(uint8_t* data, uint8_t maxLength);
+
+/**
+ * @brief Slave side of the shim.
+ *
+ * A sketch builds exactly one of these, but the simulator runs many virtual
+ * slaves of the same type; they all share this handler table and call
+ * deliver() for the frames addressed to them.
+ */
+class ComProtSlave {
+public:
+    ComProtSlave(uint16_t slaveId, uint8_t slaveType, uint8_t dataPin, uint8_t clockPin = 255);
+
+    void setCommandHandler(uint8_t command, CommandHandler handler);
+    void setDebugReceiveHandler(DebugReceiveHandler handler) { _debugHandler = handler; }
+    void removeDebugReceiveHandler() { _debugHandler = nullptr; }
+    void setHeartbeatExtension(HeartbeatExtension extension) { _extension = extension; }
+    void setHeartbeatSchedule(const HeartbeatSchedule& schedule) {
+        _schedule = schedule;
+        _scheduled = true;
+    }
+    /** Tells the heartbeat scheduler the slave is busy, so it leaves the idle interval. */
+    void heartbeatActivity();
+
+    void begin() {}
+    void update() {}
+
+    /** Sends from the virtual slave currently being serviced. */
+    bool sendResponse(uint8_t command, const uint8_t* data = nullptr, uint8_t dataLen = 0);
+
+    /** Counters of the virtual slave currently being serviced. */
+    const LinkCounters& linkCounters() const;
+
+    // --- Simulator side ---
+    uint8_t slaveType() const { return _type; }
+    bool hasHandler(uint8_t command) const { return _handlers[command] != nullptr; }
+
+    /** Runs the debug hook and the command handler. @return true if a handler ran. */
+    bool deliver(const uint8_t* payload, uint16_t length, uint8_t senderId);
+
+    /** Bytes the sketch appends to the heartbeat being sent, 0 without an extension. */
+    uint8_t heartbeatExtension(uint8_t* data, uint8_t maxLength) { return _extension ? _extension(data, maxLength) : 0; }
+    const HeartbeatSchedule* heartbeatSchedule() const { return _scheduled ? &_schedule : nullptr; }
+
+private:
+    uint8_t _type;
+    CommandHandler _handlers[256] = {};
+    DebugReceiveHandler _debugHandler = nullptr;
+    HeartbeatExtension _extension = nullptr;
+    HeartbeatSchedule _schedule;
+    bool _scheduled = false;
+};
+
+} // namespace StarWire
+
+#endif // SIM_COM_PROT_H
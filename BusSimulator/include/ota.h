@@ -0,0 +1,25 @@
+#ifndef SIM_OTA_H
+#define SIM_OTA_H
+
+/*
+ * Host shim for the ota library: WiFi, OTA and WebSerial are no-ops.
+ * WebSerial shares the byte counter with Serial so debug traffic shows up
+ * in the simulator report.
+ */
+
+#include <Arduino.h>
+
+class SimWiFi {
+public:
+    const char* localIP() const { return "0.0.0.0"; }
+};
+
+extern SimWiFi WiFi;
+extern HardwareSerial WebSerial;
+
+void connectWifi(const char* ssid, const char* password);
+void setupOTA(int port = -1, const char* hostname = nullptr, const char* password = nullptr);
+void setupWebSerial(const char* hostname);
+void handleOTA();
+
+#endif // SIM_OTA_H
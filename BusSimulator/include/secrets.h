@@ -0,0 +1,7 @@
+#ifndef SECRETS_H
+#define SECRETS_H
+
+// Placeholder credentials for host builds; WiFi is never brought up.
+const char* SECRET_SSID = "simulator";
+const char* SECRET_PASSWORD = "simulator";
+#endif
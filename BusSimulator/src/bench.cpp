@@ -0,0 +1,34 @@
+#include "bench.h"
+
+#include <string.h>
+
+namespace sim {
+
+static const Bench BENCHES[] = {
+    {"dispatch", "slave command dispatch: per-type switch handlers vs the constexpr action table", benchDispatch},
+    {"scene", "bus time per grid refresh: unicast vs per-type broadcast vs scene frames", benchScene},
+    {"registry", "master slave bookkeeping: vector scans vs the id-indexed SlaveRegistry", benchRegistry},
+    {"soak", "24 h heap soak: per-hour allocations of the sketches and the com-prot send path", benchSoak},
+    {"adc", "photovoltaic A0: LED writes and flicker of raw vs filtered sampling (--trace FILE to replay)", benchAdc},
+    {"telemetry", "slave output telemetry: appended to heartbeats vs a separate request/response poll", benchTelemetry},
+    {"heartbeat", "64 slaves: collisions and timeouts of fixed 1 s heartbeats vs the jittered, adaptive schedule", benchHeartbeat},
+    {"tdma", "carrier sense vs beacon-slotted access: collisions, latency and worst-case bounds for 8..64 slaves", benchTdma},
+    {"segment", "SegmentDisplay number formatting: snprintf vs integer rendering into segment bitmasks", benchSegment},
+};
+
+const Bench* findBench(const char* name) {
+    for (const Bench& bench : BENCHES) {
+        if (!strcmp(bench.name, name)) {
+            return &bench;
+        }
+    }
+    return nullptr;
+}
+
+void listBenches(FILE* out) {
+    for (const Bench& bench : BENCHES) {
+        fprintf(out, "  %-12s %s\n", bench.name, bench.description);
+    }
+}
+
+} // namespace sim
@@ -0,0 +1,65 @@
+#ifndef SIM_BENCH_H
+#define SIM_BENCH_H
+
+#include <stdio.h>
+
+#include "simulation.h"
+
+namespace sim {
+
+/**
+ * @brief A named micro/macro benchmark selectable with --bench.
+ *
+ * Benchmarks get the parsed SimConfig so bus-level ones can honour
+ * --slaves, --seconds, --seed and friends.
+ */
+struct Bench {
+    const char* name;
+    const char* description;
+    int (*run)(const SimConfig& config, FILE* out);
+};
+
+const Bench* findBench(const char* name);
+void listBenches(FILE* out);
+
+/** Host nanoseconds per iteration of @p body, best of a few rounds. */
+template <typename Body>
+double nsPerIteration(uint64_t iterations, Body body);
+
+// Benchmarks, one per bench_*.cpp
+int benchDispatch(const SimConfig& config, FILE* out);
+int benchScene(const SimConfig& config, FILE* out);
+int benchRegistry(const SimConfig& config, FILE* out);
+int benchSoak(const SimConfig& config, FILE* out);
+int benchAdc(const SimConfig& config, FILE* out);
+int benchTelemetry(const SimConfig& config, FILE* out);
+int benchHeartbeat(const SimConfig& config, FILE* out);
+int benchTdma(const SimConfig& config, FILE* out);
+int benchSegment(const SimConfig& config, FILE* out);
+
+} // namespace sim
+
+#include <chrono>
+
+namespace sim {
+
+template <typename Body>
+double nsPerIteration(uint64_t iterations, Body body) {
+    double best = 0;
+    for (int round = 0; round < 5; round++) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            body(i);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+        if (round == 0 || ns < best) {
+            best = ns;
+        }
+    }
+    return best;
+}
+
+} // namespace sim
+
+#endif // SIM_BENCH_H
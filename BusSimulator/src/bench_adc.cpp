@@ -0,0 +1,270 @@
+/*
+ * Photovoltaic light sensor: LED writes, flicker and cost per A0 pipeline.
+ *
+ * Replays an A0 trace sampled every 10 ms, either synthetic (slow cloud
+ * drift, passing shadows as steps, sensor noise and occasional spikes) or
+ * recorded with --trace FILE (one reading per line, '#' comments). Every
+ * pipeline turns it into the SOLAR_LUTS index the slave shows:
+ *
+ *   raw 50 ms        one analogRead() every 50 ms, what the slave did first
+ *   raw 50 ms+hyst   the same through AnalogHysteresis (8 counts)
+ *   filtered 10 ms   every reading through AdcFilter (4x oversampling,
+ *                    median of 3, EMA 1/4), then AnalogHysteresis (4):
+ *                    smoothest, but five times the analogRead() calls
+ *   filtered 50 ms   what the slave runs (SOLAR_* in plant_actions.h): one
+ *                    reading every 50 ms through AdcFilter (median of 3,
+ *                    EMA 1/4), then AnalogHysteresis (6)
+ *
+ * "writes" is LED refreshes (index changes), "flicker" the changes that
+ * reverse the previous one within 500 ms. For synthetic traces the clean
+ * signal is known, so "err" is the mean index error and "lag" how long a
+ * shadow step takes to show.
+ */
+
+#include <plant_actions.h>
+#include <adc_filter.h>
+#include <change_tracking.h>
+
+#include <math.h>
+#include <random>
+#include <vector>
+
+#include "bench.h"
+
+namespace sim {
+namespace {
+
+const uint32_t SAMPLE_MS = 10;
+const double LED_WRITE_US = 30; // one WS2812 refresh of the single-LED strip, interrupts off
+
+struct Trace {
+    std::vector<uint16_t> readings;
+    std::vector<uint16_t> clean; // empty for recorded traces
+    std::vector<size_t> steps;   // sample index of each shadow edge
+};
+
+Trace syntheticTrace(uint32_t seconds, uint32_t seed) {
+    Trace trace;
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise(0.0, 8.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    size_t samples = seconds * 1000 / SAMPLE_MS;
+    bool shadow = false;
+    for (size_t i = 0; i < samples; i++) {
+        double t = i * SAMPLE_MS / 1000.0;
+        if (i > 0 && i % (size_t)(30000 / SAMPLE_MS) == 0) {
+            shadow = !shadow;
+            trace.steps.push_back(i);
+        }
+        double light = 620 + 150 * sin(2 * M_PI * t / 240.0) - (shadow ? 260 : 0);
+        double reading = light + noise(rng);
+        if (unit(rng) < 0.005) {
+            reading += unit(rng) < 0.5 ? -150 : 150; // switching spikes on the supply
+        }
+        trace.clean.push_back((uint16_t)light);
+        trace.readings.push_back((uint16_t)std::min(1024.0, std::max(0.0, reading)));
+    }
+    return trace;
+}
+
+bool loadTrace(const std::string& path, Trace& trace) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (!file) {
+        return false;
+    }
+    char line[64];
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        long value = strtol(line, nullptr, 10);
+        trace.readings.push_back((uint16_t)std::min(1024L, std::max(0L, value)));
+    }
+    fclose(file);
+    return !trace.readings.empty();
+}
+
+struct Result {
+    uint32_t writes = 0;
+    uint32_t flicker = 0;
+    double indexError = 0;
+    double lagMs = 0;
+};
+
+// Feeds the trace through @p pipeline, which returns the LUT index after each
+// reading (or -1 when it did not produce one) and scores the index sequence
+template <typename Pipeline>
+Result score(const Trace& trace, Pipeline pipeline) {
+    Result result;
+    int index = -1;
+    int lastDirection = 0;
+    size_t lastChange = 0;
+    double errorSum = 0;
+    size_t nextStep = 0;
+    size_t stepStart = 0;
+    bool waiting = false;
+    double lagSum = 0;
+    uint32_t lags = 0;
+
+    for (size_t i = 0; i < trace.readings.size(); i++) {
+        int next = pipeline(trace.readings[i]);
+        if (next >= 0 && next != index) {
+            if (index >= 0) {
+                int direction = next > index ? 1 : -1;
+                if (direction == -lastDirection && (i - lastChange) * SAMPLE_MS <= 500) {
+                    result.flicker++;
+                }
+                lastDirection = direction;
+            }
+            result.writes++;
+            lastChange = i;
+            index = next;
+        }
+        if (trace.clean.empty() || index < 0) {
+            continue;
+        }
+        int cleanIndex = trace.clean[i] >> SOLAR_LUT_SHIFT;
+        errorSum += abs(index - cleanIndex);
+        if (nextStep < trace.steps.size() && i == trace.steps[nextStep]) {
+            stepStart = i;
+            waiting = true;
+            nextStep++;
+        }
+        if (waiting && abs(index - cleanIndex) <= 1) {
+            lagSum += (i - stepStart) * SAMPLE_MS;
+            lags++;
+            waiting = false;
+        }
+    }
+    if (!trace.clean.empty()) {
+        result.indexError = errorSum / trace.readings.size();
+        result.lagMs = lags ? lagSum / lags : 0;
+    }
+    return result;
+}
+
+struct RawPipeline {
+    size_t n = 0;
+    int operator()(uint16_t reading) {
+        return n++ % 5 == 0 ? reading >> SOLAR_LUT_SHIFT : -1;
+    }
+};
+
+struct RawHysteresisPipeline {
+    size_t n = 0;
+    AnalogHysteresis light{8};
+    int operator()(uint16_t reading) {
+        if (n++ % 5) {
+            return -1;
+        }
+        light.update(reading);
+        return light.value() >> SOLAR_LUT_SHIFT;
+    }
+};
+
+struct FilteredPipeline {
+    AdcFilter filter{2, 2};
+    AnalogHysteresis light{4};
+    int operator()(uint16_t reading) {
+        if (!filter.add(reading)) {
+            return -1;
+        }
+        light.update(filter.value());
+        return light.value() >> SOLAR_LUT_SHIFT;
+    }
+};
+
+// The slave's pipeline; sample() is the work per analogRead()
+struct SlavePipeline {
+    size_t n = 0;
+    AdcFilter filter{SOLAR_OVERSAMPLE_SHIFT, SOLAR_EMA_SHIFT};
+    AnalogHysteresis light{SOLAR_HYSTERESIS};
+    int sample(uint16_t reading) {
+        if (!filter.add(reading)) {
+            return -1;
+        }
+        light.update(filter.value());
+        return light.value() >> SOLAR_LUT_SHIFT;
+    }
+    int operator()(uint16_t reading) {
+        return n++ % (SOLAR_SAMPLE_MS / SAMPLE_MS) == 0 ? sample(reading) : -1;
+    }
+};
+
+// What the slave computed per reading before the LUT: map() and a float voltage
+volatile float g_voltage;
+long legacyMap(long x, long in_min, long in_max, long out_min, long out_max) {
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+} // namespace
+
+int benchAdc(const SimConfig& config, FILE* out) {
+    Trace trace;
+    if (!config.tracePath.empty()) {
+        if (!loadTrace(config.tracePath, trace)) {
+            fprintf(stderr, "cannot read A0 trace '%s'\n", config.tracePath.c_str());
+            return 1;
+        }
+    } else {
+        // --seconds overrides the 10 min default
+        trace = syntheticTrace(config.seconds == SimConfig().seconds ? 600 : config.seconds, config.seed);
+    }
+    double minutes = trace.readings.size() * SAMPLE_MS / 60000.0;
+    bool synthetic = !trace.clean.empty();
+
+    fprintf(out, "A0 pipelines over %.1f min of %s trace (%zu readings, %u ms apart)\n", minutes,
+            synthetic ? "synthetic" : "recorded", trace.readings.size(), SAMPLE_MS);
+    fprintf(out, "%-16s %10s %11s %6s %7s %10s %8s %7s %9s\n", "pipeline", "writes/min", "flicker/min", "err",
+            "lag ms", "ns/read", "reads/s", "us/s", "+led us/s");
+
+    const uint64_t ITERATIONS = 2000000;
+    const size_t mask = 4095;
+    std::vector<uint16_t> loop(trace.readings.begin(),
+                               trace.readings.begin() + std::min(trace.readings.size(), mask + 1));
+    loop.resize(mask + 1, loop.empty() ? 512 : loop.back());
+
+    // ns per reading of the work after analogRead(); us/s = CPU per second of sensing,
+    // +led adds the strip refreshes the pipeline causes
+    auto row = [&](const char* name, const Result& result, double ns, uint32_t readsPerSecond) {
+        char err[16] = "-", lag[16] = "-";
+        if (synthetic) {
+            snprintf(err, sizeof(err), "%.2f", result.indexError);
+            snprintf(lag, sizeof(lag), "%.0f", result.lagMs);
+        }
+        double cpuUs = ns * readsPerSecond / 1000.0;
+        double ledUs = result.writes / minutes / 60 * LED_WRITE_US;
+        fprintf(out, "%-16s %10.1f %11.1f %6s %7s %10.2f %8u %7.2f %9.1f\n", name, result.writes / minutes,
+                result.flicker / minutes, err, lag, ns, readsPerSecond, cpuUs, cpuUs + ledUs);
+    };
+
+    double legacyNs = nsPerIteration(ITERATIONS, [&](uint64_t i) {
+        int reading = loop[i & mask];
+        g_voltage = (reading / 1024.0f) * 3.3f;
+        g_voltage = g_voltage + legacyMap(reading, 0, 1024, 16, 255) + legacyMap(reading, 0, 1024, 0, 255);
+    });
+    row("raw 50 ms", score(trace, RawPipeline()), legacyNs, 20);
+
+    AnalogHysteresis light(8);
+    double rawNs = nsPerIteration(ITERATIONS, [&](uint64_t i) {
+        light.update(loop[i & mask]);
+        g_voltage = light.value() >> SOLAR_LUT_SHIFT;
+    });
+    row("raw 50 ms+hyst", score(trace, RawHysteresisPipeline()), rawNs, 20);
+
+    FilteredPipeline filtered;
+    double filteredNs = nsPerIteration(ITERATIONS, [&](uint64_t i) { g_voltage = filtered(loop[i & mask]); });
+    row("filtered 10 ms", score(trace, FilteredPipeline()), filteredNs, 100);
+
+    SlavePipeline slave;
+    double slaveNs = nsPerIteration(ITERATIONS, [&](uint64_t i) { g_voltage = slave.sample(loop[i & mask]); });
+    row("filtered 50 ms", score(trace, SlavePipeline()), slaveNs, 1000 / SOLAR_SAMPLE_MS);
+
+    fprintf(out, "(raw 50 ms = map() + float voltage per reading as before the LUT; the host has an FPU, the\n"
+                 " ESP8266 emulates float in software, so us/s flatters it. analogRead() itself is not\n"
+                 " included; it costs the same per read for every pipeline, so compare reads/s. +led counts\n"
+                 " %.0f us per LED write.)\n", LED_WRITE_US);
+    return 0;
+}
+
+} // namespace sim
@@ -0,0 +1,226 @@
+/*
+ * Dispatch cost per command on the slave.
+ *
+ * "switch" is the handler layout OneWireSlave used before the action table:
+ * every code registered to a per-type handler that re-decodes cmd4 through a
+ * switch. "table" is the current one: a single handler doing one indexed
+ * load from PLANT_ACTIONS and one actuator write. Both run through a
+ * 256-entry function pointer table like ComProtSlave and with debug output
+ * compiled out, so only the dispatch differs. "firmware" is the real sketch
+ * build including its log records.
+ */
+
+#include <PeripheralFactory.h>
+#include <plant_actions.h>
+
+#include "bench.h"
+#include "firmware.h"
+
+namespace sim {
+namespace {
+
+typedef void (*Handler)(uint8_t cmd4, uint8_t senderId);
+
+RGBLED g_led(0, 1);
+Motor g_motor(0, 0, 1000);
+Atomizer g_atomizer(0);
+uint8_t g_solarMode = 0;
+
+// ---------- Legacy per-type handlers ----------
+
+__attribute__((noinline)) void switchMisty(uint8_t cmd4, uint8_t) {
+    bool wantOn = (cmd4 == CMD_ON);
+    bool wantOff = (cmd4 == CMD_OFF);
+    if (!wantOn && !wantOff) {
+        return;
+    }
+    if (wantOn != g_atomizer.getTargetState()) {
+        g_atomizer.toggle();
+    }
+}
+
+__attribute__((noinline)) void switchBattery(uint8_t cmd4, uint8_t) {
+    switch (cmd4) {
+    case BAT_CHARGING: g_led.setColor(255, 0, 0); break;
+    case BAT_IDLE: g_led.setColor(255, 140, 0); break;
+    case BAT_DISCHARGE: g_led.setColor(0, 255, 0); break;
+    default: return;
+    }
+    g_led.show();
+}
+
+__attribute__((noinline)) void switchPhotovoltaic(uint8_t cmd4, uint8_t) {
+    switch (cmd4) {
+    case CMD_ON: g_solarMode = 1; break;
+    case CMD_OFF: g_solarMode = 2; break;
+    case BAT_IDLE: g_solarMode = 0; break;
+    default: return;
+    }
+}
+
+__attribute__((noinline)) void switchGas(uint8_t cmd4, uint8_t) {
+    switch (cmd4) {
+    case GAS_LEVEL_1:  g_led.setColor(255, 0, 0);     g_led.setBrightness(255); break;
+    case GAS_LEVEL_2:  g_led.setColor(227, 28, 36);   g_led.setBrightness(255); break;
+    case GAS_LEVEL_3:  g_led.setColor(198, 57, 71);   g_led.setBrightness(255); break;
+    case GAS_LEVEL_4:  g_led.setColor(170, 85, 107);  g_led.setBrightness(255); break;
+    case GAS_LEVEL_5:  g_led.setColor(142, 113, 142); g_led.setBrightness(255); break;
+    case GAS_LEVEL_6:  g_led.setColor(113, 142, 142); g_led.setBrightness(255); break;
+    case GAS_LEVEL_7:  g_led.setColor(85, 170, 107);  g_led.setBrightness(255); break;
+    case GAS_LEVEL_8:  g_led.setColor(57, 198, 71);   g_led.setBrightness(255); break;
+    case GAS_LEVEL_9:  g_led.setColor(28, 227, 36);   g_led.setBrightness(255); break;
+    case GAS_LEVEL_10: g_led.setColor(0, 255, 0);     g_led.setBrightness(255); break;
+    case CMD_OFF:      g_led.setColor(0, 0, 0);       g_led.setBrightness(0);   break;
+    default: return;
+    }
+    g_led.show();
+}
+
+__attribute__((noinline)) void switchMotor(uint8_t cmd4, uint8_t, int duty) {
+    bool wantOn = (cmd4 == CMD_ON);
+    bool wantOff = (cmd4 == CMD_OFF);
+    if (!wantOn && !wantOff) {
+        return;
+    }
+    if (wantOn) {
+        g_motor.forward(duty);
+    } else {
+        g_motor.stop();
+    }
+}
+
+__attribute__((noinline)) void switchHydro(uint8_t cmd4, uint8_t senderId) {
+    switchMotor(cmd4, senderId, 1023);
+}
+
+__attribute__((noinline)) void switchWind(uint8_t cmd4, uint8_t senderId) {
+    switchMotor(cmd4, senderId, 150);
+}
+
+__attribute__((noinline)) void switchHydroStorage(uint8_t cmd4, uint8_t) {
+    switch (cmd4) {
+    case HYDRO_STORAGE_LEVEL_1: g_led.setColor(0, 255, 0);     g_led.setBrightness(255); break;
+    case HYDRO_STORAGE_LEVEL_2: g_led.setColor(128, 255, 128); g_led.setBrightness(192); break;
+    case HYDRO_STORAGE_LEVEL_3: g_led.setColor(255, 140, 0);   g_led.setBrightness(128); break;
+    case HYDRO_STORAGE_LEVEL_4: g_led.setColor(255, 128, 128); g_led.setBrightness(96);  break;
+    case HYDRO_STORAGE_LEVEL_5: g_led.setColor(255, 0, 0);     g_led.setBrightness(64);  break;
+    case CMD_OFF:               g_led.setColor(0, 0, 0);       g_led.setBrightness(0);   break;
+    default: return;
+    }
+    g_led.show();
+}
+
+Handler legacyHandler(uint8_t type) {
+    switch (type) {
+    case TYPE_PHOTOVOLTAIC: return switchPhotovoltaic;
+    case TYPE_WIND: return switchWind;
+    case TYPE_GAS: return switchGas;
+    case TYPE_HYDRO: return switchHydro;
+    case TYPE_HYDRO_STORAGE: return switchHydroStorage;
+    case TYPE_BATTERY: return switchBattery;
+    default: return switchMisty;
+    }
+}
+
+// ---------- Action table handler (mirrors OneWireSlave handleCommand) ----------
+
+const PlantAction* g_actions = PLANT_ACTIONS[0];
+
+template <uint8_t Kind>
+__attribute__((noinline)) void tableHandler(uint8_t cmd4, uint8_t) {
+    const PlantAction& action = g_actions[cmd4 & 0x0F];
+    switch (Kind) {
+    case ACTION_LED:
+        g_led.setColor(action.red, action.green, action.blue);
+        g_led.show();
+        break;
+    case ACTION_MOTOR:
+        if (action.value) {
+            g_motor.forward(action.value);
+        } else {
+            g_motor.stop();
+        }
+        break;
+    case ACTION_ATOMIZER:
+        if ((bool)action.value != g_atomizer.getTargetState()) {
+            g_atomizer.toggle();
+        }
+        break;
+    case ACTION_SOLAR_MODE:
+        g_solarMode = action.value;
+        break;
+    }
+}
+
+Handler actionHandler(uint8_t type) {
+    switch (plantActionKind(type)) {
+    case ACTION_LED: return tableHandler<ACTION_LED>;
+    case ACTION_MOTOR: return tableHandler<ACTION_MOTOR>;
+    case ACTION_ATOMIZER: return tableHandler<ACTION_ATOMIZER>;
+    default: return tableHandler<ACTION_SOLAR_MODE>;
+    }
+}
+
+} // namespace
+
+int benchDispatch(const SimConfig& config, FILE* out) {
+    static const uint64_t ITERATIONS = 4000000;
+    static const size_t STREAM = 4096; // power of two
+
+    bootSketches();
+    std::mt19937 rng(config.seed);
+
+    fprintf(out, "Slave command dispatch, host ns per command (best of 5 x %llu)\n",
+            (unsigned long long)ITERATIONS);
+    fprintf(out, "%-14s %6s %9s %9s %9s %12s\n", "type", "codes", "switch", "table", "speedup", "firmware");
+
+    for (uint8_t type = 1; type < PLANT_TYPE_COUNT; type++) {
+        std::vector<uint8_t> codes;
+        for (uint8_t cmd = 0; cmd < PLANT_COMMAND_COUNT; cmd++) {
+            if (PLANT_ACTIONS[type][cmd].kind != ACTION_NONE) {
+                codes.push_back(cmd);
+            }
+        }
+        std::vector<uint8_t> stream(STREAM);
+        for (uint8_t& cmd : stream) {
+            cmd = codes[std::uniform_int_distribution<size_t>(0, codes.size() - 1)(rng)];
+        }
+
+        Handler switchTable[256] = {};
+        Handler actionTable[256] = {};
+        for (uint8_t cmd : codes) {
+            switchTable[cmd] = legacyHandler(type);
+            actionTable[cmd] = actionHandler(type);
+        }
+        g_actions = PLANT_ACTIONS[type];
+
+        // volatile table pointers keep the indirect call from being devirtualised
+        Handler* volatile switchHandlers = switchTable;
+        Handler* volatile actionHandlers = actionTable;
+        double switchNs = nsPerIteration(ITERATIONS, [&](uint64_t i) {
+            uint8_t cmd = stream[i & (STREAM - 1)];
+            switchHandlers[cmd](cmd, 1);
+        });
+        double tableNs = nsPerIteration(ITERATIONS, [&](uint64_t i) {
+            uint8_t cmd = stream[i & (STREAM - 1)];
+            actionHandlers[cmd](cmd, 1);
+        });
+
+        double firmwareNs = 0;
+        if (const SlaveFirmware* firmware = findSlaveFirmware(type)) {
+            uint8_t frame[3] = {COM_PROT_COMMAND, 0, 0};
+            firmwareNs = nsPerIteration(ITERATIONS / 20, [&](uint64_t i) {
+                frame[2] = stream[i & (STREAM - 1)];
+                firmware->protocol->deliver(frame, sizeof(frame), 1);
+            });
+        }
+
+        fprintf(out, "%-14s %6zu %9.2f %9.2f %8.2fx %12.1f\n",
+                findSlaveFirmware(type) ? findSlaveFirmware(type)->name : "?", codes.size(), switchNs, tableNs,
+                tableNs > 0 ? switchNs / tableNs : 0.0, firmwareNs);
+    }
+    fprintf(out, "(firmware = ComProtSlave::deliver into the sketch build, log records included)\n");
+    return 0;
+}
+
+} // namespace sim
@@ -0,0 +1,75 @@
+/*
+ * Heartbeat scheduling at scale: the full simulation (OneWireHost +
+ * OneWireSlave sketches) with 64 slaves by default, once with the plain
+ * fixed 1 s heartbeat (--fixed-heartbeat) and once with the sketches'
+ * HeartbeatSchedule (id phase, jitter, busy back-off, idle stretch).
+ *
+ * Each mode runs under the configured command load and idle (no commands,
+ * so the scheduled slaves stretch to their idle interval after 30 s).
+ * The slaves boot within SimConfig::bootSpreadMs of each other, which is
+ * what keeps the fixed heartbeats phase-locked.
+ */
+
+#include "bench.h"
+
+namespace sim {
+namespace {
+
+struct HeartbeatRun {
+    const char* mode;
+    const char* load;
+    bool fixed;
+    bool idle;
+};
+
+const HeartbeatRun RUNS[] = {
+    {"fixed", "commands", true, false},
+    {"scheduled", "commands", false, false},
+    {"fixed", "idle", true, true},
+    {"scheduled", "idle", false, true},
+};
+
+} // namespace
+
+int benchHeartbeat(const SimConfig& base, FILE* out) {
+    SimConfig config = base;
+    if (config.slaves == SimConfig().slaves) {
+        config.slaves = 64; // --slaves overrides
+    }
+    if (config.seconds == SimConfig().seconds) {
+        config.seconds = 180; // long enough to spend most of the idle run idle
+    }
+    double seconds = config.seconds;
+
+    fprintf(out, "Heartbeat scheduling: %u slaves, %u s per run, boot spread %u ms, %.0f cmd/s under load\n",
+            config.slaves, config.seconds, config.bootSpreadMs, config.commandRate);
+    fprintf(out, "%-10s %-9s %7s %9s %7s %9s %8s %8s %8s %8s %10s\n", "mode", "load", "busy %", "coll/min",
+            "coll %", "backoff/s", "hb/s", "hb miss", "timeouts", "online", "cmd p99");
+    for (const HeartbeatRun& run : RUNS) {
+        SimConfig runConfig = config;
+        runConfig.fixedHeartbeat = run.fixed;
+        if (run.idle) {
+            runConfig.commandRate = 0;
+        }
+        Simulation simulation(runConfig);
+        simulation.run();
+
+        const BusCounters& bus = simulation.bus().counters();
+        const SimStats& stats = simulation.stats();
+        fprintf(out, "%-10s %-9s %6.1f%% %9.1f %6.2f%% %9.1f %8.1f %8llu %8llu %4u/%-3zu", run.mode, run.load,
+                100.0 * bus.busyUs / (seconds * 1e6), bus.collisions * 60.0 / seconds,
+                bus.framesSent ? 100.0 * bus.collisions / bus.framesSent : 0.0, bus.busyBackoffs / seconds,
+                stats.heartbeatsProcessed / seconds, (unsigned long long)stats.heartbeatsMissed,
+                (unsigned long long)stats.slaveTimeouts, simulation.onlineAtEnd(), simulation.slaveCount());
+        if (run.idle) {
+            fprintf(out, " %10s\n", "-");
+        } else {
+            fprintf(out, " %7.1f ms\n", stats.commandLatencyUs.percentile(0.99) / 1000.0);
+        }
+    }
+    fprintf(out, "(hb/s = heartbeats reaching the master; hb miss = fixed: whole 1 s periods without one,\n"
+                 " scheduled: whole announced intervals without one; timeouts = slaves the master dropped)\n");
+    return 0;
+}
+
+} // namespace sim
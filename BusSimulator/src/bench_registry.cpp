@@ -0,0 +1,109 @@
+/*
+ * Slave bookkeeping cost on the master, per heartbeat and per query.
+ *
+ * "vector" is what masterExample did before SlaveRegistry: a std::vector
+ * scanned on every heartbeat and type/id check, and remove_if once a
+ * second. "registry" is SlaveRegistry: id-indexed arrays, per-type bitsets
+ * and a timing wheel. Heartbeats arrive round-robin, one per slave per
+ * second, and every heartbeat also runs the timeout check the sketch does
+ * from loop(), so the sweep cost is spread over the heartbeats.
+ */
+
+#include <slave_registry.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "bench.h"
+
+namespace sim {
+namespace {
+
+struct VectorSlave {
+    uint8_t id;
+    uint8_t type;
+    unsigned long lastSeen;
+};
+
+class VectorRegistry {
+public:
+    void heartbeat(uint8_t id, uint8_t type, uint32_t nowMs) {
+        for (VectorSlave& slave : _slaves) {
+            if (slave.id == id) {
+                slave.lastSeen = nowMs;
+                slave.type = type;
+                return;
+            }
+        }
+        _slaves.push_back({id, type, nowMs});
+    }
+
+    void expire(uint32_t nowMs) {
+        if (nowMs - _lastCheckMs <= 1000) {
+            return;
+        }
+        _lastCheckMs = nowMs;
+        _slaves.erase(std::remove_if(_slaves.begin(), _slaves.end(),
+                                     [nowMs](const VectorSlave& slave) { return nowMs - slave.lastSeen > 5000; }),
+                      _slaves.end());
+    }
+
+    bool hasType(uint8_t type) const {
+        for (const VectorSlave& slave : _slaves) {
+            if (slave.type == type) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::vector<VectorSlave> _slaves;
+    uint32_t _lastCheckMs = 0;
+};
+
+} // namespace
+
+int benchRegistry(const SimConfig& config, FILE* out) {
+    static const uint16_t sizes[] = {8, 32, 64, 128, 253};
+    static const uint64_t ITERATIONS = 2000000;
+
+    fprintf(out, "Master slave bookkeeping, host ns (best of 5 x %llu)\n", (unsigned long long)ITERATIONS);
+    fprintf(out, "%7s %14s %14s %14s %14s\n", "slaves", "vector hb", "registry hb", "vector query", "registry query");
+    for (uint16_t size : sizes) {
+        std::vector<uint8_t> ids;
+        for (uint16_t i = 0; i < size; i++) {
+            ids.push_back(2 + i);
+        }
+        std::shuffle(ids.begin(), ids.end(), std::mt19937(config.seed));
+        uint32_t stepMs = 1000 / size ? 1000 / size : 1;
+
+        VectorRegistry vectorRegistry;
+        SlaveRegistry registry(5000);
+        double vectorHb = nsPerIteration(ITERATIONS, [&](uint64_t i) {
+            uint8_t id = ids[i % size];
+            uint32_t nowMs = (uint32_t)(i * stepMs);
+            vectorRegistry.heartbeat(id, 1 + id % 8, nowMs);
+            vectorRegistry.expire(nowMs);
+        });
+        double registryHb = nsPerIteration(ITERATIONS, [&](uint64_t i) {
+            uint8_t id = ids[i % size];
+            uint32_t nowMs = (uint32_t)(i * stepMs);
+            registry.heartbeat(id, 1 + id % 8, nowMs);
+            registry.expire(nowMs);
+        });
+
+        // Worst case for the scan: a type nobody has.
+        volatile uint8_t absent = 9;
+        volatile bool sink = false;
+        double vectorQuery = nsPerIteration(ITERATIONS, [&](uint64_t) { sink = vectorRegistry.hasType(absent); });
+        double registryQuery = nsPerIteration(ITERATIONS, [&](uint64_t) { sink = registry.hasSlaveOfType(absent); });
+        (void)sink;
+
+        fprintf(out, "%7u %14.1f %14.1f %14.1f %14.1f\n", size, vectorHb, registryHb, vectorQuery, registryQuery);
+    }
+    fprintf(out, "(hb = one heartbeat plus the timeout check run from loop(), query = hasSlaveOfType() for an absent type)\n");
+    return 0;
+}
+
+} // namespace sim
@@ -0,0 +1,309 @@
+/*
+ * Bus time per grid refresh: how long it takes to give every slave a new
+ * 4-bit command, per strategy.
+ *
+ *   unicast      one sendCommandToSlaveId() frame per slave
+ *   per type     one sendCommandToSlaveType() broadcast per powerplant type
+ *   scene/type   one STARWIRE_CMD_SCENE frame with a nibble per type
+ *   scene/id     STARWIRE_CMD_SCENE frames with a nibble per slave id
+ *   fleet sync   STARWIRE_CMD_FLEET_SYNC frames, the nibble array indexed by id
+ *
+ * Slaves keep sending their 1 s heartbeats meanwhile, so refresh frames
+ * compete for the wire like on the real bus. The master feeds its 5-frame
+ * PJON dispatch queue as it drains, like a sketch retrying a full queue.
+ */
+
+#include <com-prot.h>
+#include <fleet_state.h>
+#include <scene_frame.h>
+
+#include <deque>
+#include <vector>
+
+#include "bench.h"
+
+namespace sim {
+namespace {
+
+static const uint8_t MASTER_ID = 1;
+static const uint8_t TYPE_COUNT = 8;
+
+struct Message {
+    uint8_t dst;
+    uint8_t length;
+    uint8_t payload[PACKET_MAX_LENGTH];
+};
+
+class RefreshSlave : public BusNode {
+public:
+    RefreshSlave(uint8_t id, uint8_t type, uint64_t heartbeatUs, uint64_t phaseUs)
+        : BusNode(id), _type(type), _heartbeatUs(heartbeatUs), _nextHeartbeatUs(phaseUs) {}
+
+    void onFrame(const Frame& frame, uint64_t nowUs) override {
+        if (frame.length < 3 || frame.payload[0] != COM_PROT_COMMAND) {
+            return;
+        }
+        uint8_t cmd4;
+        if (frame.payload[2] == STARWIRE_CMD_SCENE) {
+            if (!sceneFind(frame.payload + 3, frame.length - 3, id(), _type, &cmd4)) {
+                return;
+            }
+        } else if (frame.payload[2] == STARWIRE_CMD_FLEET_SYNC) {
+            cmd4 = fleetFind(frame.payload + 3, frame.length - 3, id());
+        } else if (frame.payload[1] == 0 || frame.payload[1] == _type) {
+            cmd4 = frame.payload[2];
+        } else {
+            return;
+        }
+        if (cmd4 == expected && appliedUs == 0) {
+            appliedUs = nowUs;
+        }
+    }
+
+    void poll(uint64_t nowUs) override {
+        if (nowUs >= _nextHeartbeatUs) {
+            const uint8_t heartbeat[3] = {COM_PROT_HEARTBEAT, id(), _type};
+            send(MASTER_ID, heartbeat, sizeof(heartbeat));
+            _nextHeartbeatUs += _heartbeatUs;
+        }
+    }
+
+    uint64_t nextWakeUs() const override { return _nextHeartbeatUs; }
+
+    uint8_t type() const { return _type; }
+
+    uint8_t expected = 0;
+    uint64_t appliedUs = 0;
+
+private:
+    uint8_t _type;
+    uint64_t _heartbeatUs;
+    uint64_t _nextHeartbeatUs;
+};
+
+class RefreshMaster : public BusNode {
+public:
+    RefreshMaster() : BusNode(MASTER_ID) {}
+
+    void onFrame(const Frame&, uint64_t) override {}
+
+    void poll(uint64_t) override {
+        while (!outbox.empty() && pending() < MAX_PACKETS) {
+            const Message& message = outbox.front();
+            send(message.dst, message.payload, message.length);
+            outbox.pop_front();
+        }
+    }
+
+    uint64_t nextWakeUs() const override {
+        // Feed the queue as soon as there is room; the bus wakes us when a frame leaves.
+        return (!outbox.empty() && pending() < MAX_PACKETS) ? 0 : UINT64_MAX;
+    }
+
+    void command(uint8_t dst, uint8_t targetType, uint8_t code, const uint8_t* data = nullptr, uint8_t length = 0) {
+        Message message;
+        message.dst = dst;
+        message.length = 3 + length;
+        message.payload[0] = COM_PROT_COMMAND;
+        message.payload[1] = targetType;
+        message.payload[2] = code;
+        for (uint8_t i = 0; i < length; i++) {
+            message.payload[3 + i] = data[i];
+        }
+        outbox.push_back(message);
+    }
+
+    std::deque<Message> outbox;
+};
+
+enum Strategy { UNICAST, PER_TYPE, SCENE_TYPE, SCENE_ID, FLEET_SYNC, STRATEGY_COUNT };
+
+const char* const STRATEGY_NAMES[STRATEGY_COUNT] = {"unicast", "per type", "scene/type", "scene/id", "fleet sync"};
+
+struct RefreshResult {
+    double frames = 0;
+    double airUs = 0;       // wire time of the refresh frames
+    double completeUs = 0;  // first frame queued -> last slave applied
+    uint64_t incomplete = 0;
+    uint64_t refreshes = 0;
+};
+
+void queueRefresh(Strategy strategy, RefreshMaster& master, std::vector<RefreshSlave*>& slaves, uint8_t round) {
+    // Same command for every slave of a type, so every strategy carries the same information.
+    uint8_t typeCmd[TYPE_COUNT + 1];
+    for (uint8_t type = 1; type <= TYPE_COUNT; type++) {
+        typeCmd[type] = 1 + (type + round) % 15;
+    }
+    for (RefreshSlave* slave : slaves) {
+        slave->expected = typeCmd[slave->type()];
+        slave->appliedUs = 0;
+    }
+
+    switch (strategy) {
+    case UNICAST:
+        for (RefreshSlave* slave : slaves) {
+            master.command(slave->id(), 0, slave->expected);
+        }
+        break;
+    case PER_TYPE:
+        for (uint8_t type = 1; type <= TYPE_COUNT; type++) {
+            master.command(STARWIRE_BROADCAST_ID, type, typeCmd[type]);
+        }
+        break;
+    case SCENE_TYPE: {
+        SceneBuilder scene;
+        for (uint8_t type = 1; type <= TYPE_COUNT; type++) {
+            scene.setType(type, typeCmd[type]);
+        }
+        uint8_t data[STARWIRE_MAX_COMMAND_DATA];
+        master.command(STARWIRE_BROADCAST_ID, 0, STARWIRE_CMD_SCENE, data, scene.encode(data));
+        break;
+    }
+    case SCENE_ID: {
+        SceneBuilder scene;
+        uint8_t data[STARWIRE_MAX_COMMAND_DATA];
+        for (RefreshSlave* slave : slaves) {
+            if (!scene.setSlave(slave->id(), slave->expected)) {
+                master.command(STARWIRE_BROADCAST_ID, 0, STARWIRE_CMD_SCENE, data, scene.encode(data));
+                scene.clear();
+                scene.setSlave(slave->id(), slave->expected);
+            }
+        }
+        master.command(STARWIRE_BROADCAST_ID, 0, STARWIRE_CMD_SCENE, data, scene.encode(data));
+        break;
+    }
+    case FLEET_SYNC: {
+        FleetState fleet;
+        uint8_t data[STARWIRE_MAX_COMMAND_DATA];
+        for (RefreshSlave* slave : slaves) {
+            fleet.set(slave->id(), slave->expected);
+        }
+        for (uint8_t i = 0; i < fleet.frameCount(); i++) {
+            master.command(STARWIRE_BROADCAST_ID, 0, STARWIRE_CMD_FLEET_SYNC, data, fleet.encodeFrame(i, data));
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+RefreshResult runStrategy(const SimConfig& config, Strategy strategy, uint16_t slaveCount) {
+    Bus bus(config.bus, config.seed);
+    RefreshMaster master;
+    bus.attach(&master);
+
+    std::vector<std::unique_ptr<RefreshSlave>> owned;
+    std::vector<RefreshSlave*> slaves;
+    uint64_t heartbeatUs = (uint64_t)config.heartbeatMs * 1000;
+    std::uniform_int_distribution<uint64_t> phase(0, heartbeatUs - 1);
+    std::uniform_int_distribution<int32_t> skew(-(int32_t)config.clockPpm, (int32_t)config.clockPpm);
+    for (uint16_t i = 0; i < slaveCount; i++) {
+        // Own crystal per slave, or heartbeats stay phase-locked to the refresh period.
+        uint64_t periodUs = heartbeatUs + (int64_t)config.heartbeatMs * skew(bus.rng()) / 1000;
+        owned.emplace_back(new RefreshSlave(2 + i, 1 + i % TYPE_COUNT, periodUs, phase(bus.rng())));
+        slaves.push_back(owned.back().get());
+        bus.attach(slaves.back());
+    }
+
+    RefreshResult result;
+    uint64_t refreshUs = 1000000;
+    uint64_t endUs = (uint64_t)config.seconds * 1000000;
+    uint64_t tick = config.tickUs ? config.tickUs : 1;
+    uint64_t refreshBaseUs = (uint64_t)config.warmupMs * 1000;
+    uint64_t nextRefreshUs = refreshBaseUs;
+    std::uniform_int_distribution<uint64_t> offset(0, refreshUs / 2);
+    uint64_t startUs = 0;
+    bool open = false;
+    uint8_t round = 0;
+    uint64_t now = 0;
+
+    auto close = [&]() {
+        uint64_t lastUs = 0;
+        bool complete = true;
+        for (RefreshSlave* slave : slaves) {
+            if (!slave->appliedUs) {
+                complete = false;
+            } else if (slave->appliedUs > lastUs) {
+                lastUs = slave->appliedUs;
+            }
+        }
+        if (complete) {
+            result.completeUs += lastUs - startUs;
+        } else {
+            result.incomplete++;
+        }
+        result.refreshes++;
+        open = false;
+    };
+
+    while (true) {
+        uint64_t next = std::min(bus.nextEventUs(), nextRefreshUs);
+        next = std::max((next + tick - 1) / tick * tick, now + tick);
+        if (next > endUs) {
+            break;
+        }
+        now = next;
+
+        // Only start refreshes that have a full period left to finish in.
+        if (now >= nextRefreshUs && refreshBaseUs + refreshUs <= endUs) {
+            if (open) {
+                close();
+            }
+            // Frames left over from a refresh that overran its period stay queued.
+            size_t backlog = master.outbox.size();
+            queueRefresh(strategy, master, slaves, round++);
+            result.frames += master.outbox.size() - backlog;
+            for (size_t i = backlog; i < master.outbox.size(); i++) {
+                result.airUs += bus.airTimeUs(master.outbox[i].length);
+            }
+            startUs = now;
+            open = true;
+            // Land anywhere in the first half of the next period so refreshes
+            // sample heartbeat contention instead of repeating one phase.
+            refreshBaseUs += refreshUs;
+            nextRefreshUs = refreshBaseUs + offset(bus.rng());
+        }
+        bus.advance(now);
+    }
+    if (open) {
+        close();
+    }
+
+    if (result.refreshes) {
+        result.frames /= result.refreshes;
+        result.airUs /= result.refreshes;
+        uint64_t complete = result.refreshes - result.incomplete;
+        result.completeUs = complete ? result.completeUs / complete : 0;
+    }
+    return result;
+}
+
+} // namespace
+
+int benchScene(const SimConfig& config, FILE* out) {
+    static const uint16_t sizes[] = {8, 16, 32, 64, 128};
+
+    fprintf(out, "Grid refresh cost per strategy, %u s per run, one refresh per second, 1 s heartbeats\n",
+            config.seconds);
+    fprintf(out, "%7s  %-11s %8s %10s %12s %11s %9s\n", "slaves", "strategy", "frames", "air ms", "complete ms",
+            "vs unicast", "lost");
+    for (uint16_t size : sizes) {
+        double unicastAir = 0;
+        for (int strategy = 0; strategy < STRATEGY_COUNT; strategy++) {
+            RefreshResult r = runStrategy(config, (Strategy)strategy, size);
+            if (strategy == UNICAST) {
+                unicastAir = r.airUs;
+            }
+            fprintf(out, "%7u  %-11s %8.1f %10.2f %12.2f %10.1f%% %4llu/%llu\n", size, STRATEGY_NAMES[strategy],
+                    r.frames, r.airUs / 1000.0, r.completeUs / 1000.0,
+                    unicastAir > 0 ? 100.0 * r.airUs / unicastAir : 0.0, (unsigned long long)r.incomplete,
+                    (unsigned long long)r.refreshes);
+        }
+    }
+    fprintf(out, "(air = wire time of the refresh frames, complete = until the last slave applied its command,\n"
+                 " lost = refreshes where a slave missed its frame to a collision or the refresh overran its period)\n");
+    return 0;
+}
+
+} // namespace sim
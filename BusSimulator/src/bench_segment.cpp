@@ -0,0 +1,193 @@
+/*
+ * SegmentDisplay number formatting, per refresh of multiple_chain_devices.cpp.
+ *
+ * The demo's updateDisplays() formats nine displays every 10 ms: seven
+ * 4-digit ones with 1 decimal and two 8-digit ones with 4 decimals.
+ *
+ *   printf    what SegmentDisplay did before segment_format.h: snprintf
+ *             "%.*f" into a numDigits + 2 buffer, parsed back into digit
+ *             indices and decimal point flags, looked up on refresh
+ *   float     displayNumber(float): one multiply, then renderFixed()
+ *   fixed     displayFixed(): the caller's integer millis() arithmetic
+ *             and renderFixed(), no float at all
+ *
+ * Host timings have a hardware FPU; on the ESP8266 both printf and the
+ * float multiply are soft-float, so the gap is wider there. "differ" counts
+ * displays whose segments disagree with printf, among the numbers printf
+ * could show at all: it dropped the minus sign and cut numbers too wide for
+ * the display to their leading digits, which renderFixed() shows instead
+ * with fewer decimals or as the low digits. The rest are ties like 0.25,
+ * which printf rounds by the float's binary value or to even and
+ * renderFixed() callers round up.
+ */
+
+#include "../../Peripherals/lib/PeripheralFactory/src/segment_format.h"
+
+#include <string.h>
+
+#include "bench.h"
+
+namespace sim {
+namespace {
+
+const uint8_t BLANK_INDEX = 11;
+const uint8_t DISPLAYS = 9;
+
+// The old SegmentDisplay, minus the hardware
+struct PrintfDisplay {
+    uint8_t numDigits;
+    uint8_t digitValues[8];
+    bool dpValues[8];
+    bool intact; // neither negative nor cut to fit the buffer
+
+    void displayString(const char* str) {
+        for (int i = 0; i < numDigits; i++) {
+            digitValues[i] = BLANK_INDEX;
+            dpValues[i] = false;
+        }
+        int len = strlen(str);
+        int displayPos = numDigits - 1;
+        bool decimalFound = false;
+        for (int i = len - 1; i >= 0 && displayPos >= 0; i--) {
+            char c = str[i];
+            if (c >= '0' && c <= '9') {
+                digitValues[displayPos] = c - '0';
+                dpValues[displayPos] = decimalFound;
+                displayPos--;
+                decimalFound = false;
+            } else if (c == '.') {
+                decimalFound = true;
+            } else if (c == ' ') {
+                digitValues[displayPos--] = BLANK_INDEX;
+            }
+        }
+    }
+
+    void displayNumber(float number, uint8_t decimalPlaces) {
+        char buffer[numDigits + 2];
+        int length = snprintf(buffer, sizeof(buffer), "%.*f", decimalPlaces, number);
+        intact = number >= 0 && length < (int)sizeof(buffer);
+        displayString(buffer);
+    }
+
+    uint8_t segments(uint8_t digit) const {
+        uint8_t pattern = digitValues[digit] == BLANK_INDEX ? segment::BLANK : segment::DIGITS[digitValues[digit]];
+        return dpValues[digit] ? pattern | segment::DP : pattern;
+    }
+};
+
+struct SegmentFrame {
+    uint8_t segments[DISPLAYS][8];
+};
+
+const uint8_t WIDTH[DISPLAYS] = {4, 4, 4, 4, 4, 4, 4, 8, 8};
+
+__attribute__((noinline)) void refreshPrintf(PrintfDisplay* displays, uint32_t ms) {
+    float timesec = (float)ms / 1000;
+    displays[0].displayNumber(timesec, 1);
+    displays[1].displayNumber((float)1000 - timesec, 1);
+    for (int k = 2; k <= 6; k++) {
+        displays[k].displayNumber(timesec * k, 1);
+    }
+    displays[7].displayNumber(timesec, 4);
+    displays[8].displayNumber((float)(1000 - timesec), 4);
+}
+
+// SegmentDisplay::displayNumber(float, decimals) as it is now
+void renderFloat(float number, uint8_t decimals, uint8_t* out, uint8_t width) {
+    static const long scale[] = {1, 10, 100, 1000, 10000};
+    float scaled = number * scale[decimals];
+    segment::renderFixed((int32_t)(scaled + (scaled < 0 ? -0.5f : 0.5f)), decimals, out, width);
+}
+
+__attribute__((noinline)) void refreshFloat(SegmentFrame& frame, uint32_t ms) {
+    float timesec = (float)ms / 1000;
+    renderFloat(timesec, 1, frame.segments[0], 4);
+    renderFloat((float)1000 - timesec, 1, frame.segments[1], 4);
+    for (int k = 2; k <= 6; k++) {
+        renderFloat(timesec * k, 1, frame.segments[k], 4);
+    }
+    renderFloat(timesec, 4, frame.segments[7], 8);
+    renderFloat((float)(1000 - timesec), 4, frame.segments[8], 8);
+}
+
+__attribute__((noinline)) void refreshFixed(SegmentFrame& frame, uint32_t ms) {
+    // Same arithmetic as the demo's updateDisplays(): rounded to the shown
+    // decimal like printf, the time wrapped before any multiply
+    int32_t wrapped = ms % 10000000;
+    segment::renderFixed(segment::divideRounded(wrapped, 100), 1, frame.segments[0], 4);
+    segment::renderFixed(segment::divideRounded(1000000 - wrapped, 100), 1, frame.segments[1], 4);
+    for (int32_t k = 2; k <= 6; k++) {
+        segment::renderFixed(segment::divideRounded(wrapped * k, 100), 1, frame.segments[k], 4);
+    }
+    segment::renderFixed(wrapped * 10, 4, frame.segments[7], 8);
+    segment::renderFixed(10000000 - wrapped * 10, 4, frame.segments[8], 8);
+}
+
+uint32_t intact(const PrintfDisplay* displays) {
+    uint32_t count = 0;
+    for (uint8_t d = 0; d < DISPLAYS; d++) {
+        count += displays[d].intact;
+    }
+    return count;
+}
+
+uint32_t differing(const PrintfDisplay* displays, const SegmentFrame& frame) {
+    uint32_t count = 0;
+    for (uint8_t d = 0; d < DISPLAYS; d++) {
+        if (!displays[d].intact) {
+            continue;
+        }
+        for (uint8_t i = 0; i < WIDTH[d]; i++) {
+            if (displays[d].segments(i) != frame.segments[d][i]) {
+                count++;
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+int benchSegment(const SimConfig& config, FILE* out) {
+    (void)config;
+    // 0 .. 1200 s in 10 ms steps: past 1000 s display 1 goes negative
+    const uint64_t REFRESHES = 120000;
+
+    PrintfDisplay displays[DISPLAYS];
+    for (uint8_t d = 0; d < DISPLAYS; d++) {
+        displays[d].numDigits = WIDTH[d];
+    }
+    SegmentFrame floatFrame = {};
+    SegmentFrame fixedFrame = {};
+
+    uint32_t compared = 0;
+    uint32_t floatDiffer = 0;
+    uint32_t fixedDiffer = 0;
+    for (uint64_t i = 0; i < REFRESHES; i++) {
+        uint32_t ms = (uint32_t)i * 10;
+        refreshPrintf(displays, ms);
+        refreshFloat(floatFrame, ms);
+        refreshFixed(fixedFrame, ms);
+        compared += intact(displays);
+        floatDiffer += differing(displays, floatFrame);
+        fixedDiffer += differing(displays, fixedFrame);
+    }
+
+    double printfNs = nsPerIteration(REFRESHES, [&](uint64_t i) { refreshPrintf(displays, (uint32_t)i * 10); });
+    double floatNs = nsPerIteration(REFRESHES, [&](uint64_t i) { refreshFloat(floatFrame, (uint32_t)i * 10); });
+    double fixedNs = nsPerIteration(REFRESHES, [&](uint64_t i) { refreshFixed(fixedFrame, (uint32_t)i * 10); });
+
+    fprintf(out, "SegmentDisplay formatting, %u displays per refresh, host ns (best of 5 x %llu)\n", DISPLAYS,
+            (unsigned long long)REFRESHES);
+    fprintf(out, "%-8s %10s %9s %12s\n", "path", "ns/refresh", "speedup", "differ/1000");
+    fprintf(out, "%-8s %10.1f %8.2fx %12s\n", "printf", printfNs, 1.0, "-");
+    fprintf(out, "%-8s %10.1f %8.2fx %12.2f\n", "float", floatNs, printfNs / floatNs,
+            1000.0 * floatDiffer / compared);
+    fprintf(out, "%-8s %10.1f %8.2fx %12.2f\n", "fixed", fixedNs, printfNs / fixedNs,
+            1000.0 * fixedDiffer / compared);
+    return 0;
+}
+
+} // namespace sim
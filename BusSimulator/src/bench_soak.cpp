@@ -0,0 +1,80 @@
+/*
+ * Heap soak: the full simulation (OneWireHost + OneWireSlave sketches) for
+ * 24 simulated hours, with a heap watermark row per hour.
+ *
+ * Allocations are charged per owner (sim_heap.h): the com-prot send path
+ * must stay at zero, and the sketches' live heap must stay flat - a rising
+ * live byte count is a leak, growing per-hour allocation counts are churn
+ * that fragments the ESP8266 heap.
+ */
+
+#include "bench.h"
+#include "sim_heap.h"
+
+namespace sim {
+namespace {
+
+struct HeapMark {
+    uint64_t messages;
+    uint64_t firmwareAllocations;
+    uint64_t sendAllocations;
+};
+
+HeapMark markNow(const Simulation& simulation) {
+    return {simulation.stats().messagesSent, heapCounters(HEAP_FIRMWARE).allocations,
+            heapCounters(HEAP_SEND_PATH).allocations};
+}
+
+} // namespace
+
+int benchSoak(const SimConfig& base, FILE* out) {
+    static const uint32_t DAY_SECONDS = 24 * 3600;
+
+    SimConfig config = base;
+    if (config.seconds == SimConfig().seconds) {
+        config.seconds = DAY_SECONDS; // --seconds overrides the 24 h default
+    }
+    uint32_t periodMs = config.seconds >= 2 * 3600 ? 3600 * 1000 : 60 * 1000;
+
+    Simulation simulation(config);
+    HeapMark start = {0, 0, 0};
+    HeapMark last = start;
+    bool started = false;
+
+    fprintf(out, "Heap soak: %zu slaves, %u s simulated, %.0f cmd/s\n", simulation.slaveCount(), config.seconds,
+            config.commandRate);
+    fprintf(out, "%8s %10s %12s %12s %12s %12s\n", periodMs >= 3600 * 1000 ? "hour" : "minute", "messages",
+            "fw allocs", "send allocs", "fw live B", "fw peak B");
+    simulation.setObserver(periodMs, [&](uint64_t nowUs) {
+        HeapMark mark = markNow(simulation);
+        if (!started) {
+            // The first period still has setup() and the slaves coming online in it.
+            start = mark;
+            started = true;
+        }
+        const HeapCounters& firmware = heapCounters(HEAP_FIRMWARE);
+        fprintf(out, "%8llu %10llu %12llu %12llu %12lld %12lld\n", (unsigned long long)(nowUs / 1000 / periodMs),
+                (unsigned long long)(mark.messages - last.messages),
+                (unsigned long long)(mark.firmwareAllocations - last.firmwareAllocations),
+                (unsigned long long)(mark.sendAllocations - last.sendAllocations), (long long)firmware.liveBytes,
+                (long long)firmware.peakBytes);
+        resetHeapPeak(HEAP_FIRMWARE);
+        last = mark;
+    });
+    simulation.run();
+
+    HeapMark end = markNow(simulation);
+    uint64_t messages = end.messages - start.messages;
+    uint64_t sendAllocations = end.sendAllocations - start.sendAllocations;
+    uint64_t firmwareAllocations = end.firmwareAllocations - start.firmwareAllocations;
+    fprintf(out, "after the first period: %llu messages, %llu send path allocations (%.3f per message), "
+                 "%llu sketch allocations (%.3f per message)\n",
+            (unsigned long long)messages, (unsigned long long)sendAllocations,
+            messages ? (double)sendAllocations / messages : 0.0, (unsigned long long)firmwareAllocations,
+            messages ? (double)firmwareAllocations / messages : 0.0);
+    fprintf(out, "(fw = sketch loop() and handlers, send = com-prot send calls; live/peak are bytes still held by the\n"
+                 " sketches at the end of / at most during the period)\n");
+    return sendAllocations == 0 ? 0 : 1;
+}
+
+} // namespace sim
@@ -0,0 +1,67 @@
+/*
+ * Slotted (TDMA) vs carrier-sense bus access: the full simulation
+ * (OneWireHost + OneWireSlave sketches) for 8..64 slaves, once as is and
+ * once with --tdma (master beacon, one slot per slave, a master window of
+ * --tdma-window-ms for commands).
+ *
+ * Carrier sense gives the lower typical latency; slotted mode trades it for
+ * no collisions and a worst case that follows from the layout alone:
+ * tdmaCommandBoundUs() from sendCommand() to the slave, tdmaSlotBoundUs()
+ * from a slave frame being ready (heartbeat due, response sent) to the
+ * master. The bound columns are for the shortest command and a heartbeat
+ * with a telemetry keyframe; the over-bound count checks every frame
+ * against the bound for its own length.
+ */
+
+#include <telemetry.h>
+
+#include "bench.h"
+
+namespace sim {
+
+int benchTdma(const SimConfig& base, FILE* out) {
+    static const uint16_t sizes[] = {8, 16, 32, 64};
+    SimConfig config = base;
+    double seconds = config.seconds;
+
+    fprintf(out, "Slotted vs carrier sense access, %u s per run, %.0f cmd/s, %u ms master window\n",
+            config.seconds, config.commandRate, config.tdmaWindowMs);
+    fprintf(out, "%7s %-5s %7s %9s %9s %21s %9s %15s %9s %6s %8s\n", "slaves", "mode", "busy %", "coll/min",
+            "backoff/s", "cmd p50/p99/max ms", "bound", "up p99/max ms", "bound", "over", "timeouts");
+    for (uint16_t size : sizes) {
+        for (int slotted = 0; slotted < 2; slotted++) {
+            SimConfig runConfig = config;
+            runConfig.slaves = size;
+            runConfig.tdma = slotted;
+            Simulation simulation(runConfig);
+            simulation.run();
+
+            const BusCounters& bus = simulation.bus().counters();
+            const Bus& wire = simulation.bus();
+            const SimStats& stats = simulation.stats();
+            char command[32];
+            char uplink[32];
+            snprintf(command, sizeof(command), "%.1f/%.1f/%.1f", stats.commandLatencyUs.percentile(0.50) / 1000.0,
+                     stats.commandLatencyUs.percentile(0.99) / 1000.0, stats.commandLatencyUs.max() / 1000.0);
+            snprintf(uplink, sizeof(uplink), "%.1f/%.1f", stats.uplinkLatencyUs.percentile(0.99) / 1000.0,
+                     stats.uplinkLatencyUs.max() / 1000.0);
+            fprintf(out, "%7u %-5s %6.1f%% %9.1f %9.1f %21s", size, slotted ? "tdma" : "csma",
+                    100.0 * bus.busyUs / (seconds * 1e6), bus.collisions * 60.0 / seconds, bus.busyBackoffs / seconds,
+                    command);
+            if (const TdmaLayout* layout = simulation.tdmaLayout()) {
+                fprintf(out, " %9.1f %15s %9.1f %6llu", tdmaCommandBoundUs(*layout, wire.airTimeUs(3), simulation.startDelayUs()) / 1000.0,
+                        uplink,
+                        tdmaSlotBoundUs(*layout, wire.airTimeUs(4 + TelemetryEncoder::MAX_LENGTH), simulation.startDelayUs()) / 1000.0,
+                        (unsigned long long)(stats.commandsOverBound + stats.uplinkOverBound));
+            } else {
+                fprintf(out, " %9s %15s %9s %6s", "-", uplink, "-", "-");
+            }
+            fprintf(out, " %8llu\n", (unsigned long long)stats.slaveTimeouts);
+        }
+    }
+    fprintf(out, "(cmd = sendCommand() to the slave handler; up = slave frame ready to the master; bound = worst case\n"
+                 " from the TdmaLayout, while no more commands wait than fit one window; over = frames past theirs)\n");
+    return 0;
+}
+
+} // namespace sim
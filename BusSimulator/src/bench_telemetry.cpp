@@ -0,0 +1,279 @@
+/*
+ * Bus cost of plant telemetry (measured output + status nibble) per transport:
+ *
+ *   none        plain 1 s heartbeats, the baseline
+ *   heartbeat   TelemetryEncoder bytes appended to those heartbeats
+ *   poll        the master asks each slave once per second
+ *               ([COM_PROT_COMMAND, 0, STARWIRE_CMD_TELEMETRY], requests
+ *               spread over the second) and the slave answers with its full
+ *               value as a [COM_PROT_RESPONSE, STARWIRE_CMD_TELEMETRY] frame
+ *
+ * Every slave's output holds for 2..20 s, then ramps to a new level over
+ * 1.5 s like MOTOR_RAMP_MS, with a new status nibble (the command); a third
+ * of them add +-1 sensor noise like the solar reading. The master feeds a
+ * TelemetryTable, sampled every 100 ms against the true output.
+ */
+
+#include <com-prot.h>
+#include <telemetry.h>
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <stdlib.h>
+#include <vector>
+
+#include "bench.h"
+
+namespace sim {
+namespace {
+
+static const uint8_t MASTER_ID = 1;
+static const uint64_t STEP_US = 10000;   // output profile resolution
+static const uint64_t RAMP_US = 1500000;
+static const uint64_t SAMPLE_US = 100000;
+
+enum Transport { NONE, HEARTBEAT, POLL, TRANSPORT_COUNT };
+const char* const TRANSPORT_NAMES[TRANSPORT_COUNT] = {"none", "heartbeat", "poll"};
+
+/** What the plant really produces, advanced in 10 ms steps. */
+class OutputProfile {
+public:
+    OutputProfile(uint32_t seed, bool noisy) : _rng(seed), _noisy(noisy) {
+        _target = _from = _output = std::uniform_int_distribution<int>(0, 255)(_rng);
+        _holdUntilUs = hold();
+    }
+
+    void advance(uint64_t nowUs) {
+        while (_stepUs + STEP_US <= nowUs) {
+            _stepUs += STEP_US;
+            if (_stepUs >= _holdUntilUs) {
+                _from = _output;
+                _target = std::uniform_int_distribution<int>(0, 255)(_rng);
+                _status = 1 + (_status % 15);
+                _rampStartUs = _stepUs;
+                _holdUntilUs = _stepUs + RAMP_US + hold();
+            }
+            int level = _target;
+            if (_stepUs < _rampStartUs + RAMP_US) {
+                level = _from + (int)((_target - _from) * (int64_t)(_stepUs - _rampStartUs) / (int64_t)RAMP_US);
+            }
+            if (_noisy && std::uniform_int_distribution<int>(0, 3)(_rng) == 0) {
+                level += std::uniform_int_distribution<int>(0, 1)(_rng) ? 1 : -1;
+            }
+            _output = (uint8_t)std::min(255, std::max(0, level));
+        }
+    }
+
+    uint8_t output() const { return _output; }
+    uint8_t status() const { return _status; }
+
+private:
+    uint64_t hold() { return std::uniform_int_distribution<uint64_t>(2000000, 20000000)(_rng); }
+
+    std::mt19937 _rng;
+    bool _noisy;
+    int _from;
+    int _target;
+    uint8_t _output;
+    uint8_t _status = 1;
+    uint64_t _stepUs = 0;
+    uint64_t _rampStartUs = 0;
+    uint64_t _holdUntilUs;
+};
+
+class TelemetrySlave : public BusNode {
+public:
+    TelemetrySlave(uint8_t id, Transport transport, uint64_t heartbeatUs, uint64_t phaseUs, uint32_t seed)
+        : BusNode(id), profile(seed, id % 3 == 0), _transport(transport), _heartbeatUs(heartbeatUs),
+          _nextHeartbeatUs(phaseUs) {}
+
+    void onFrame(const Frame& frame, uint64_t nowUs) override {
+        if (_transport != POLL || frame.dst != id() || frame.length < 3 || frame.payload[0] != COM_PROT_COMMAND ||
+            frame.payload[2] != STARWIRE_CMD_TELEMETRY) {
+            return;
+        }
+        // Answered from the handler like sendResponse(); a poll always carries the full value
+        profile.advance(nowUs);
+        const uint8_t response[4] = {COM_PROT_RESPONSE, STARWIRE_CMD_TELEMETRY, (uint8_t)(0x80 | profile.status()),
+                                     profile.output()};
+        send(MASTER_ID, response, sizeof(response));
+    }
+
+    void poll(uint64_t nowUs) override {
+        if (nowUs < _nextHeartbeatUs) {
+            return;
+        }
+        profile.advance(nowUs);
+        uint8_t heartbeat[3 + TelemetryEncoder::MAX_LENGTH] = {COM_PROT_HEARTBEAT, id(), 1};
+        uint8_t length = 3;
+        if (_transport == HEARTBEAT) {
+            length += _encoder.encode(profile.output(), profile.status(), heartbeat + 3);
+        }
+        send(MASTER_ID, heartbeat, length);
+        heartbeatsSent++;
+        _nextHeartbeatUs += _heartbeatUs;
+    }
+
+    uint64_t nextWakeUs() const override { return _nextHeartbeatUs; }
+
+    OutputProfile profile;
+    uint64_t heartbeatsSent = 0;
+
+private:
+    Transport _transport;
+    TelemetryEncoder _encoder;
+    uint64_t _heartbeatUs;
+    uint64_t _nextHeartbeatUs;
+};
+
+class TelemetryMaster : public BusNode {
+public:
+    TelemetryMaster(Transport transport, uint16_t slaveCount, uint64_t periodUs)
+        : BusNode(MASTER_ID), _transport(transport), _slaveCount(slaveCount),
+          _pollGapUs(periodUs / (slaveCount ? slaveCount : 1)) {}
+
+    void onFrame(const Frame& frame, uint64_t) override {
+        if (frame.payload[0] == COM_PROT_HEARTBEAT && frame.length >= 3) {
+            heartbeats++;
+            table.update(frame.payload[1], frame.payload + 3, frame.length - 3);
+        } else if (frame.payload[0] == COM_PROT_RESPONSE && frame.length >= 2 &&
+                   frame.payload[1] == STARWIRE_CMD_TELEMETRY) {
+            table.update(frame.src, frame.payload + 2, frame.length - 2);
+        }
+    }
+
+    void poll(uint64_t nowUs) override {
+        if (_transport == POLL && nowUs >= _nextPollUs) {
+            _outbox.push_back(2 + _nextSlave);
+            _nextSlave = (_nextSlave + 1) % _slaveCount;
+            _nextPollUs += _pollGapUs;
+        }
+        while (!_outbox.empty() && pending() < MAX_PACKETS) {
+            const uint8_t request[3] = {COM_PROT_COMMAND, 0, STARWIRE_CMD_TELEMETRY};
+            send(_outbox.front(), request, sizeof(request));
+            _outbox.pop_front();
+        }
+    }
+
+    uint64_t nextWakeUs() const override {
+        if (!_outbox.empty() && pending() < MAX_PACKETS) {
+            return 0;
+        }
+        return _transport == POLL ? _nextPollUs : UINT64_MAX;
+    }
+
+    TelemetryTable table;
+    uint64_t heartbeats = 0;
+
+private:
+    Transport _transport;
+    uint16_t _slaveCount;
+    uint64_t _pollGapUs;
+    uint64_t _nextPollUs = 0;
+    uint16_t _nextSlave = 0;
+    std::deque<uint8_t> _outbox;
+};
+
+struct TelemetryResult {
+    BusCounters bus;
+    double heartbeatLoss = 0; // fraction of heartbeats that never reached the master
+    double meanError = 0;     // |table - truth| over samples with a valid reading
+    double invalid = 0;       // fraction of samples without a valid reading
+};
+
+TelemetryResult runTransport(const SimConfig& config, Transport transport, uint16_t slaveCount) {
+    Bus bus(config.bus, config.seed);
+    uint64_t heartbeatUs = (uint64_t)config.heartbeatMs * 1000;
+    TelemetryMaster master(transport, slaveCount, heartbeatUs);
+    bus.attach(&master);
+
+    std::vector<std::unique_ptr<TelemetrySlave>> slaves;
+    std::uniform_int_distribution<uint64_t> phase(0, heartbeatUs - 1);
+    std::uniform_int_distribution<int32_t> skew(-(int32_t)config.clockPpm, (int32_t)config.clockPpm);
+    for (uint16_t i = 0; i < slaveCount; i++) {
+        uint64_t periodUs = heartbeatUs + (int64_t)config.heartbeatMs * skew(bus.rng()) / 1000;
+        // Same profile seed per slave in every run, so transports see the same plants
+        slaves.emplace_back(new TelemetrySlave(2 + i, transport, periodUs, phase(bus.rng()), config.seed * 1000 + i));
+        bus.attach(slaves.back().get());
+    }
+
+    TelemetryResult result;
+    uint64_t endUs = (uint64_t)config.seconds * 1000000;
+    uint64_t warmupUs = (uint64_t)config.warmupMs * 1000;
+    uint64_t tick = config.tickUs ? config.tickUs : 1;
+    uint64_t nextSampleUs = warmupUs;
+    uint64_t now = 0;
+    uint64_t samples = 0;
+    uint64_t invalid = 0;
+    uint64_t errorSum = 0;
+
+    while (true) {
+        uint64_t next = std::min(bus.nextEventUs(), nextSampleUs);
+        next = std::max((next + tick - 1) / tick * tick, now + tick);
+        if (next > endUs) {
+            break;
+        }
+        now = next;
+        bus.advance(now);
+
+        if (now >= nextSampleUs) {
+            for (auto& slave : slaves) {
+                slave->profile.advance(now);
+                samples++;
+                if (!master.table.valid(slave->id())) {
+                    invalid++;
+                } else {
+                    errorSum += abs((int)master.table.output(slave->id()) - slave->profile.output());
+                }
+            }
+            nextSampleUs += SAMPLE_US;
+        }
+    }
+
+    result.bus = bus.counters();
+    uint64_t sent = 0;
+    for (auto& slave : slaves) {
+        sent += slave->heartbeatsSent;
+    }
+    result.heartbeatLoss = sent ? 1.0 - (double)master.heartbeats / sent : 0.0;
+    result.invalid = samples ? (double)invalid / samples : 0.0;
+    result.meanError = samples > invalid ? (double)errorSum / (samples - invalid) : 0.0;
+    return result;
+}
+
+} // namespace
+
+int benchTelemetry(const SimConfig& config, FILE* out) {
+    static const uint16_t sizes[] = {8, 16, 32, 64};
+    double seconds = config.seconds;
+
+    fprintf(out, "Telemetry transports, %u s per run, %u ms heartbeats, tracking sampled every %llu ms\n",
+            config.seconds, config.heartbeatMs, (unsigned long long)(SAMPLE_US / 1000));
+    fprintf(out, "%7s  %-10s %9s %9s %11s %8s %9s %8s %9s %6s\n", "slaves", "transport", "frames/s", "+frames/s",
+            "+air ms/s", "+busy %", "coll/min", "hb lost", "err", "stale");
+    for (uint16_t size : sizes) {
+        TelemetryResult base;
+        for (int transport = 0; transport < TRANSPORT_COUNT; transport++) {
+            TelemetryResult r = runTransport(config, (Transport)transport, size);
+            if (transport == NONE) {
+                base = r;
+            }
+            double extraFrames = ((double)r.bus.framesSent - base.bus.framesSent) / seconds;
+            double extraAirMs = ((double)r.bus.busyUs - base.bus.busyUs) / seconds / 1000.0;
+            fprintf(out, "%7u  %-10s %9.1f %9.1f %11.2f %7.2f%% %9.1f %7.2f%%", size, TRANSPORT_NAMES[transport],
+                    r.bus.framesSent / seconds, extraFrames, extraAirMs, extraAirMs / 10.0,
+                    r.bus.collisions * 60.0 / seconds, 100.0 * r.heartbeatLoss);
+            if (transport == NONE) {
+                fprintf(out, " %9s %6s\n", "-", "-");
+            } else {
+                fprintf(out, " %9.2f %5.1f%%\n", r.meanError, 100.0 * r.invalid);
+            }
+        }
+    }
+    fprintf(out, "(+ = on top of plain heartbeats; air = wire time incl. retries; err = mean |output error|\n"
+                 " while the master holds a valid reading; stale = samples without one, incl. lost deltas)\n");
+    return 0;
+}
+
+} // namespace sim
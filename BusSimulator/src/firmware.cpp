@@ -0,0 +1,41 @@
+#include "firmware.h"
+
+namespace sim {
+
+static std::vector<SlaveFirmware>& slaveRegistry() {
+    static std::vector<SlaveFirmware> registry;
+    return registry;
+}
+
+static MasterFirmware*& masterRegistry() {
+    static MasterFirmware* registry = nullptr;
+    return registry;
+}
+
+const std::vector<SlaveFirmware>& slaveFirmwares() {
+    return slaveRegistry();
+}
+
+const SlaveFirmware* findSlaveFirmware(uint8_t type) {
+    for (const SlaveFirmware& firmware : slaveRegistry()) {
+        if (firmware.type == type) {
+            return &firmware;
+        }
+    }
+    return nullptr;
+}
+
+const MasterFirmware* masterFirmware() {
+    return masterRegistry();
+}
+
+SlaveFirmwareRegistration::SlaveFirmwareRegistration(const SlaveFirmware& firmware) {
+    slaveRegistry().push_back(firmware);
+}
+
+MasterFirmwareRegistration::MasterFirmwareRegistration(const MasterFirmware& firmware) {
+    static MasterFirmware instance = firmware;
+    masterRegistry() = &instance;
+}
+
+} // namespace sim
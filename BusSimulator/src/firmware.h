@@ -0,0 +1,39 @@
+#ifndef SIM_FIRMWARE_H
+#define SIM_FIRMWARE_H
+
+#include <com-prot.h>
+#include <vector>
+
+namespace sim {
+
+/** One build of OneWireSlave/src/main.cpp for a single SLAVE_TYPE. */
+struct SlaveFirmware {
+    uint8_t type;
+    const char* name;
+    StarWire::ComProtSlave* protocol;
+    void (*setup)();
+    void (*loop)();
+};
+
+/** The OneWireHost/src/main.cpp build. */
+struct MasterFirmware {
+    ComProtMaster* protocol;
+    void (*setup)();
+    void (*loop)();
+};
+
+const std::vector<SlaveFirmware>& slaveFirmwares();
+const SlaveFirmware* findSlaveFirmware(uint8_t type);
+const MasterFirmware* masterFirmware();
+
+struct SlaveFirmwareRegistration {
+    explicit SlaveFirmwareRegistration(const SlaveFirmware& firmware);
+};
+
+struct MasterFirmwareRegistration {
+    explicit MasterFirmwareRegistration(const MasterFirmware& firmware);
+};
+
+} // namespace sim
+
+#endif // SIM_FIRMWARE_H
@@ -0,0 +1,23 @@
+/*
+ * Builds OneWireHost/src/main.cpp against the shims and registers its
+ * ComProtMaster and setup()/loop() with the simulator.
+ */
+
+#include <Arduino.h>
+#include <com-prot.h>
+#include <ota.h>
+#include <fleet_state.h>
+#include <scene_frame.h>
+#include <slave_registry.h>
+#include <telemetry.h>
+#include <heartbeat_schedule.h>
+#include <tdma.h>
+#include <link_stats.h>
+
+#include "firmware.h"
+
+namespace fw_host {
+#include "../../OneWireHost/src/main.cpp"
+}
+
+static sim::MasterFirmwareRegistration host({&fw_host::master, fw_host::setup, fw_host::loop});
@@ -0,0 +1,94 @@
+/*
+ * Builds OneWireSlave/src/main.cpp once per powerplant type. Every copy sits
+ * in its own namespace so the sketch globals do not clash, and the
+ * registration after each block hands its ComProtSlave and setup()/loop()
+ * to the simulator. Headers are included up front so their include guards
+ * keep them out of the namespaces.
+ *
+ * Sketch state is per build, not per virtual slave: e.g. the fleet sync
+ * "already applied" check is shared by all slaves of one type.
+ */
+
+// Same log level as a default device build, so Serial byte counts match
+#define STARWIRE_LOG_LEVEL 4
+
+#include <Arduino.h>
+#include <com-prot.h>
+#include <PeripheralFactory.h>
+#include <plant_actions.h>
+#include <scene_frame.h>
+#include <fleet_state.h>
+#include <bus_service_stats.h>
+#include <spsc_queue.h>
+#include <animator.h>
+#include <change_tracking.h>
+#include <adc_filter.h>
+#include <telemetry.h>
+#include <heartbeat_schedule.h>
+#include <latency_histogram.h>
+#include <link_stats.h>
+#include <binary_log.h>
+#include <log_events.h>
+
+#include "firmware.h"
+#include "simulation.h"
+
+// One build serves every virtual slave of its type, so the id comes from
+// whichever slave the simulator is delivering to.
+#define SLAVE_ID (sim::currentSlaveId())
+
+#define SLAVE_TYPE 1
+namespace fw_photovoltaic {
+#include "../../OneWireSlave/src/main.cpp"
+}
+#undef SLAVE_TYPE
+static sim::SlaveFirmwareRegistration photovoltaic({1, "photovoltaic", &fw_photovoltaic::slave, fw_photovoltaic::setup, fw_photovoltaic::loop});
+
+#define SLAVE_TYPE 2
+namespace fw_wind {
+#include "../../OneWireSlave/src/main.cpp"
+}
+#undef SLAVE_TYPE
+static sim::SlaveFirmwareRegistration wind({2, "wind", &fw_wind::slave, fw_wind::setup, fw_wind::loop});
+
+#define SLAVE_TYPE 3
+namespace fw_nuclear {
+#include "../../OneWireSlave/src/main.cpp"
+}
+#undef SLAVE_TYPE
+static sim::SlaveFirmwareRegistration nuclear({3, "nuclear", &fw_nuclear::slave, fw_nuclear::setup, fw_nuclear::loop});
+
+#define SLAVE_TYPE 4
+namespace fw_gas {
+#include "../../OneWireSlave/src/main.cpp"
+}
+#undef SLAVE_TYPE
+static sim::SlaveFirmwareRegistration gas({4, "gas", &fw_gas::slave, fw_gas::setup, fw_gas::loop});
+
+#define SLAVE_TYPE 5
+namespace fw_hydro {
+#include "../../OneWireSlave/src/main.cpp"
+}
+#undef SLAVE_TYPE
+static sim::SlaveFirmwareRegistration hydro({5, "hydro", &fw_hydro::slave, fw_hydro::setup, fw_hydro::loop});
+
+#define SLAVE_TYPE 6
+namespace fw_hydro_storage {
+#include "../../OneWireSlave/src/main.cpp"
+}
+#undef SLAVE_TYPE
+static sim::SlaveFirmwareRegistration hydroStorage({6, "hydro_storage", &fw_hydro_storage::slave, fw_hydro_storage::setup, fw_hydro_storage::loop});
+
+#define SLAVE_TYPE 7
+namespace fw_coal {
+#include "../../OneWireSlave/src/main.cpp"
+}
+#undef SLAVE_TYPE
+static sim::SlaveFirmwareRegistration coal({7, "coal", &fw_coal::slave, fw_coal::setup, fw_coal::loop});
+
+#define SLAVE_TYPE 8
+namespace fw_battery {
+#include "../../OneWireSlave/src/main.cpp"
+}
+#undef SLAVE_TYPE
+static sim::SlaveFirmwareRegistration battery({8, "battery", &fw_battery::slave, fw_battery::setup, fw_battery::loop});
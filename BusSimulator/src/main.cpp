@@ -0,0 +1,183 @@
+/*
+ * StarWire bus simulator
+ *
+ * Runs the OneWireHost master sketch and N virtual OneWireSlave powerplants
+ * on a simulated SoftwareBitBang wire and reports throughput, latency and
+ * heartbeat jitter.
+ *
+ *   program --slaves 64 --seconds 60 --rate 50
+ *   program --sweep --seconds 30
+ *   program --bench dispatch
+ */
+
+#include <stdio.h>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "shim_control.h"
+#include "simulation.h"
+
+static void usage() {
+    printf("usage: program [options]\n"
+           "  --slaves N         virtual slaves, 1..253 (default 12)\n"
+           "  --types a,b,...    slave types to cycle through (default: all)\n"
+           "  --seconds S        simulated duration (default 60)\n"
+           "  --rate R           unicast commands per second from the master (default 20)\n"
+           "  --heartbeat-ms T   periodic heartbeat period, slaves without a schedule (default 1000)\n"
+           "  --fixed-heartbeat  ignore the sketches' HeartbeatSchedule, plain periodic heartbeats\n"
+           "  --tdma             slotted mode: master beacon, one slot per slave, command window\n"
+           "  --tdma-window-ms M master window per cycle with --tdma, 1..255 (default 150)\n"
+           "  --bit-us B         bit width in us (default 40)\n"
+           "  --spacer-us P      per-byte spacer in us (default 112)\n"
+           "  --sense-us W       carrier sense blind window in us (default 40)\n"
+           "  --ber E            bit error rate, e.g. 1e-5 (default 0)\n"
+           "  --loop-us L        sketch loop() period (default 1000)\n"
+           "  --tick-us K        event loop resolution (default 10)\n"
+           "  --seed N           random seed (default 1)\n"
+           "  --trace FILE       A0 readings, one per line 10 ms apart, for --bench adc\n"
+           "  --sweep            run 8, 16, 32, 64, 128 and 253 slaves and print a table\n"
+           "  --link-stats       ask every slave for its link stats over the bus and print a\n"
+           "                     table of every node's link counters after the report\n"
+           "  --link-stats-ms T  how often each slave is asked with --link-stats (default 10000)\n"
+           "  --verbose          echo sketch Serial output\n"
+           "  --bench NAME       run a benchmark instead of a simulation:\n");
+    sim::listBenches(stdout);
+}
+
+static std::vector<uint8_t> parseTypes(const char* list) {
+    std::vector<uint8_t> types;
+    while (*list) {
+        types.push_back((uint8_t)strtoul(list, (char**)&list, 10));
+        if (*list == ',') {
+            list++;
+        } else if (*list) {
+            break;
+        }
+    }
+    return types;
+}
+
+static void sweep(sim::SimConfig config) {
+    static const uint16_t sizes[] = {8, 16, 32, 64, 128, 253};
+
+    printf("%7s %7s %9s %8s %10s %10s %12s %8s %9s\n", "slaves", "util%", "collide%", "cmd/s", "p50 ms", "p99 ms",
+           "hb p99 ms", "hb miss", "timeouts");
+    for (uint16_t size : sizes) {
+        config.slaves = size;
+        sim::Simulation simulation(config);
+        simulation.run();
+
+        const sim::BusCounters& c = simulation.bus().counters();
+        const sim::SimStats& s = simulation.stats();
+        double measured = config.seconds - config.warmupMs / 1000.0;
+        printf("%7zu %7.1f %9.2f %8.1f %10.2f %10.2f %12.2f %8llu %9llu\n", simulation.slaveCount(),
+               100.0 * c.busyUs / (config.seconds * 1e6), c.framesSent ? 100.0 * c.collisions / c.framesSent : 0.0,
+               s.commandsHandled / measured, s.commandLatencyUs.percentile(0.50) / 1000.0,
+               s.commandLatencyUs.percentile(0.99) / 1000.0, s.heartbeatJitterUs.percentile(0.99) / 1000.0,
+               (unsigned long long)s.heartbeatsMissed, (unsigned long long)s.slaveTimeouts);
+    }
+}
+
+int main(int argc, char** argv) {
+    sim::SimConfig config;
+    bool runSweep = false;
+    bool linkStats = false;
+    const sim::Bench* bench = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool consumed = true;
+
+        if (!strcmp(arg, "--sweep")) {
+            runSweep = true;
+            consumed = false;
+        } else if (!strcmp(arg, "--verbose")) {
+            config.verbose = true;
+            consumed = false;
+        } else if (!strcmp(arg, "--fixed-heartbeat")) {
+            config.fixedHeartbeat = true;
+            consumed = false;
+        } else if (!strcmp(arg, "--tdma")) {
+            config.tdma = true;
+            consumed = false;
+        } else if (!strcmp(arg, "--link-stats")) {
+            linkStats = true;
+            if (!config.linkStatsMs) {
+                config.linkStatsMs = 10000;
+            }
+            consumed = false;
+        } else if (!strcmp(arg, "--help") || !value) {
+            usage();
+            return strcmp(arg, "--help") ? 1 : 0;
+        } else if (!strcmp(arg, "--bench")) {
+            bench = sim::findBench(value);
+            if (!bench) {
+                fprintf(stderr, "unknown benchmark '%s'\n", value);
+                usage();
+                return 1;
+            }
+        } else if (!strcmp(arg, "--slaves")) {
+            config.slaves = atoi(value);
+        } else if (!strcmp(arg, "--types")) {
+            config.types = parseTypes(value);
+        } else if (!strcmp(arg, "--seconds")) {
+            config.seconds = atoi(value);
+        } else if (!strcmp(arg, "--rate")) {
+            config.commandRate = atof(value);
+        } else if (!strcmp(arg, "--heartbeat-ms")) {
+            config.heartbeatMs = atoi(value);
+        } else if (!strcmp(arg, "--link-stats-ms")) {
+            config.linkStatsMs = atoi(value);
+        } else if (!strcmp(arg, "--tdma-window-ms")) {
+            config.tdmaWindowMs = std::min(255, std::max(1, atoi(value)));
+        } else if (!strcmp(arg, "--bit-us")) {
+            config.bus.bitUs = atoi(value);
+        } else if (!strcmp(arg, "--spacer-us")) {
+            config.bus.spacerUs = atoi(value);
+        } else if (!strcmp(arg, "--sense-us")) {
+            config.bus.senseUs = atoi(value);
+        } else if (!strcmp(arg, "--ber")) {
+            config.bus.bitErrorRate = atof(value);
+        } else if (!strcmp(arg, "--loop-us")) {
+            config.loopUs = atoi(value);
+        } else if (!strcmp(arg, "--tick-us")) {
+            config.tickUs = atoi(value);
+        } else if (!strcmp(arg, "--seed")) {
+            config.seed = atoi(value);
+        } else if (!strcmp(arg, "--trace")) {
+            config.tracePath = value;
+        } else {
+            usage();
+            return 1;
+        }
+        if (consumed) {
+            i++;
+        }
+    }
+
+    if (config.slaves == 0 || config.slaves > 253) {
+        fprintf(stderr, "--slaves must be 1..253 (8-bit PJON ids, 0/1/255 reserved)\n");
+        return 1;
+    }
+    sim::setSerialEcho(config.verbose);
+
+    if (bench) {
+        return bench->run(config, stdout);
+    }
+    if (runSweep) {
+        sweep(config);
+        return 0;
+    }
+
+    sim::Simulation simulation(config);
+    simulation.run();
+    simulation.report(stdout);
+    if (linkStats) {
+        printf("\n");
+        simulation.reportLinks(stdout);
+    }
+    return 0;
+}
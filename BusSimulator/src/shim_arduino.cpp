@@ -0,0 +1,175 @@
+#include <Arduino.h>
+#include <ota.h>
+#include <stdio.h>
+
+#include "shim_control.h"
+#include "simulation.h"
+
+HardwareSerial Serial;
+HardwareSerial WebSerial;
+SimWiFi WiFi;
+
+namespace sim {
+
+static bool g_serialEcho = false;
+static int (*g_analogSource)(uint8_t pin) = nullptr;
+
+void setSerialEcho(bool echo) {
+    g_serialEcho = echo;
+}
+
+void setAnalogSource(int (*source)(uint8_t pin)) {
+    g_analogSource = source;
+}
+
+} // namespace sim
+
+// ---------- Time ----------
+
+unsigned long millis() {
+    return (unsigned long)(sim::clockUs() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)sim::clockUs();
+}
+
+// The sketches only delay while waiting for USB or in OTA mode; simulated
+// time is owned by the event loop, so these return immediately.
+void delay(unsigned long ms) {
+    (void)ms;
+}
+
+void delayMicroseconds(unsigned int us) {
+    (void)us;
+}
+
+void yield() {}
+
+// ---------- GPIO ----------
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    (void)pin;
+    (void)value;
+}
+
+int digitalRead(uint8_t pin) {
+    (void)pin;
+    return HIGH; // pulled up, e.g. the OTA-mode strap on D0 stays inactive
+}
+
+int analogRead(uint8_t pin) {
+    if (sim::g_analogSource) {
+        return sim::g_analogSource(pin);
+    }
+    return 512;
+}
+
+void analogWrite(uint8_t pin, int value) {
+    (void)pin;
+    (void)value;
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+long random(long howbig) {
+    return howbig > 0 ? rand() % howbig : 0;
+}
+
+long random(long howsmall, long howbig) {
+    return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall);
+}
+
+// ---------- Serial ----------
+
+void HardwareSerial::begin(unsigned long baud) {
+    (void)baud;
+}
+
+size_t HardwareSerial::emit(const char* s, size_t len) {
+    _bytesWritten += len;
+    if (sim::g_serialEcho) {
+        fwrite(s, 1, len, stdout);
+    }
+    return len;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return emit((const char*)&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    return emit((const char*)buffer, size);
+}
+
+int HardwareSerial::availableForWrite() {
+    return 128;
+}
+
+size_t HardwareSerial::print(const char* s) {
+    return emit(s, strlen(s));
+}
+
+size_t HardwareSerial::print(char c) {
+    return emit(&c, 1);
+}
+
+size_t HardwareSerial::print(long n) {
+    char buffer[24];
+    int len = snprintf(buffer, sizeof(buffer), "%ld", n);
+    return emit(buffer, len);
+}
+
+size_t HardwareSerial::print(unsigned long n) {
+    char buffer[24];
+    int len = snprintf(buffer, sizeof(buffer), "%lu", n);
+    return emit(buffer, len);
+}
+
+size_t HardwareSerial::print(double n, int digits) {
+    char buffer[32];
+    int len = snprintf(buffer, sizeof(buffer), "%.*f", digits, n);
+    return emit(buffer, len);
+}
+
+size_t HardwareSerial::println() {
+    return emit("\r\n", 2);
+}
+
+size_t HardwareSerial::printf(const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (len < 0) {
+        return 0;
+    }
+    return emit(buffer, std::min((size_t)len, sizeof(buffer) - 1));
+}
+
+// ---------- ota ----------
+
+void connectWifi(const char* ssid, const char* password) {
+    (void)ssid;
+    (void)password;
+}
+
+void setupOTA(int port, const char* hostname, const char* password) {
+    (void)port;
+    (void)hostname;
+    (void)password;
+}
+
+void setupWebSerial(const char* hostname) {
+    (void)hostname;
+}
+
+void handleOTA() {}
@@ -0,0 +1,190 @@
+#include <com-prot.h>
+#include <message_builder.h>
+
+#include "sim_heap.h"
+#include "simulation.h"
+
+// ---------- ComProtMaster ----------
+
+ComProtMaster::ComProtMaster(uint8_t masterId, uint8_t pin) : _id(masterId) {
+    (void)pin;
+}
+
+void ComProtMaster::begin() {
+    sim::Simulation* simulation = sim::Simulation::active();
+    _port = simulation ? simulation->masterPort(_id) : nullptr;
+    _slaves.clear();
+    if (_port && _tdma) {
+        _port->setTdma(_tdmaLayout);
+    }
+}
+
+bool ComProtMaster::sendCommand(uint8_t dst, uint8_t targetType, uint8_t command, const uint8_t* data, uint8_t dataLen) {
+    sim::HeapScope scope(sim::HEAP_SEND_PATH);
+    if (!_port) {
+        return false;
+    }
+    MessageBuilder<sim::PACKET_MAX_LENGTH> message;
+    message.command(targetType, command).put(data, dataLen);
+    if (sim::Simulation* simulation = sim::Simulation::active()) {
+        simulation->stats().messagesSent++;
+    }
+    return message.ok() && _port->queue(dst, message.data(), message.length());
+}
+
+bool ComProtMaster::sendCommandToSlaveType(uint8_t slaveType, uint8_t command, const uint8_t* data, uint8_t dataLen) {
+    // Like the library: only broadcast when someone of that type is listening.
+    bool listening = false;
+    for (const SlaveInfo& slave : _slaves) {
+        if (slave.type == slaveType) {
+            listening = true;
+            break;
+        }
+    }
+    if (!listening) {
+        return false;
+    }
+    return sendCommand(sim::BROADCAST, slaveType, command, data, dataLen);
+}
+
+bool ComProtMaster::sendCommandToSlaveId(uint8_t slaveId, uint8_t command, const uint8_t* data, uint8_t dataLen) {
+    return sendCommand(slaveId, 0, command, data, dataLen);
+}
+
+void ComProtMaster::handleHeartbeat(uint8_t slaveId, uint8_t slaveType, uint32_t timeoutMs) {
+    for (SlaveInfo& slave : _slaves) {
+        if (slave.id == slaveId) {
+            slave.type = slaveType;
+            slave.lastHeartbeat = millis();
+            slave.timeoutMs = timeoutMs;
+            return;
+        }
+    }
+    _slaves.push_back({slaveId, slaveType, millis(), timeoutMs});
+}
+
+void ComProtMaster::removeTimedOutSlaves() {
+    unsigned long now = millis();
+    size_t before = _slaves.size();
+    _slaves.erase(std::remove_if(_slaves.begin(), _slaves.end(),
+                                 [now](const SlaveInfo& slave) { return now - slave.lastHeartbeat > slave.timeoutMs; }),
+                  _slaves.end());
+    if (sim::Simulation* simulation = sim::Simulation::active()) {
+        simulation->stats().slaveTimeouts += before - _slaves.size();
+    }
+}
+
+void ComProtMaster::update() {
+    if (!_port) {
+        return;
+    }
+
+    sim::Frame frame;
+    uint64_t receivedUs;
+    while (_port->pop(frame, receivedUs)) {
+        if (frame.length == 0) {
+            continue;
+        }
+        if (_debugHandler) {
+            _debugHandler(frame.payload, frame.length, frame.src, frame.payload[0]);
+        }
+        HeartbeatFrame heartbeat;
+        if (frame.payload[0] == COM_PROT_HEARTBEAT && parseHeartbeat(frame.payload, frame.length, heartbeat)) {
+            // Unannounced heartbeats get COM_PROT_HEARTBEAT_TIMEOUT, as before
+            handleHeartbeat(heartbeat.slaveId, heartbeat.slaveType, heartbeatTimeoutMs(heartbeat.intervalMs));
+            if (sim::Simulation* simulation = sim::Simulation::active()) {
+                simulation->heartbeatProcessed(heartbeat.slaveId, sim::clockUs(),
+                                               heartbeat.announced ? heartbeat.intervalMs : 0);
+            }
+        }
+    }
+    removeTimedOutSlaves();
+}
+
+const LinkCounters& ComProtMaster::linkCounters() const {
+    static const LinkCounters none;
+    return _port ? _port->link() : none;
+}
+
+std::vector<SlaveInfo> ComProtMaster::getConnectedSlaves() const {
+    return _slaves;
+}
+
+std::vector<SlaveInfo> ComProtMaster::getSlavesByType(uint8_t slaveType) const {
+    std::vector<SlaveInfo> result;
+    for (const SlaveInfo& slave : _slaves) {
+        if (slave.type == slaveType) {
+            result.push_back(slave);
+        }
+    }
+    return result;
+}
+
+bool ComProtMaster::isSlaveConnected(uint8_t slaveId) const {
+    for (const SlaveInfo& slave : _slaves) {
+        if (slave.id == slaveId) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t ComProtMaster::getSlaveCount() const {
+    return _slaves.size();
+}
+
+// ---------- ComProtSlave ----------
+
+namespace StarWire {
+
+ComProtSlave::ComProtSlave(uint16_t slaveId, uint8_t slaveType, uint8_t dataPin, uint8_t clockPin) : _type(slaveType) {
+    (void)slaveId;
+    (void)dataPin;
+    (void)clockPin;
+}
+
+void ComProtSlave::setCommandHandler(uint8_t command, CommandHandler handler) {
+    _handlers[command] = handler;
+}
+
+bool ComProtSlave::sendResponse(uint8_t command, const uint8_t* data, uint8_t dataLen) {
+    sim::HeapScope scope(sim::HEAP_SEND_PATH);
+    sim::Simulation* simulation = sim::Simulation::active();
+    sim::VirtualSlave* node = simulation ? simulation->currentSlave() : nullptr;
+    if (!node) {
+        return false;
+    }
+    MessageBuilder<sim::PACKET_MAX_LENGTH> message;
+    message.response(command).put(data, dataLen);
+    simulation->stats().messagesSent++;
+    return message.ok() && node->send(1, message.data(), message.length());
+}
+
+const LinkCounters& ComProtSlave::linkCounters() const {
+    static const LinkCounters none;
+    sim::Simulation* simulation = sim::Simulation::active();
+    sim::VirtualSlave* node = simulation ? simulation->currentSlave() : nullptr;
+    return node ? node->link() : none;
+}
+
+void ComProtSlave::heartbeatActivity() {
+    sim::Simulation* simulation = sim::Simulation::active();
+    if (sim::VirtualSlave* node = simulation ? simulation->currentSlave() : nullptr) {
+        node->heartbeatActivity(sim::clockUs());
+    }
+}
+
+bool ComProtSlave::deliver(const uint8_t* payload, uint16_t length, uint8_t senderId) {
+    uint8_t copy[sim::PACKET_MAX_LENGTH];
+    memcpy(copy, payload, length);
+    if (_debugHandler) {
+        _debugHandler(copy, length, senderId, copy[0]);
+    }
+    if (length < 3 || copy[0] != COM_PROT_COMMAND || !_handlers[copy[2]]) {
+        return false;
+    }
+    _handlers[copy[2]](copy[2], senderId);
+    return true;
+}
+
+} // namespace StarWire
@@ -0,0 +1,16 @@
+#ifndef SIM_SHIM_CONTROL_H
+#define SIM_SHIM_CONTROL_H
+
+#include <stdint.h>
+
+namespace sim {
+
+/** Echo sketch Serial/WebSerial output to stdout. */
+void setSerialEcho(bool echo);
+
+/** Overrides analogRead(); nullptr restores the mid-scale default. */
+void setAnalogSource(int (*source)(uint8_t pin));
+
+} // namespace sim
+
+#endif // SIM_SHIM_CONTROL_H
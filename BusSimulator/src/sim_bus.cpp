@@ -0,0 +1,229 @@
+#include "sim_bus.h"
+
+#include <string.h>
+#include <math.h>
+
+namespace sim {
+
+bool BusNode::send(uint8_t dst, const uint8_t* payload, uint8_t length) {
+    return send(dst, payload, length, _bus ? _bus->_now : 0);
+}
+
+bool BusNode::send(uint8_t dst, const uint8_t* payload, uint8_t length, uint64_t readyUs) {
+    if (!_bus) {
+        return false;
+    }
+    if (length + _bus->_config.overheadBytes > PACKET_MAX_LENGTH) {
+        _bus->_counters.oversize++;
+        return false;
+    }
+    if (_count >= MAX_PACKETS) {
+        _bus->_counters.queueFull++;
+        return false;
+    }
+
+    Frame& frame = _queue[(_head + _count) % MAX_PACKETS];
+    frame.src = _id;
+    frame.dst = dst;
+    frame.length = length;
+    memcpy(frame.payload, payload, length);
+    frame.queuedUs = readyUs < _bus->_now ? readyUs : _bus->_now;
+    frame.attempts = 0;
+    _count++;
+    _bus->queued(this);
+    return true;
+}
+
+uint64_t BusNode::airTimeUs(uint8_t payloadLength) const {
+    return _bus ? _bus->airTimeUs(payloadLength) : 0;
+}
+
+Bus::Bus(const BusConfig& config, uint32_t seed) : _config(config), _rng(seed) {
+    _active.reserve(16);
+}
+
+void Bus::attach(BusNode* node) {
+    node->_bus = this;
+    _nodes.push_back(node);
+}
+
+uint64_t Bus::airTimeUs(uint8_t payloadLength) const {
+    // Frame initializer is three spacer+bit pulses, then every byte is
+    // preceded by a spacer and clocked out bit by bit.
+    uint64_t bytes = (uint64_t)payloadLength + _config.overheadBytes;
+    uint64_t byteUs = (uint64_t)_config.bitUs * 8 + _config.spacerUs;
+    return 3 * ((uint64_t)_config.spacerUs + _config.bitUs) + bytes * byteUs;
+}
+
+uint32_t Bus::randomUs(uint32_t maxUs) {
+    if (maxUs == 0) {
+        return 0;
+    }
+    return std::uniform_int_distribution<uint32_t>(0, maxUs)(_rng);
+}
+
+uint64_t Bus::backOffUs(uint8_t attempts) const {
+    uint64_t result = attempts;
+    for (uint8_t d = 0; d < _config.backoffDegree; d++) {
+        result *= attempts;
+    }
+    return result;
+}
+
+void Bus::queued(BusNode* node) {
+    if (node->_count == 1) {
+        node->_txReadyUs = _now + randomUs(_config.collisionDelayUs);
+    }
+    _counters.framesQueued++;
+}
+
+uint64_t Bus::nextEventUs() const {
+    uint64_t next = UINT64_MAX;
+    for (const Transmission& tx : _active) {
+        if (tx.endUs < next) {
+            next = tx.endUs;
+        }
+    }
+    for (const BusNode* node : _nodes) {
+        if (node->_count > 0 && node->_txReadyUs < next) {
+            next = node->_txReadyUs;
+        }
+        uint64_t wake = node->nextWakeUs();
+        if (wake < next) {
+            next = wake;
+        }
+    }
+    return next;
+}
+
+bool Bus::carrierSensed(uint64_t nowUs) const {
+    for (const Transmission& tx : _active) {
+        if (tx.startUs + _config.senseUs <= nowUs) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Fn>
+void Bus::forEachReceiver(const Transmission& tx, Fn fn) {
+    for (BusNode* node : _nodes) {
+        if (node != tx.sender && (tx.frame.dst == BROADCAST || tx.frame.dst == node->_id)) {
+            fn(node);
+        }
+    }
+}
+
+void Bus::finishTransmissions(uint64_t nowUs) {
+    for (size_t i = 0; i < _active.size();) {
+        Transmission& tx = _active[i];
+        if (tx.endUs > nowUs) {
+            ++i;
+            continue;
+        }
+
+        // Receivers cannot tell a collision from noise: both fail the CRC
+        uint32_t bytes = (uint32_t)tx.frame.length + _config.overheadBytes;
+        if (tx.collided) {
+            _counters.collisions++;
+            forEachReceiver(tx, [](BusNode* node) { node->_link.crcErrors++; });
+        } else {
+            uint64_t bits = (uint64_t)bytes * 8;
+            bool corrupted = false;
+            if (_config.bitErrorRate > 0.0) {
+                double intact = pow(1.0 - _config.bitErrorRate, (double)bits);
+                corrupted = std::uniform_real_distribution<double>(0.0, 1.0)(_rng) >= intact;
+            }
+            if (corrupted) {
+                _counters.crcErrors++;
+                forEachReceiver(tx, [](BusNode* node) { node->_link.crcErrors++; });
+            } else {
+                _counters.framesDelivered++;
+                forEachReceiver(tx, [&](BusNode* node) {
+                    node->_link.framesReceived++;
+                    node->_link.bytesReceived += bytes;
+                    node->onFrame(tx.frame, tx.endUs);
+                });
+            }
+        }
+
+        _active[i] = _active.back();
+        _active.pop_back();
+    }
+}
+
+void Bus::tryStart(BusNode* node, uint64_t nowUs) {
+    Frame& frame = node->_queue[node->_head];
+    frame.attempts++;
+
+    if (carrierSensed(nowUs)) {
+        _counters.busyBackoffs++;
+        node->_link.retries++;
+        if (frame.attempts >= _config.maxAttempts) {
+            _counters.dropped++;
+            node->_head = (node->_head + 1) % MAX_PACKETS;
+            node->_count--;
+            node->_txReadyUs = node->_count ? nowUs + randomUs(_config.collisionDelayUs) : UINT64_MAX;
+            return;
+        }
+        node->_txReadyUs = nowUs + backOffUs(frame.attempts) + randomUs(_config.collisionDelayUs);
+        return;
+    }
+
+    Transmission tx;
+    tx.sender = node;
+    tx.frame = frame;
+    tx.startUs = nowUs;
+    tx.endUs = nowUs + airTimeUs(frame.length);
+    tx.collided = false;
+
+    // Anyone still active here started inside the sense window: both garbled.
+    for (Transmission& other : _active) {
+        other.collided = true;
+        tx.collided = true;
+    }
+
+    _counters.framesSent++;
+    _counters.bytesOnWire += (uint64_t)frame.length + _config.overheadBytes;
+    node->_link.framesSent++;
+    node->_link.bytesSent += frame.length + _config.overheadBytes;
+    if (tx.startUs >= _busyUntil) {
+        _counters.busyUs += tx.endUs - tx.startUs;
+    } else if (tx.endUs > _busyUntil) {
+        _counters.busyUs += tx.endUs - _busyUntil;
+    }
+    if (tx.endUs > _busyUntil) {
+        _busyUntil = tx.endUs;
+    }
+    _active.push_back(tx);
+    node->onTransmit(frame, nowUs);
+
+    // Half duplex: the next queued frame waits until this one is on the wire.
+    node->_head = (node->_head + 1) % MAX_PACKETS;
+    node->_count--;
+    node->_txReadyUs = node->_count ? tx.endUs + randomUs(_config.collisionDelayUs) : UINT64_MAX;
+}
+
+void Bus::advance(uint64_t nowUs) {
+    _now = nowUs;
+    finishTransmissions(nowUs);
+
+    for (BusNode* node : _nodes) {
+        if (node->nextWakeUs() <= nowUs) {
+            node->poll(nowUs);
+        }
+    }
+    for (BusNode* node : _nodes) {
+        if (node->_count > 0 && node->_txReadyUs <= nowUs) {
+            const Frame& frame = node->_queue[node->_head];
+            uint64_t clearUs = node->clearToSendUs(frame, airTimeUs(frame.length), nowUs);
+            if (clearUs > nowUs) {
+                node->_txReadyUs = clearUs;
+                continue;
+            }
+            tryStart(node, nowUs);
+        }
+    }
+}
+
+} // namespace sim
@@ -0,0 +1,185 @@
+#ifndef SIM_BUS_H
+#define SIM_BUS_H
+
+#include <link_stats.h>
+
+#include <stdint.h>
+#include <random>
+#include <vector>
+
+namespace sim {
+
+// Mirrors PJON defaults so frame sizes behave like on the ESP8266 build.
+static const uint8_t PACKET_MAX_LENGTH = 50; // PJON_PACKET_MAX_LENGTH
+static const uint8_t MAX_PACKETS = 5;        // PJON_MAX_PACKETS (per-node dispatch queue)
+static const uint8_t BROADCAST = 0;          // PJON_BROADCAST
+
+/**
+ * @brief Timing and error model of the shared wire.
+ *
+ * Defaults follow SoftwareBitBang mode 1: 40 us bits, a 112 us spacer per
+ * byte and a three-pulse frame initializer. Frame overhead matches the PJON
+ * configuration used by com-prot (tx info, CRC-32, no packet id).
+ */
+struct BusConfig {
+    uint32_t bitUs = 40;             // SWBB_BIT_WIDTH
+    uint32_t spacerUs = 112;         // SWBB_BIT_SPACER, sent before every byte
+    uint32_t senseUs = 40;           // two starts closer than this do not see each other
+    uint32_t collisionDelayUs = 16;  // SWBB_COLLISION_DELAY, random wait before sensing
+    uint8_t backoffDegree = 4;       // SWBB_BACK_OFF_DEGREE: retry n waits n^(degree+1) us
+    uint8_t maxAttempts = 20;        // SWBB_MAX_ATTEMPTS, then the frame is dropped
+    uint8_t overheadBytes = 9;       // rx id, header, length, CRC8, tx id, CRC-32
+    double bitErrorRate = 0.0;       // independent bit flip probability
+};
+
+struct Frame {
+    uint8_t src;
+    uint8_t dst;
+    uint8_t length;
+    uint8_t payload[PACKET_MAX_LENGTH];
+    uint64_t queuedUs;   // when the sender handed the frame over (an outbox or held heartbeat counts)
+    uint8_t attempts;
+};
+
+struct BusCounters {
+    uint64_t framesQueued = 0;
+    uint64_t framesSent = 0;        // transmissions started
+    uint64_t framesDelivered = 0;   // transmissions that reached the receivers intact
+    uint64_t collisions = 0;        // transmissions destroyed by an overlapping start
+    uint64_t crcErrors = 0;         // transmissions destroyed by noise
+    uint64_t busyBackoffs = 0;      // medium found busy, attempt postponed
+    uint64_t dropped = 0;           // gave up after maxAttempts
+    uint64_t queueFull = 0;         // send() rejected, dispatch queue full
+    uint64_t oversize = 0;          // send() rejected, longer than PACKET_MAX_LENGTH
+    uint64_t bytesOnWire = 0;       // payload + overhead of every started transmission
+    uint64_t busyUs = 0;            // time with at least one transmitter active
+};
+
+class Bus;
+
+/**
+ * @brief One device on the wire with its own PJON-style dispatch queue.
+ */
+class BusNode {
+public:
+    explicit BusNode(uint8_t id) : _id(id) {}
+    virtual ~BusNode() {}
+
+    uint8_t id() const { return _id; }
+
+    /** Frames waiting in the dispatch queue. */
+    uint8_t pending() const { return _count; }
+
+    /** What com-prot counts on this node's end of the wire. */
+    const LinkCounters& link() const { return _link; }
+
+    /**
+     * @brief Queues a frame for transmission.
+     * @return false if the queue is full, the frame is too long or the node is detached.
+     */
+    bool send(uint8_t dst, const uint8_t* payload, uint8_t length);
+
+    /** Same, with the time the frame became ready if that was earlier (an outbox, a held heartbeat). */
+    bool send(uint8_t dst, const uint8_t* payload, uint8_t length, uint64_t readyUs);
+
+    /** Called at the end of an intact transmission addressed to this node or broadcast. */
+    virtual void onFrame(const Frame& frame, uint64_t nowUs) = 0;
+
+    /** Called when one of our frames goes on the wire; frame.attempts counts the tries. */
+    virtual void onTransmit(const Frame& frame, uint64_t nowUs) {
+        (void)frame;
+        (void)nowUs;
+    }
+
+    /**
+     * Earliest time at or after @p nowUs the node lets @p frame (@p airUs on the
+     * wire) start; slotted nodes hold it for their window. Now by default.
+     */
+    virtual uint64_t clearToSendUs(const Frame& frame, uint64_t airUs, uint64_t nowUs) const {
+        (void)frame;
+        (void)airUs;
+        return nowUs;
+    }
+
+    /** Lets the node run its own timers (heartbeats, ...). */
+    virtual void poll(uint64_t nowUs) { (void)nowUs; }
+
+    /** Next time poll() has work to do, UINT64_MAX if none. */
+    virtual uint64_t nextWakeUs() const { return UINT64_MAX; }
+
+protected:
+    /** Air time of a frame on the bus we are attached to. */
+    uint64_t airTimeUs(uint8_t payloadLength) const;
+
+private:
+    friend class Bus;
+
+    uint8_t _id;
+    Bus* _bus = nullptr;
+    Frame _queue[MAX_PACKETS];
+    uint8_t _head = 0;
+    uint8_t _count = 0;
+    uint64_t _txReadyUs = UINT64_MAX;
+    LinkCounters _link;
+};
+
+/**
+ * @brief Event-stepped model of a single-wire multi-drop bus.
+ *
+ * Time only advances to the next interesting instant (end of a
+ * transmission, a node becoming ready to send, a node timer), rounded up to
+ * the configured tick, so long idle stretches cost nothing.
+ */
+class Bus {
+public:
+    Bus(const BusConfig& config, uint32_t seed);
+
+    void attach(BusNode* node);
+
+    /** Air time of a frame carrying @p payloadLength bytes. */
+    uint64_t airTimeUs(uint8_t payloadLength) const;
+
+    /** Earliest pending bus or node event. */
+    uint64_t nextEventUs() const;
+
+    /** Processes everything due at or before @p nowUs. */
+    void advance(uint64_t nowUs);
+
+    uint64_t now() const { return _now; }
+    const BusConfig& config() const { return _config; }
+    const BusCounters& counters() const { return _counters; }
+    std::mt19937& rng() { return _rng; }
+
+private:
+    friend class BusNode;
+
+    struct Transmission {
+        BusNode* sender;
+        Frame frame;
+        uint64_t startUs;
+        uint64_t endUs;
+        bool collided;
+    };
+
+    void queued(BusNode* node);
+    void finishTransmissions(uint64_t nowUs);
+    /** Every node @p frame is for except its sender: broadcast or the addressed one. */
+    template <typename Fn>
+    void forEachReceiver(const Transmission& tx, Fn fn);
+    void tryStart(BusNode* node, uint64_t nowUs);
+    bool carrierSensed(uint64_t nowUs) const;
+    uint64_t backOffUs(uint8_t attempts) const;
+    uint32_t randomUs(uint32_t maxUs);
+
+    BusConfig _config;
+    std::mt19937 _rng;
+    std::vector<BusNode*> _nodes;
+    std::vector<Transmission> _active;
+    BusCounters _counters;
+    uint64_t _now = 0;
+    uint64_t _busyUntil = 0;
+};
+
+} // namespace sim
+
+#endif // SIM_BUS_H
@@ -0,0 +1,114 @@
+/*
+ * Replaces the global operator new/delete to count allocations per owner.
+ *
+ * Every block carries a small header with its size and owner, so a free is
+ * charged back to whoever allocated it even if it happens in another scope
+ * (a vector grown in loop() and released by the simulator, ...).
+ */
+
+#include "sim_heap.h"
+
+#include <stdlib.h>
+#include <cstddef>
+#include <new>
+
+namespace sim {
+namespace {
+
+struct BlockHeader {
+    size_t size;
+    HeapOwner owner;
+};
+
+// Keeps the user block aligned like plain malloc().
+const size_t HEADER_SIZE = (sizeof(BlockHeader) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) *
+                           alignof(std::max_align_t);
+
+HeapCounters g_counters[HEAP_OWNER_COUNT];
+HeapOwner g_owner = HEAP_SIMULATOR;
+
+void* allocate(size_t size) {
+    void* raw = malloc(HEADER_SIZE + (size ? size : 1));
+    if (!raw) {
+        return nullptr;
+    }
+    BlockHeader* header = static_cast<BlockHeader*>(raw);
+    header->size = size;
+    header->owner = g_owner;
+
+    HeapCounters& counters = g_counters[g_owner];
+    counters.allocations++;
+    counters.liveBytes += size;
+    if (counters.liveBytes > counters.peakBytes) {
+        counters.peakBytes = counters.liveBytes;
+    }
+    return static_cast<char*>(raw) + HEADER_SIZE;
+}
+
+void release(void* block) {
+    if (!block) {
+        return;
+    }
+    void* raw = static_cast<char*>(block) - HEADER_SIZE;
+    BlockHeader* header = static_cast<BlockHeader*>(raw);
+    HeapCounters& counters = g_counters[header->owner];
+    counters.frees++;
+    counters.liveBytes -= header->size;
+    free(raw);
+}
+
+} // namespace
+
+const HeapCounters& heapCounters(HeapOwner owner) {
+    return g_counters[owner];
+}
+
+void resetHeapPeak(HeapOwner owner) {
+    g_counters[owner].peakBytes = g_counters[owner].liveBytes;
+}
+
+HeapScope::HeapScope(HeapOwner owner) : _previous(g_owner) {
+    g_owner = owner;
+}
+
+HeapScope::~HeapScope() {
+    g_owner = _previous;
+}
+
+} // namespace sim
+
+void* operator new(size_t size) {
+    void* block = sim::allocate(size);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return sim::allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return sim::allocate(size);
+}
+
+void operator delete(void* block) noexcept {
+    sim::release(block);
+}
+
+void operator delete[](void* block) noexcept {
+    sim::release(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    sim::release(block);
+}
+
+void operator delete[](void* block, size_t) noexcept {
+    sim::release(block);
+}
@@ -0,0 +1,55 @@
+#ifndef SIM_HEAP_H
+#define SIM_HEAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace sim {
+
+/**
+ * @brief Who a heap allocation is charged to.
+ *
+ * Everything not inside a HeapScope is simulator bookkeeping (latency
+ * samples, node vectors, ...) and kept apart from what the sketches would
+ * allocate on the ESP8266.
+ */
+enum HeapOwner {
+    HEAP_SIMULATOR,
+    HEAP_FIRMWARE,   // sketch loop() and command handlers
+    HEAP_SEND_PATH,  // com-prot send calls, must stay at zero allocations
+    HEAP_OWNER_COUNT
+};
+
+struct HeapCounters {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    int64_t liveBytes = 0;    // allocated by this owner and not freed yet
+    int64_t peakBytes = 0;    // high-water mark of liveBytes
+};
+
+/** Counters of @p owner since process start; global operator new/delete feed them. */
+const HeapCounters& heapCounters(HeapOwner owner);
+
+/** Restarts the peak of @p owner at its current live bytes. */
+void resetHeapPeak(HeapOwner owner);
+
+/**
+ * @brief Charges allocations made during its lifetime to @p owner.
+ *
+ * Nests: the innermost scope wins, the previous owner comes back on exit.
+ */
+class HeapScope {
+public:
+    explicit HeapScope(HeapOwner owner);
+    ~HeapScope();
+
+    HeapScope(const HeapScope&) = delete;
+    HeapScope& operator=(const HeapScope&) = delete;
+
+private:
+    HeapOwner _previous;
+};
+
+} // namespace sim
+
+#endif // SIM_HEAP_H
@@ -0,0 +1,257 @@
+#include "sim_nodes.h"
+
+#include <chrono>
+
+#include "sim_heap.h"
+#include "simulation.h"
+
+namespace sim {
+
+void MasterPort::onFrame(const Frame& frame, uint64_t nowUs) {
+    if (Simulation* simulation = Simulation::active()) {
+        simulation->uplinkDelivered(frame, nowUs);
+    }
+    if (_count >= INBOX_SIZE) {
+        _overflows++;
+        return;
+    }
+    uint8_t slot = (_head + _count) % INBOX_SIZE;
+    _inbox[slot] = frame;
+    _receivedUs[slot] = nowUs;
+    _count++;
+}
+
+// TdmaClock runs on 32-bit micros(); its answers are never more than a cycle ahead.
+static uint64_t later(uint64_t nowUs, uint32_t atUs) {
+    return nowUs + (uint32_t)(atUs - (uint32_t)nowUs);
+}
+
+bool MasterPort::queue(uint8_t dst, const uint8_t* payload, uint8_t length) {
+    if (!_tdma) {
+        return send(dst, payload, length);
+    }
+    if (_outboxCount >= OUTBOX_SIZE || length > PACKET_MAX_LENGTH) {
+        return false;
+    }
+    Frame& frame = _outbox[(_outboxHead + _outboxCount) % OUTBOX_SIZE];
+    frame.dst = dst;
+    frame.length = length;
+    memcpy(frame.payload, payload, length);
+    frame.queuedUs = clockUs();
+    _outboxCount++;
+    _outboxWakeUs = 0;
+    return true;
+}
+
+void MasterPort::setTdma(const TdmaLayout& layout) {
+    _tdma = true;
+    _layout = layout;
+    _clock.reset();
+    _nextBeaconUs = 0;
+    _outboxWakeUs = _outboxCount ? 0 : UINT64_MAX;
+}
+
+void MasterPort::poll(uint64_t nowUs) {
+    if (!_tdma || pending()) {
+        return;
+    }
+    if (nowUs < _txEndUs) {
+        // Half duplex: our last frame is still on the wire
+        _outboxWakeUs = _txEndUs;
+        return;
+    }
+    if (nowUs >= _nextBeaconUs) {
+        uint8_t beacon[3 + TDMA_SYNC_LENGTH] = {COM_PROT_COMMAND, 0, STARWIRE_CMD_TDMA_SYNC};
+        uint8_t length = 3 + tdmaEncodeSync(_layout, _cycle, beacon + 3);
+        send(BROADCAST, beacon, length);
+        // Comes back through onTransmit() when it actually starts
+        _nextBeaconUs = UINT64_MAX;
+        return;
+    }
+    _outboxWakeUs = UINT64_MAX;
+    if (!_outboxCount) {
+        return;
+    }
+    const Frame& frame = _outbox[_outboxHead];
+    uint64_t startUs = later(nowUs, _clock.masterStartUs((uint32_t)nowUs, airTimeUs(frame.length)));
+    if (startUs > nowUs) {
+        _outboxWakeUs = startUs;
+        return;
+    }
+    send(frame.dst, frame.payload, frame.length, frame.queuedUs);
+    _outboxHead = (_outboxHead + 1) % OUTBOX_SIZE;
+    _outboxCount--;
+}
+
+void MasterPort::onTransmit(const Frame& frame, uint64_t nowUs) {
+    if (!_tdma) {
+        return;
+    }
+    // Half duplex: the next frame can go once this one is off the wire
+    uint64_t endUs = nowUs + airTimeUs(frame.length);
+    _txEndUs = endUs;
+    if (_outboxCount) {
+        _outboxWakeUs = endUs;
+    }
+    if (frame.length >= 3 && frame.payload[0] == COM_PROT_COMMAND && frame.payload[2] == STARWIRE_CMD_TDMA_SYNC) {
+        _clock.sync((uint32_t)endUs, _layout, _cycle++);
+        _beacons++;
+        _nextBeaconUs = later(nowUs, _clock.nextBeaconUs((uint32_t)(endUs - nowUs)));
+    }
+}
+
+uint64_t MasterPort::clearToSendUs(const Frame& frame, uint64_t airUs, uint64_t nowUs) const {
+    if (!_tdma || !_clock.synced((uint32_t)nowUs) || frame.payload[2] == STARWIRE_CMD_TDMA_SYNC) {
+        return nowUs;
+    }
+    // Only late after a busy medium pushed it out of the window
+    return later(nowUs, _clock.masterStartUs((uint32_t)nowUs, airUs));
+}
+
+uint64_t MasterPort::nextWakeUs() const {
+    if (!_tdma || pending()) {
+        return UINT64_MAX;
+    }
+    return _nextBeaconUs < _outboxWakeUs ? _nextBeaconUs : _outboxWakeUs;
+}
+
+bool MasterPort::pop(Frame& frame, uint64_t& receivedUs) {
+    if (_count == 0) {
+        return false;
+    }
+    frame = _inbox[_head];
+    receivedUs = _receivedUs[_head];
+    _head = (_head + 1) % INBOX_SIZE;
+    _count--;
+    return true;
+}
+
+VirtualSlave::VirtualSlave(uint8_t id, const SlaveFirmware& firmware, uint32_t heartbeatMs, int32_t skewPpm,
+                           uint64_t bootUs, bool fixedHeartbeat)
+    : BusNode(id), _firmware(firmware), _nextHeartbeatUs(bootUs), _skewPpm(skewPpm), _bootUs(bootUs),
+      _fixedHeartbeat(fixedHeartbeat) {
+    // Each slave's millis() runs off its own crystal.
+    _heartbeatUs = (uint64_t)((int64_t)heartbeatMs * 1000 + (int64_t)heartbeatMs * skewPpm / 1000);
+}
+
+uint32_t VirtualSlave::localMs(uint64_t nowUs) const {
+    return (uint32_t)((nowUs - _bootUs) * 1000000 / (1000000 + _skewPpm) / 1000);
+}
+
+uint64_t VirtualSlave::usAt(uint32_t localMs) const {
+    return _bootUs + (uint64_t)localMs * (1000000 + _skewPpm) / 1000;
+}
+
+bool VirtualSlave::slotted(uint64_t nowUs) const {
+    return _tdma.synced((uint32_t)nowUs) && _tdma.layout().hasSlot(id());
+}
+
+void VirtualSlave::sendHeartbeat(uint64_t nowUs) {
+    uint8_t heartbeat[4 + COM_PROT_HEARTBEAT_EXTENSION_MAX] = {COM_PROT_HEARTBEAT, id(), _firmware.type};
+    uint8_t length = 3;
+    uint64_t dueUs = _nextHeartbeatUs;
+    if (_scheduler) {
+        // In slotted mode the next one may wait up to a cycle for our slot
+        uint32_t slotWaitMs = slotted(nowUs) ? (_tdma.layout().cycleUs() + 999) / 1000 : 0;
+        heartbeat[2] |= HEARTBEAT_ANNOUNCED;
+        heartbeat[3] = _scheduler->schedule(localMs(nowUs), slotWaitMs);
+        length = 4;
+        _nextHeartbeatUs = usAt(_scheduler->nextMs());
+    } else {
+        _nextHeartbeatUs += _heartbeatUs;
+    }
+    if (Simulation* simulation = Simulation::active()) {
+        simulation->setCurrentSlave(this);
+        HeapScope scope(HEAP_FIRMWARE);
+        length += _firmware.protocol->heartbeatExtension(heartbeat + length, COM_PROT_HEARTBEAT_EXTENSION_MAX);
+        simulation->setCurrentSlave(nullptr);
+    }
+    send(1, heartbeat, length, dueUs);
+}
+
+void VirtualSlave::poll(uint64_t nowUs) {
+    if (nowUs < _nextHeartbeatUs) {
+        return;
+    }
+    if (!_booted) {
+        // Sketch setup() has run by now, so the schedule (if any) is known
+        _booted = true;
+        const HeartbeatSchedule* schedule = _firmware.protocol->heartbeatSchedule();
+        if (schedule && !_fixedHeartbeat) {
+            _scheduler.reset(new HeartbeatScheduler(id(), *schedule));
+            _scheduler->begin(localMs(nowUs));
+            _nextHeartbeatUs = usAt(_scheduler->nextMs());
+            if (_nextHeartbeatUs > nowUs) {
+                return;
+            }
+        }
+    }
+    // Slotted: hold it for our slot rather than in the queue, so the
+    // telemetry it carries is read when it goes out
+    if (slotted(nowUs)) {
+        uint64_t slotUs = later(nowUs, _tdma.slotStartUs(id(), (uint32_t)nowUs, 0));
+        if (slotUs > nowUs) {
+            _slotWaitUs = slotUs;
+            return;
+        }
+    }
+    _slotWaitUs = 0;
+    sendHeartbeat(nowUs);
+}
+
+uint64_t VirtualSlave::clearToSendUs(const Frame& frame, uint64_t airUs, uint64_t nowUs) const {
+    (void)frame;
+    if (!slotted(nowUs)) {
+        return nowUs;
+    }
+    return later(nowUs, _tdma.slotStartUs(id(), (uint32_t)nowUs, airUs));
+}
+
+void VirtualSlave::onTransmit(const Frame& frame, uint64_t nowUs) {
+    (void)nowUs;
+    if (_scheduler && frame.payload[0] == COM_PROT_HEARTBEAT) {
+        _scheduler->transmitted(frame.attempts);
+    }
+}
+
+void VirtualSlave::heartbeatActivity(uint64_t nowUs) {
+    if (!_scheduler) {
+        return;
+    }
+    _scheduler->activity(localMs(nowUs));
+    if (usAt(_scheduler->nextMs()) < _nextHeartbeatUs) {
+        _nextHeartbeatUs = usAt(_scheduler->nextMs());
+    }
+}
+
+void VirtualSlave::onFrame(const Frame& frame, uint64_t nowUs) {
+    Simulation* simulation = Simulation::active();
+    if (!simulation || frame.length < 3 || frame.payload[0] != COM_PROT_COMMAND) {
+        return;
+    }
+    if (frame.payload[2] == STARWIRE_CMD_TDMA_SYNC && frame.payload[1] == 0) {
+        // The library's: the sketch never sees beacons
+        TdmaLayout layout;
+        uint8_t cycle;
+        if (tdmaParseSync(frame.payload + 3, frame.length - 3, layout, &cycle)) {
+            _tdma.sync((uint32_t)nowUs, layout, cycle);
+        }
+        return;
+    }
+    uint8_t targetType = frame.payload[1];
+    if (targetType != 0 && targetType != _firmware.type) {
+        return;
+    }
+
+    simulation->setCurrentSlave(this);
+    HeapScope scope(HEAP_FIRMWARE);
+    auto start = std::chrono::steady_clock::now();
+    bool handled = _firmware.protocol->deliver(frame.payload, frame.length, frame.src);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    simulation->setCurrentSlave(nullptr);
+
+    simulation->commandDelivered(frame, nowUs, handled,
+                                 std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+} // namespace sim
@@ -0,0 +1,122 @@
+#ifndef SIM_NODES_H
+#define SIM_NODES_H
+
+#include <heartbeat_schedule.h>
+#include <tdma.h>
+
+#include <memory>
+
+#include "sim_bus.h"
+#include "firmware.h"
+
+namespace sim {
+
+/**
+ * @brief Bus endpoint of the host's ComProtMaster.
+ *
+ * Frames are buffered like PJON's receive path and drained by
+ * ComProtMaster::update() from the sketch loop, so master loop delays show
+ * up in the measured heartbeat timing.
+ *
+ * In slotted mode (setTdma()) it also plays the library's TDMA part: it
+ * beacons every cycle and keeps commands in an outbox until the master
+ * window, handing the dispatch queue one frame at a time so a beacon
+ * never waits behind a command.
+ */
+class MasterPort : public BusNode {
+public:
+    explicit MasterPort(uint8_t id) : BusNode(id) {}
+
+    void onFrame(const Frame& frame, uint64_t nowUs) override;
+    void onTransmit(const Frame& frame, uint64_t nowUs) override;
+    uint64_t clearToSendUs(const Frame& frame, uint64_t airUs, uint64_t nowUs) const override;
+    void poll(uint64_t nowUs) override;
+    uint64_t nextWakeUs() const override;
+
+    /** Takes the oldest buffered frame. @return false if empty. */
+    bool pop(Frame& frame, uint64_t& receivedUs);
+
+    /** ComProtMaster's send: straight to the dispatch queue, or the outbox in slotted mode. */
+    bool queue(uint8_t dst, const uint8_t* payload, uint8_t length);
+
+    void setTdma(const TdmaLayout& layout);
+    bool tdma() const { return _tdma; }
+    const TdmaLayout& tdmaLayout() const { return _layout; }
+
+    uint64_t overflows() const { return _overflows; }
+    uint64_t beacons() const { return _beacons; }
+
+private:
+    static const uint8_t INBOX_SIZE = 32;
+    static const uint8_t OUTBOX_SIZE = 32;
+
+    Frame _inbox[INBOX_SIZE];
+    uint64_t _receivedUs[INBOX_SIZE];
+    uint8_t _head = 0;
+    uint8_t _count = 0;
+    uint64_t _overflows = 0;
+
+    bool _tdma = false;
+    TdmaLayout _layout;
+    TdmaClock _clock;
+    uint8_t _cycle = 0;
+    uint64_t _nextBeaconUs = 0;
+    uint64_t _txEndUs = 0;
+    uint64_t _beacons = 0;
+    Frame _outbox[OUTBOX_SIZE];
+    uint8_t _outboxHead = 0;
+    uint8_t _outboxCount = 0;
+    uint64_t _outboxWakeUs = UINT64_MAX;
+};
+
+/**
+ * @brief One powerplant on the bus, running the handlers of its firmware build.
+ *
+ * Heartbeats are generated here (the library does that on the device),
+ * with whatever the firmware's heartbeat extension appends, on the
+ * firmware's HeartbeatSchedule if it set one (unless fixedHeartbeat);
+ * commands go through the firmware's ComProtSlave handler table. Once it
+ * hears a TDMA beacon it also keeps its frames to its slot, as the library
+ * would.
+ */
+class VirtualSlave : public BusNode {
+public:
+    VirtualSlave(uint8_t id, const SlaveFirmware& firmware, uint32_t heartbeatMs, int32_t skewPpm, uint64_t bootUs,
+                 bool fixedHeartbeat);
+
+    void onFrame(const Frame& frame, uint64_t nowUs) override;
+    void onTransmit(const Frame& frame, uint64_t nowUs) override;
+    uint64_t clearToSendUs(const Frame& frame, uint64_t airUs, uint64_t nowUs) const override;
+    void poll(uint64_t nowUs) override;
+    uint64_t nextWakeUs() const override { return _slotWaitUs ? _slotWaitUs : _nextHeartbeatUs; }
+
+    /** The sketch reported activity (ComProtSlave::heartbeatActivity()). */
+    void heartbeatActivity(uint64_t nowUs);
+
+    uint8_t type() const { return _firmware.type; }
+    const SlaveFirmware& firmware() const { return _firmware; }
+
+private:
+    void sendHeartbeat(uint64_t nowUs);
+    /** Heard a beacon lately and owns a slot in it. */
+    bool slotted(uint64_t nowUs) const;
+
+    // The scheduler runs on the slave's own crystal
+    uint32_t localMs(uint64_t nowUs) const;
+    uint64_t usAt(uint32_t localMs) const;
+
+    const SlaveFirmware& _firmware;
+    uint64_t _heartbeatUs;
+    uint64_t _nextHeartbeatUs;      // due
+    uint64_t _slotWaitUs = 0;       // due, held for our slot
+    int32_t _skewPpm;
+    uint64_t _bootUs;
+    bool _fixedHeartbeat;
+    bool _booted = false;
+    std::unique_ptr<HeartbeatScheduler> _scheduler;
+    TdmaClock _tdma;
+};
+
+} // namespace sim
+
+#endif // SIM_NODES_H
@@ -0,0 +1,39 @@
+#include "sim_stats.h"
+
+#include <algorithm>
+
+namespace sim {
+
+void Samples::add(uint64_t value) {
+    _values.push_back(value);
+    _sorted = false;
+    _sum += value;
+    if (value > _max) {
+        _max = value;
+    }
+}
+
+void Samples::clear() {
+    _values.clear();
+    _sorted = true;
+    _sum = 0;
+    _max = 0;
+}
+
+double Samples::mean() const {
+    return _values.empty() ? 0.0 : (double)_sum / _values.size();
+}
+
+uint64_t Samples::percentile(double q) const {
+    if (_values.empty()) {
+        return 0;
+    }
+    if (!_sorted) {
+        std::sort(_values.begin(), _values.end());
+        _sorted = true;
+    }
+    size_t index = (size_t)(q * (_values.size() - 1) + 0.5);
+    return _values[std::min(index, _values.size() - 1)];
+}
+
+} // namespace sim
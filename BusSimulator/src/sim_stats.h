@@ -0,0 +1,34 @@
+#ifndef SIM_STATS_H
+#define SIM_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace sim {
+
+/**
+ * @brief Collects duration samples (microseconds) and reports percentiles.
+ */
+class Samples {
+public:
+    void add(uint64_t value);
+    void clear();
+
+    size_t count() const { return _values.size(); }
+    uint64_t max() const { return _max; }
+    double mean() const;
+
+    /** @p q in [0, 1]; 0 when empty. Sorts lazily. */
+    uint64_t percentile(double q) const;
+
+private:
+    mutable std::vector<uint64_t> _values;
+    mutable bool _sorted = true;
+    uint64_t _sum = 0;
+    uint64_t _max = 0;
+};
+
+} // namespace sim
+
+#endif // SIM_STATS_H
@@ -0,0 +1,352 @@
+#include "simulation.h"
+
+#include <Arduino.h>
+#include <ota.h>
+#include <telemetry.h>
+
+#include "sim_heap.h"
+
+namespace sim {
+
+static uint64_t g_clockUs = 0;
+static Simulation* g_active = nullptr;
+
+uint64_t clockUs() {
+    return g_clockUs;
+}
+
+void bootSketches() {
+    static bool booted = false;
+    if (booted) {
+        return;
+    }
+    booted = true;
+    HeapScope scope(HEAP_FIRMWARE);
+    masterFirmware()->setup();
+    for (const SlaveFirmware& firmware : slaveFirmwares()) {
+        firmware.setup();
+    }
+}
+
+uint16_t currentSlaveId() {
+    VirtualSlave* slave = g_active ? g_active->currentSlave() : nullptr;
+    return slave ? slave->id() : 0;
+}
+
+Simulation::Simulation(const SimConfig& config) : _config(config), _bus(config.bus, config.seed) {
+    std::vector<uint8_t> types = _config.types;
+    if (types.empty()) {
+        for (const SlaveFirmware& firmware : slaveFirmwares()) {
+            types.push_back(firmware.type);
+        }
+    }
+
+    // ID 1 is the master, 0 is broadcast and 255 is PJON_NOT_ASSIGNED.
+    uint16_t count = _config.slaves > 253 ? 253 : _config.slaves;
+    std::uniform_int_distribution<uint32_t> boot(0, _config.bootSpreadMs * 1000);
+
+    for (uint16_t i = 0; i < count && !types.empty(); i++) {
+        const SlaveFirmware* firmware = findSlaveFirmware(types[i % types.size()]);
+        if (!firmware) {
+            continue;
+        }
+        int32_t skewPpm = std::uniform_int_distribution<int32_t>(-(int32_t)_config.clockPpm,
+                                                                  (int32_t)_config.clockPpm)(_bus.rng());
+        _slaves.emplace_back(new VirtualSlave(2 + i, *firmware, _config.heartbeatMs, skewPpm, boot(_bus.rng()),
+                                              _config.fixedHeartbeat));
+        _bus.attach(_slaves.back().get());
+    }
+}
+
+void Simulation::collectCommands() {
+    // Handlers are registered in the sketches' setup(), so this has to run after it.
+    _commands.clear();
+    for (const std::unique_ptr<VirtualSlave>& slave : _slaves) {
+        std::vector<uint8_t> codes;
+        for (int command = 0; command < 256; command++) {
+            if (slave->firmware().protocol->hasHandler(command)) {
+                codes.push_back(command);
+            }
+        }
+        _commands.push_back(codes);
+    }
+}
+
+Simulation::~Simulation() {
+    if (g_active == this) {
+        g_active = nullptr;
+    }
+}
+
+Simulation* Simulation::active() {
+    return g_active;
+}
+
+MasterPort* Simulation::masterPort(uint8_t id) {
+    if (!_masterPort) {
+        _masterPort.reset(new MasterPort(id));
+        _bus.attach(_masterPort.get());
+    }
+    return _masterPort.get();
+}
+
+void Simulation::heartbeatProcessed(uint8_t slaveId, uint64_t nowUs, uint32_t announcedMs) {
+    // Called from inside the sketches; the samples are ours, not theirs.
+    HeapScope scope(HEAP_SIMULATOR);
+    _stats.heartbeatsProcessed++;
+
+    uint64_t last = _lastHeartbeatUs[slaveId];
+    uint32_t window = _announcedMs[slaveId];
+    _lastHeartbeatUs[slaveId] = nowUs;
+    _announcedMs[slaveId] = announcedMs;
+    if (last == 0 || !measuring(last)) {
+        return;
+    }
+
+    uint64_t interval = nowUs - last;
+    if (window) {
+        // Scheduled: jittered on purpose, only gaps past the announced one count
+        _stats.heartbeatsMissed += interval / ((uint64_t)window * 1000);
+        return;
+    }
+    uint64_t nominal = (uint64_t)_config.heartbeatMs * 1000;
+    _stats.heartbeatJitterUs.add(interval > nominal ? interval - nominal : nominal - interval);
+    uint64_t periods = (interval + nominal / 2) / nominal;
+    if (periods > 1) {
+        _stats.heartbeatsMissed += periods - 1;
+    }
+}
+
+void Simulation::commandDelivered(const Frame& frame, uint64_t nowUs, bool handled, uint64_t handlerNs) {
+    HeapScope scope(HEAP_SIMULATOR);
+    if (!handled) {
+        _stats.commandsIgnored++;
+        return;
+    }
+    _stats.commandsHandled++;
+    _stats.handlerNs += handlerNs;
+    if (measuring(frame.queuedUs)) {
+        _stats.commandLatencyUs.add(nowUs - frame.queuedUs);
+        const TdmaLayout* layout = tdmaLayout();
+        if (layout && nowUs - frame.queuedUs > tdmaCommandBoundUs(*layout, _bus.airTimeUs(frame.length), startDelayUs())) {
+            _stats.commandsOverBound++;
+        }
+    }
+}
+
+void Simulation::uplinkDelivered(const Frame& frame, uint64_t nowUs) {
+    HeapScope scope(HEAP_SIMULATOR);
+    if (frame.length >= 2 && frame.payload[0] == COM_PROT_RESPONSE && frame.payload[1] == STARWIRE_CMD_LINK_STATS &&
+        linkStatsParse(frame.payload + 2, frame.length - 2, _linkReports[frame.src])) {
+        _linkReportCount[frame.src]++;
+    }
+    if (!measuring(frame.queuedUs)) {
+        return;
+    }
+    _stats.uplinkLatencyUs.add(nowUs - frame.queuedUs);
+    // No bound for frames longer than a slot (link stats answers), they overrun it
+    const TdmaLayout* layout = tdmaLayout();
+    uint64_t airUs = _bus.airTimeUs(frame.length);
+    if (layout && layout->hasSlot(frame.src) && airUs + layout->guardUs <= layout->slotUs &&
+        nowUs - frame.queuedUs > tdmaSlotBoundUs(*layout, airUs, startDelayUs())) {
+        _stats.uplinkOverBound++;
+    }
+}
+
+const TdmaLayout* Simulation::tdmaLayout() const {
+    return _masterPort && _masterPort->tdma() ? &_masterPort->tdmaLayout() : nullptr;
+}
+
+void Simulation::issueCommand() {
+    if (_slaves.empty()) {
+        return;
+    }
+    size_t index = std::uniform_int_distribution<size_t>(0, _slaves.size() - 1)(_bus.rng());
+    const std::vector<uint8_t>& codes = _commands[index];
+    if (codes.empty()) {
+        return;
+    }
+    uint8_t command = codes[std::uniform_int_distribution<size_t>(0, codes.size() - 1)(_bus.rng())];
+
+    _stats.commandsIssued++;
+    if (!masterFirmware()->protocol->sendCommandToSlaveId(_slaves[index]->id(), command)) {
+        _stats.commandsRejected++;
+    }
+}
+
+void Simulation::requestLinkStats() {
+    if (_slaves.empty()) {
+        return;
+    }
+    // Through the master like the host's STARWIRE_LINK_STATS_INTERVAL_MS, one slave at a time
+    masterFirmware()->protocol->sendCommandToSlaveId(_slaves[_linkStatsNext]->id(), STARWIRE_CMD_LINK_STATS);
+    _linkStatsNext = (_linkStatsNext + 1) % _slaves.size();
+}
+
+void Simulation::setObserver(uint32_t periodMs, std::function<void(uint64_t nowUs)> observer) {
+    _observerUs = (uint64_t)periodMs * 1000;
+    _observer = observer;
+}
+
+void Simulation::runLoops() {
+    HeapScope scope(HEAP_FIRMWARE);
+    masterFirmware()->loop();
+    for (const SlaveFirmware& firmware : slaveFirmwares()) {
+        firmware.loop();
+    }
+}
+
+void Simulation::run() {
+    g_active = this;
+    g_clockUs = 0;
+
+    bootSketches();
+    masterFirmware()->protocol->begin();
+    collectCommands();
+    if (_config.tdma && _masterPort && !_masterPort->tdma()) {
+        TdmaLayout layout;
+        layout.slotCount = (uint8_t)_slaves.size();
+        layout.masterWindowUs = _config.tdmaWindowMs * 1000;
+        _masterPort->setTdma(layout);
+    }
+
+    uint64_t endUs = (uint64_t)_config.seconds * 1000000;
+    uint64_t loopUs = _config.loopUs ? _config.loopUs : 1000;
+    uint64_t commandUs = _config.commandRate > 0 ? (uint64_t)(1000000.0 / _config.commandRate) : 0;
+    uint64_t nextLoopUs = 0;
+    uint64_t nextCommandUs = commandUs ? (uint64_t)_config.warmupMs * 1000 : UINT64_MAX;
+    uint64_t nextObserveUs = _observer && _observerUs ? _observerUs : UINT64_MAX;
+    uint64_t linkStatsUs = _config.linkStatsMs && !_slaves.empty() ? _config.linkStatsMs * 1000ULL / _slaves.size() : 0;
+    uint64_t nextLinkStatsUs = linkStatsUs ? (uint64_t)_config.warmupMs * 1000 : UINT64_MAX;
+    uint64_t tick = _config.tickUs ? _config.tickUs : 1;
+    uint64_t now = 0;
+    bool started = false;
+    _serialBytesAtStart = Serial.bytesWritten() + WebSerial.bytesWritten();
+
+    while (true) {
+        uint64_t next = std::min(std::min(_bus.nextEventUs(), nextLoopUs), std::min(nextCommandUs, nextObserveUs));
+        next = std::min(next, nextLinkStatsUs);
+        next = (next + tick - 1) / tick * tick;
+        if (started && next <= now) {
+            next = now + tick;
+        }
+        started = true;
+        if (next > endUs) {
+            break;
+        }
+        now = next;
+        g_clockUs = now;
+
+        _bus.advance(now);
+        if (now >= nextCommandUs) {
+            issueCommand();
+            nextCommandUs += commandUs;
+        }
+        if (now >= nextLinkStatsUs) {
+            requestLinkStats();
+            nextLinkStatsUs += linkStatsUs;
+        }
+        if (now >= nextLoopUs) {
+            runLoops();
+            nextLoopUs += loopUs;
+        }
+        if (now >= nextObserveUs) {
+            _observer(now);
+            nextObserveUs += _observerUs;
+        }
+    }
+
+    g_clockUs = endUs;
+    _onlineAtEnd = masterFirmware()->protocol->getSlaveCount();
+    _serialBytes = Serial.bytesWritten() + WebSerial.bytesWritten() - _serialBytesAtStart;
+    g_active = nullptr;
+}
+
+void Simulation::report(FILE* out) const {
+    const BusCounters& c = _bus.counters();
+    double seconds = _config.seconds;
+    double measured = seconds - _config.warmupMs / 1000.0;
+    if (measured <= 0) {
+        measured = seconds;
+    }
+
+    fprintf(out, "StarWire bus simulation: %zu slaves, %u s, bit %u us, BER %g, seed %u\n",
+            _slaves.size(), _config.seconds, _config.bus.bitUs, _config.bus.bitErrorRate, _config.seed);
+    fprintf(out, "  bus utilisation      %6.1f %%\n", 100.0 * c.busyUs / (seconds * 1e6));
+    fprintf(out, "  frames sent          %8llu  delivered %llu\n",
+            (unsigned long long)c.framesSent, (unsigned long long)c.framesDelivered);
+    fprintf(out, "  collisions           %8llu  (%.2f %% of sent)\n",
+            (unsigned long long)c.collisions, c.framesSent ? 100.0 * c.collisions / c.framesSent : 0.0);
+    fprintf(out, "  crc errors (noise)   %8llu\n", (unsigned long long)c.crcErrors);
+    fprintf(out, "  busy back-offs       %8llu  dropped %llu, queue full %llu\n",
+            (unsigned long long)c.busyBackoffs, (unsigned long long)c.dropped, (unsigned long long)c.queueFull);
+    fprintf(out, "  bytes on wire        %8llu\n", (unsigned long long)c.bytesOnWire);
+    fprintf(out, "  commands issued      %8llu  rejected %llu\n",
+            (unsigned long long)_stats.commandsIssued, (unsigned long long)_stats.commandsRejected);
+    fprintf(out, "  commands handled     %8llu  (%.1f cmd/s), ignored %llu\n",
+            (unsigned long long)_stats.commandsHandled, _stats.commandsHandled / measured,
+            (unsigned long long)_stats.commandsIgnored);
+    fprintf(out, "  command latency      p50 %.2f ms  p99 %.2f ms  max %.2f ms\n",
+            _stats.commandLatencyUs.percentile(0.50) / 1000.0, _stats.commandLatencyUs.percentile(0.99) / 1000.0,
+            _stats.commandLatencyUs.max() / 1000.0);
+    fprintf(out, "  uplink latency       p50 %.2f ms  p99 %.2f ms  max %.2f ms  (slave frame ready -> master)\n",
+            _stats.uplinkLatencyUs.percentile(0.50) / 1000.0, _stats.uplinkLatencyUs.percentile(0.99) / 1000.0,
+            _stats.uplinkLatencyUs.max() / 1000.0);
+    fprintf(out, "  heartbeat jitter     p50 %.2f ms  p99 %.2f ms  max %.2f ms  (periodic heartbeats)\n",
+            _stats.heartbeatJitterUs.percentile(0.50) / 1000.0, _stats.heartbeatJitterUs.percentile(0.99) / 1000.0,
+            _stats.heartbeatJitterUs.max() / 1000.0);
+    fprintf(out, "  heartbeats missed    %8llu  of %llu processed\n",
+            (unsigned long long)_stats.heartbeatsMissed, (unsigned long long)_stats.heartbeatsProcessed);
+    fprintf(out, "  slave timeouts       %8llu\n", (unsigned long long)_stats.slaveTimeouts);
+    fprintf(out, "  slaves online @ end  %8u / %zu\n", _onlineAtEnd, _slaves.size());
+    if (const TdmaLayout* layout = tdmaLayout()) {
+        // Bounds for the shortest command (no data) and a heartbeat with a telemetry keyframe
+        uint64_t commandAirUs = _bus.airTimeUs(3);
+        uint64_t heartbeatAirUs = _bus.airTimeUs(4 + TelemetryEncoder::MAX_LENGTH);
+        fprintf(out, "  tdma cycle           %8.1f ms  %u slots of %.1f ms, %.0f ms master window, %llu beacons\n",
+                layout->cycleUs() / 1000.0, layout->slotCount, layout->slotUs / 1000.0,
+                layout->masterWindowUs / 1000.0, (unsigned long long)_masterPort->beacons());
+        fprintf(out, "  tdma bounds          command %.1f ms (%u per window), uplink %.1f ms\n",
+                tdmaCommandBoundUs(*layout, commandAirUs, startDelayUs()) / 1000.0,
+                tdmaWindowCapacity(*layout, commandAirUs, _config.bus.collisionDelayUs),
+                tdmaSlotBoundUs(*layout, heartbeatAirUs, startDelayUs()) / 1000.0);
+        fprintf(out, "  over bound           %8llu  commands, %llu uplink frames\n",
+                (unsigned long long)_stats.commandsOverBound, (unsigned long long)_stats.uplinkOverBound);
+    }
+    fprintf(out, "  handler cpu (host)   %8.0f ns/cmd\n",
+            _stats.commandsHandled ? (double)_stats.handlerNs / _stats.commandsHandled : 0.0);
+    fprintf(out, "  debug output         %8lu  bytes (Serial + WebSerial)\n", _serialBytes);
+}
+
+static void printLink(FILE* out, const char* node, const char* type, const LinkCounters& link) {
+    fprintf(out, "%7s %-14s %9lu %10lu %9lu %10lu %6lu %8lu", node, type, (unsigned long)link.framesSent,
+            (unsigned long)link.bytesSent, (unsigned long)link.framesReceived, (unsigned long)link.bytesReceived,
+            (unsigned long)link.crcErrors, (unsigned long)link.retries);
+}
+
+void Simulation::reportLinks(FILE* out) const {
+    fprintf(out, "Link stats per node (com-prot counters at the end of the run)\n");
+    fprintf(out, "%7s %-14s %9s %10s %9s %10s %6s %8s %8s %8s %9s %9s\n", "node", "type", "tx frames", "tx bytes",
+            "rx frames", "rx bytes", "crc", "retries", "reports", "gap ms", "loop p99", "loop max");
+    if (_masterPort) {
+        printLink(out, "master", "-", _masterPort->link());
+        fprintf(out, " %8s %8s %9s %9s\n", "-", "-", "-", "-");
+    }
+    for (const std::unique_ptr<VirtualSlave>& slave : _slaves) {
+        char node[8];
+        snprintf(node, sizeof(node), "%u", slave->id());
+        printLink(out, node, slave->firmware().name, slave->link());
+        uint32_t reports = _linkReportCount[slave->id()];
+        if (!reports) {
+            fprintf(out, " %8u %8s %9s %9s\n", 0u, "-", "-", "-");
+            continue;
+        }
+        const LinkStatsReport& report = _linkReports[slave->id()];
+        fprintf(out, " %8u %8.2f %9.2f %9.2f\n", reports, report.maxUpdateGapUs / 1000.0,
+                linkStatsLoopPercentileUs(report, 0.99f) / 1000.0, report.loopMaxUs / 1000.0);
+    }
+    fprintf(out, "(crc = frames for the node lost to collisions or noise; gap/loop = sketch side, from the\n"
+                 " last STARWIRE_CMD_LINK_STATS response the master received; shared by slaves of one type)\n");
+}
+
+} // namespace sim
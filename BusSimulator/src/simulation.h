@@ -0,0 +1,137 @@
+#ifndef SIM_SIMULATION_H
+#define SIM_SIMULATION_H
+
+#include <stdio.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sim_bus.h"
+#include "sim_nodes.h"
+#include "sim_stats.h"
+
+namespace sim {
+
+struct SimConfig {
+    BusConfig bus;
+    uint16_t slaves = 12;
+    uint32_t seconds = 60;
+    uint32_t tickUs = 10;          // time resolution of the event loop
+    uint32_t heartbeatMs = 1000;   // com-prot heartbeat period
+    uint32_t bootSpreadMs = 20;    // slaves power up within this window
+    uint32_t clockPpm = 50;        // per-slave crystal tolerance, lets heartbeat phases drift apart
+    uint32_t loopUs = 1000;        // how often the sketches' loop() runs
+    double commandRate = 20.0;     // unicast commands per second issued through the master
+    uint32_t warmupMs = 3000;      // excluded from latency and jitter statistics
+    uint32_t seed = 1;
+    bool verbose = false;          // echo sketch Serial output
+    bool fixedHeartbeat = false;   // ignore the sketches' HeartbeatSchedule: every 1 s, no jitter
+    bool tdma = false;             // slotted mode, one slot per simulated slave, unless the sketch set a layout
+    uint32_t tdmaWindowMs = 150;   // master window per cycle in slotted mode
+    uint32_t linkStatsMs = 0;      // ask every slave for STARWIRE_CMD_LINK_STATS once per this, 0 = never
+    std::vector<uint8_t> types;    // slave types to cycle through, empty = every firmware build
+    std::string tracePath;         // recorded A0 trace for --bench adc, empty = synthetic
+};
+
+struct SimStats {
+    Samples commandLatencyUs;      // sendCommandToSlaveId() -> firmware handler
+    Samples heartbeatJitterUs;     // |interval - heartbeatMs| as seen by ComProtMaster::update()
+    Samples uplinkLatencyUs;       // slave frame ready (heartbeat due, response sent) -> end at the master
+    uint64_t messagesSent = 0;     // frames the sketches handed to com-prot
+    uint64_t commandsIssued = 0;
+    uint64_t commandsRejected = 0; // master could not queue the frame
+    uint64_t commandsHandled = 0;
+    uint64_t commandsIgnored = 0;  // reached a slave without a matching handler
+    uint64_t heartbeatsProcessed = 0;
+    uint64_t heartbeatsMissed = 0; // whole periods without a heartbeat reaching the master
+    uint64_t slaveTimeouts = 0;    // slaves ComProtMaster dropped for a late heartbeat
+    uint64_t handlerNs = 0;        // host CPU time spent inside firmware handlers
+    uint64_t commandsOverBound = 0; // slotted mode: later than tdmaCommandBoundUs()
+    uint64_t uplinkOverBound = 0;   // slotted mode: later than tdmaSlotBoundUs()
+};
+
+/** Simulated time in microseconds, drives millis()/micros(). */
+uint64_t clockUs();
+
+/**
+ * @brief Runs every sketch's setup() once per process.
+ *
+ * Sketch globals live for the whole process, so later simulations only
+ * rebind the master to their bus.
+ */
+void bootSketches();
+
+/** Id of the virtual slave being serviced, 0 outside a delivery. Stands in for SLAVE_ID. */
+uint16_t currentSlaveId();
+
+/**
+ * @brief One run: a bus, the master sketch, N virtual slaves and a command load.
+ */
+class Simulation {
+public:
+    explicit Simulation(const SimConfig& config);
+    ~Simulation();
+
+    /** The simulation the shims talk to, nullptr outside run(). */
+    static Simulation* active();
+
+    void run();
+    void report(FILE* out) const;
+    /** Per-node link counters, with what each slave last reported over the bus. */
+    void reportLinks(FILE* out) const;
+
+    /** Calls @p observer every @p periodMs of simulated time while run() goes. */
+    void setObserver(uint32_t periodMs, std::function<void(uint64_t nowUs)> observer);
+
+    Bus& bus() { return _bus; }
+    SimStats& stats() { return _stats; }
+    const SimStats& stats() const { return _stats; }
+    const SimConfig& config() const { return _config; }
+    size_t slaveCount() const { return _slaves.size(); }
+    uint8_t onlineAtEnd() const { return _onlineAtEnd; }
+
+    // --- Hooks used by the shims and nodes ---
+    MasterPort* masterPort(uint8_t id);
+    /** @p announcedMs: longest gap the heartbeat announced, 0 for a plain periodic one. */
+    void heartbeatProcessed(uint8_t slaveId, uint64_t nowUs, uint32_t announcedMs);
+    void commandDelivered(const Frame& frame, uint64_t nowUs, bool handled, uint64_t handlerNs);
+    void uplinkDelivered(const Frame& frame, uint64_t nowUs);
+
+    /** The layout in force, nullptr unless the bus runs slotted. */
+    const TdmaLayout* tdmaLayout() const;
+    /** Random SWBB wait before a start plus our time resolution (beacon and frame), for the TDMA bounds. */
+    uint32_t startDelayUs() const { return _config.bus.collisionDelayUs + 2 * _config.tickUs; }
+
+    VirtualSlave* currentSlave() const { return _current; }
+    void setCurrentSlave(VirtualSlave* slave) { _current = slave; }
+
+private:
+    void collectCommands();
+    void runLoops();
+    void issueCommand();
+    void requestLinkStats();
+    bool measuring(uint64_t nowUs) const { return nowUs >= (uint64_t)_config.warmupMs * 1000; }
+
+    SimConfig _config;
+    Bus _bus;
+    std::unique_ptr<MasterPort> _masterPort;
+    std::vector<std::unique_ptr<VirtualSlave>> _slaves;
+    std::vector<std::vector<uint8_t>> _commands;   // registered handler codes per slave index
+    SimStats _stats;
+    uint64_t _lastHeartbeatUs[256] = {};
+    uint32_t _announcedMs[256] = {};    // from the last heartbeat, 0 = periodic
+    LinkStatsReport _linkReports[256];  // last STARWIRE_CMD_LINK_STATS response per slave
+    uint32_t _linkReportCount[256] = {};
+    size_t _linkStatsNext = 0;          // slave index asked next
+    VirtualSlave* _current = nullptr;
+    uint64_t _observerUs = 0;
+    std::function<void(uint64_t nowUs)> _observer;
+    uint8_t _onlineAtEnd = 0;
+    unsigned long _serialBytesAtStart = 0;
+    unsigned long _serialBytes = 0;
+};
+
+} // namespace sim
+
+#endif // SIM_SIMULATION_H
@@ -0,0 +1,213 @@
+/*
+ * Photovoltaic A0 pipeline on recorded traces: pio test -e native
+ *
+ * Replays every .txt next to this file (one analogRead(A0) per line, 10 ms
+ * apart, '#' comments) through the slave's pipeline (SOLAR_* in
+ * plant_actions.h) and through the raw 50 ms reading it replaced, and
+ * asserts that the pipeline reads A0 no more often, refreshes the LED far
+ * less, hardly flickers and still follows the light.
+ */
+
+#include <unity.h>
+
+#include <adc_filter.h>
+#include <change_tracking.h>
+#include <plant_actions.h>
+
+#include <algorithm>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+const uint32_t TRACE_MS = 10;
+const uint32_t FLICKER_MS = 500; // a change reversing the previous one this soon is visible flicker
+
+static_assert(SOLAR_SAMPLE_MS >= 50, "the pipeline must not read A0 more often than the raw 50 ms reading");
+static_assert(SOLAR_SAMPLE_MS % TRACE_MS == 0, "traces are 10 ms apart");
+
+struct Trace {
+    std::string name;
+    std::vector<uint16_t> readings;
+};
+
+struct Outcome {
+    uint32_t writes = 0;
+    uint32_t flicker = 0;
+    std::vector<int> index; // LUT index shown after each trace reading, -1 before the first
+};
+
+std::string traceDir() {
+    std::string file = __FILE__;
+    size_t slash = file.find_last_of("/\\");
+    return slash == std::string::npos ? "." : file.substr(0, slash);
+}
+
+std::vector<Trace> loadTraces() {
+    std::vector<Trace> traces;
+    std::string dir = traceDir();
+    DIR* handle = opendir(dir.c_str());
+    if (!handle) {
+        return traces;
+    }
+    while (dirent* entry = readdir(handle)) {
+        std::string name = entry->d_name;
+        if (name.size() < 4 || name.compare(name.size() - 4, 4, ".txt") != 0) {
+            continue;
+        }
+        FILE* file = fopen((dir + "/" + name).c_str(), "r");
+        if (!file) {
+            continue;
+        }
+        Trace trace;
+        trace.name = name;
+        char line[64];
+        while (fgets(line, sizeof(line), file)) {
+            if (line[0] == '#' || line[0] == '\n') {
+                continue;
+            }
+            long value = strtol(line, nullptr, 10);
+            trace.readings.push_back((uint16_t)std::min(1024L, std::max(0L, value)));
+        }
+        fclose(file);
+        traces.push_back(trace);
+    }
+    closedir(handle);
+    std::sort(traces.begin(), traces.end(), [](const Trace& a, const Trace& b) { return a.name < b.name; });
+    return traces;
+}
+
+// Runs @p pipeline every sampleMs and records what the LED would show
+template <typename Pipeline>
+Outcome replay(const Trace& trace, uint32_t sampleMs, Pipeline pipeline) {
+    Outcome outcome;
+    int shown = -1;
+    int lastDirection = 0;
+    size_t lastChange = 0;
+    for (size_t i = 0; i < trace.readings.size(); i++) {
+        if (i % (sampleMs / TRACE_MS) == 0) {
+            int next = pipeline(trace.readings[i]);
+            if (next >= 0 && next != shown) {
+                if (shown >= 0) {
+                    int direction = next > shown ? 1 : -1;
+                    if (direction == -lastDirection && (i - lastChange) * TRACE_MS <= FLICKER_MS) {
+                        outcome.flicker++;
+                    }
+                    lastDirection = direction;
+                }
+                outcome.writes++;
+                lastChange = i;
+                shown = next;
+            }
+        }
+        outcome.index.push_back(shown);
+    }
+    return outcome;
+}
+
+Outcome replaySlave(const Trace& trace) {
+    AdcFilter filter(SOLAR_OVERSAMPLE_SHIFT, SOLAR_EMA_SHIFT);
+    AnalogHysteresis light(SOLAR_HYSTERESIS);
+    return replay(trace, SOLAR_SAMPLE_MS, [&](uint16_t reading) {
+        if (!filter.add(reading)) {
+            return -1;
+        }
+        light.update(filter.value());
+        return (int)(light.value() >> SOLAR_LUT_SHIFT);
+    });
+}
+
+Outcome replayRaw(const Trace& trace) {
+    return replay(trace, 50, [](uint16_t reading) { return (int)(reading >> SOLAR_LUT_SHIFT); });
+}
+
+// Median of the last second of readings: the light without noise and spikes
+std::vector<int> referenceIndex(const Trace& trace) {
+    const size_t window = 1000 / TRACE_MS;
+    std::vector<int> reference;
+    std::vector<uint16_t> recent;
+    for (size_t i = 0; i < trace.readings.size(); i++) {
+        size_t start = i + 1 >= window ? i + 1 - window : 0;
+        recent.assign(trace.readings.begin() + start, trace.readings.begin() + i + 1);
+        std::nth_element(recent.begin(), recent.begin() + recent.size() / 2, recent.end());
+        reference.push_back(recent[recent.size() / 2] >> SOLAR_LUT_SHIFT);
+    }
+    return reference;
+}
+
+const std::vector<Trace>& traces() {
+    static std::vector<Trace> loaded = loadTraces();
+    return loaded;
+}
+
+double minutes(const Trace& trace) {
+    return trace.readings.size() * TRACE_MS / 60000.0;
+}
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_traces_present() {
+    TEST_ASSERT_TRUE_MESSAGE(!traces().empty(), "no A0 trace (*.txt) next to the test");
+    for (const Trace& trace : traces()) {
+        TEST_ASSERT_TRUE_MESSAGE(trace.readings.size() * TRACE_MS >= 60000, trace.name.c_str());
+    }
+}
+
+// At least five times fewer LED refreshes than the raw reading
+void test_fewer_led_writes() {
+    for (const Trace& trace : traces()) {
+        Outcome slave = replaySlave(trace);
+        Outcome raw = replayRaw(trace);
+        TEST_ASSERT_TRUE_MESSAGE(slave.writes > 0, trace.name.c_str());
+        TEST_ASSERT_TRUE_MESSAGE(slave.writes * 5 <= raw.writes, trace.name.c_str());
+    }
+}
+
+// Noise no longer shows as back-and-forth steps
+void test_no_visible_flicker() {
+    for (const Trace& trace : traces()) {
+        Outcome slave = replaySlave(trace);
+        TEST_ASSERT_TRUE_MESSAGE(slave.flicker / minutes(trace) <= 5.0, trace.name.c_str());
+    }
+}
+
+// The smoothing still follows the light: off by at most one LUT step on
+// average, and never more than two for longer than a second
+void test_follows_the_light() {
+    for (const Trace& trace : traces()) {
+        Outcome slave = replaySlave(trace);
+        std::vector<int> reference = referenceIndex(trace);
+        double errorSum = 0;
+        size_t counted = 0;
+        size_t farRun = 0;
+        size_t longestFarRun = 0;
+        for (size_t i = 0; i < reference.size(); i++) {
+            if (slave.index[i] < 0) {
+                continue;
+            }
+            int error = abs(slave.index[i] - reference[i]);
+            errorSum += error;
+            counted++;
+            farRun = error > 2 ? farRun + 1 : 0;
+            longestFarRun = std::max(longestFarRun, farRun);
+        }
+        TEST_ASSERT_TRUE_MESSAGE(counted > 0, trace.name.c_str());
+        TEST_ASSERT_TRUE_MESSAGE(errorSum / counted <= 1.0, trace.name.c_str());
+        TEST_ASSERT_TRUE_MESSAGE(longestFarRun * TRACE_MS <= 1000, trace.name.c_str());
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_traces_present);
+    RUN_TEST(test_fewer_led_writes);
+    RUN_TEST(test_no_visible_flicker);
+    RUN_TEST(test_follows_the_light);
+    return UNITY_END();
+}
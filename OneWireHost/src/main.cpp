@@ -1,25 +1,180 @@
 #include <Arduino.h>
 #include <com-prot.h>
 #include <ota.h>
+#include <scene_frame.h>
+#include <fleet_state.h>
+#include <slave_registry.h>
+#include <telemetry.h>
+#include <heartbeat_schedule.h>
+#include <tdma.h>
+#include <link_stats.h>
 #include "secrets.h"
 
 // Create master instance
 ComProtMaster master(1, D1); // Master ID 1, pin D1
 
+// Online slaves, fed from the heartbeats the debug handler sees. Unlike
+// getConnectedSlaves()/getSlavesByType() it answers without building a
+// std::vector, so the loop does not allocate to ask who is online.
+// Slaves that announce their heartbeat interval get twice that instead.
+const uint32_t SLAVE_TIMEOUT_MS = 2000; // same as the com-prot heartbeat timeout
+SlaveRegistry slaves(SLAVE_TIMEOUT_MS);
+
+// Measured output and applied command of every slave, from the bytes the
+// slaves append to their heartbeats (or send as STARWIRE_CMD_TELEMETRY)
+TelemetryTable telemetry;
+
+// Desired cmd4 of every slave, resent periodically so rebooted slaves catch up
+FleetState fleet;
+const unsigned long FLEET_SYNC_INTERVAL = 10000;
+
+// Link health (link_stats.h), off by default: build with
+// -DSTARWIRE_LINK_STATS_INTERVAL_MS=N to ask the next online slave for its
+// STARWIRE_CMD_LINK_STATS every N ms, one at a time so the answers never
+// collide. Answers are printed whenever they arrive.
+
+// Time-slotted bus (see tdma.h), off by default. Build with
+// -DSTARWIRE_TDMA_SLOTS=N for one slot per slave id 2 .. N+1: no collisions
+// and a fixed worst-case latency per plant, at the price of commands waiting
+// for the master window. The beacon and the slots are kept by com-prot
+// (COM_PROT_TDMA), which so far only the BusSimulator shim does; the pinned
+// com-prot refuses the build rather than silently running carrier sense.
+#if defined(STARWIRE_TDMA_SLOTS) && !defined(COM_PROT_TDMA)
+#error "STARWIRE_TDMA_SLOTS needs a com-prot with COM_PROT_TDMA (only the BusSimulator shim has it)"
+#endif
+#ifndef STARWIRE_TDMA_WINDOW_MS
+#define STARWIRE_TDMA_WINDOW_MS 150 // up to 255
+#endif
+
+// Grid used by the demo below, cmd4 per powerplant type (index = type)
+const uint8_t gridCommands[9] = {
+    0x00,
+    0x03, // Photovoltaic: idle
+    0x01, // Wind: ON
+    0x01, // Nuclear: ON
+    0x0A, // Gas: level 5
+    0x01, // Hydro: ON
+    0x0D, // Hydro storage: 50%
+    0x01, // Coal: ON
+    0x03, // Battery: idle
+};
+
+#ifdef COM_PROT_LINK_STATS
+bool countSent(bool sent, uint8_t) {
+    return sent;
+}
+#else
+// com-prot keeps no link counters: count the commands this sketch sends
+// and the frames its debug handler sees. CRC errors and retries stay 0.
+LinkCounters sketchLink;
+
+bool countSent(bool sent, uint8_t dataLen) {
+    if (sent) {
+        linkCountSent(sketchLink, 3 + dataLen); // [COM_PROT_COMMAND, type, command, data]
+    }
+    return sent;
+}
+#endif
+
+// Sends a scene to every slave in one broadcast frame
+bool sendScene(const SceneBuilder& scene) {
+    uint8_t data[STARWIRE_MAX_COMMAND_DATA];
+    uint8_t length = scene.encode(data);
+    return countSent(master.sendCommandToSlaveId(STARWIRE_BROADCAST_ID, STARWIRE_CMD_SCENE, data, length), length);
+}
+
+// Broadcasts the whole fleet state; the bus cost depends on the id range,
+// not on how many slaves are online. Slaves only act on changed nibbles.
+bool sendFleetSync() {
+    uint8_t data[STARWIRE_MAX_COMMAND_DATA];
+    bool sent = true;
+    for (uint8_t i = 0; i < fleet.frameCount(); i++) {
+        uint8_t length = fleet.encodeFrame(i, data);
+        sent &= countSent(master.sendCommandToSlaveId(STARWIRE_BROADCAST_ID, STARWIRE_CMD_FLEET_SYNC, data, length), length);
+    }
+    return sent;
+}
+
+// Sends to every online slave of a type. com-prot only broadcasts to types
+// in its own registry, which drops a slave 2 s after its last heartbeat;
+// slaves on a HeartbeatSchedule may idle at 4 s and announce it. When
+// com-prot refuses, unicast to the slaves this registry, which honours the
+// announced intervals, still holds.
+bool sendCommandToType(uint8_t slaveType, uint8_t command, const uint8_t* data = nullptr, uint8_t dataLen = 0) {
+    if (countSent(master.sendCommandToSlaveType(slaveType, command, data, dataLen), dataLen)) {
+        return true;
+    }
+    bool sent = false;
+    slaves.forEachSlave(slaveType, [&](uint8_t id, uint8_t) {
+        sent |= countSent(master.sendCommandToSlaveId(id, command, data, dataLen), dataLen);
+    });
+    return sent;
+}
+
+void onSlaveTimedOut(uint8_t slaveId, uint8_t) {
+    telemetry.forget(slaveId);
+}
+
+#ifdef STARWIRE_LINK_STATS_INTERVAL_MS
+// Asks the online slave after the last one asked for its link stats
+void requestLinkStats() {
+    static uint8_t linkStatsSlave = 0;
+    for (uint16_t step = 1; step < 256; step++) {
+        uint8_t id = linkStatsSlave + step;
+        if (slaves.isOnline(id)) {
+            linkStatsSlave = id;
+            countSent(master.sendCommandToSlaveId(id, STARWIRE_CMD_LINK_STATS), 0);
+            return;
+        }
+    }
+}
+#endif
+
+void printLinkStats(uint8_t slaveId, const uint8_t* data, uint16_t length) {
+    LinkStatsReport report;
+    if (!linkStatsParse(data, length, report)) {
+        return;
+    }
+    WebSerial.printf("Link %d: tx %lu (%lu B), rx %lu (%lu B), crc %lu, retries %lu, update gap %lu us, "
+                     "loop p99 %lu us max %lu us\n",
+                     slaveId, (unsigned long)report.link.framesSent, (unsigned long)report.link.bytesSent,
+                     (unsigned long)report.link.framesReceived, (unsigned long)report.link.bytesReceived,
+                     (unsigned long)report.link.crcErrors, (unsigned long)report.link.retries,
+                     (unsigned long)report.maxUpdateGapUs, (unsigned long)linkStatsLoopPercentileUs(report, 0.99f),
+                     (unsigned long)report.loopMaxUs);
+}
+
 // Debug receive handler - called for every received message
 void debugReceiveHandler(uint8_t* payload, uint16_t length, uint8_t senderId, uint8_t messageType) {
+#ifndef COM_PROT_LINK_STATS
+    linkCountReceived(sketchLink, length);
+#endif
+    bool telemetryResponse = messageType == STARWIRE_MSG_RESPONSE && length >= 2 && payload[1] == STARWIRE_CMD_TELEMETRY;
+    if (telemetryResponse) {
+        telemetry.update(senderId, payload + 2, length - 2);
+    }
+    bool linkStatsResponse = messageType == STARWIRE_MSG_RESPONSE && length >= 2 && payload[1] == STARWIRE_CMD_LINK_STATS;
+    if (linkStatsResponse) {
+        printLinkStats(senderId, payload + 2, length - 2);
+    }
+
     // Only log non-heartbeat messages to avoid spam
-    if (messageType != 0x03) { // Skip heartbeat messages
+    if (messageType != STARWIRE_MSG_HEARTBEAT && !telemetryResponse && !linkStatsResponse) { // Skip heartbeat, telemetry and stats
         Serial.printf("[DEBUG] RX from slave %d: type=0x%02X, len=%d\n", senderId, messageType, length);
         WebSerial.printf("[DEBUG] RX: ID=%d, Type=0x%02X, Len=%d\n", senderId, messageType, length);
         WebSerial.flush();
     }
     
     // Log heartbeat messages with less detail
-    if (messageType == 0x03) {
+    if (messageType == STARWIRE_MSG_HEARTBEAT) {
+        HeartbeatFrame heartbeat;
+        if (parseHeartbeat(payload, length, heartbeat)) {
+            slaves.heartbeat(heartbeat.slaveId, heartbeat.slaveType, millis(), heartbeatTimeoutMs(heartbeat.intervalMs));
+            telemetry.update(heartbeat.slaveId, heartbeat.extension, heartbeat.extensionLength);
+        }
         static unsigned long lastHeartbeatLog = 0;
         if (millis() - lastHeartbeatLog > 5000) { // Log every 5 seconds
-            Serial.printf("[DEBUG] Heartbeats active from %d slaves\n", master.getSlaveCount());
+            Serial.printf("[DEBUG] Heartbeats active from %d slaves\n", slaves.count());
             lastHeartbeatLog = millis();
         }
     }
@@ -41,6 +196,14 @@ void setup() {
     // Set debug receive handler
     master.setDebugReceiveHandler(debugReceiveHandler);
     
+#ifdef STARWIRE_TDMA_SLOTS
+    TdmaLayout tdma;
+    tdma.slotCount = STARWIRE_TDMA_SLOTS;
+    tdma.masterWindowUs = STARWIRE_TDMA_WINDOW_MS * 1000UL;
+    master.setTdma(tdma);
+    Serial.printf("TDMA: %u slots, cycle %lu us\n", tdma.slotCount, (unsigned long)tdma.cycleUs());
+#endif
+
     // Initialize the master
     master.begin();
     
@@ -55,56 +218,100 @@ void loop() {
     
     // Update master (handles incoming messages and timeouts)
     master.update();
+    slaves.expire(millis(), onSlaveTimedOut);
     
     // Example: Send commands to slaves every 10 seconds
     static unsigned long lastCommand = 0;
     if (millis() - lastCommand > 5000) {
         
-        // Get all connected slaves
-        auto allSlaves = master.getConnectedSlaves();
-        WebSerial.printf("Connected slaves: %d\n", allSlaves.size());
+        // List connected slaves straight from the registry
+        WebSerial.printf("Connected slaves: %d\n", slaves.count());
+#ifdef COM_PROT_LINK_STATS
+        const LinkCounters& link = master.linkCounters();
+#else
+        const LinkCounters& link = sketchLink;
+#endif
+        WebSerial.printf("Master link: tx %lu (%lu B), rx %lu (%lu B), crc %lu, retries %lu\n",
+                         (unsigned long)link.framesSent, (unsigned long)link.bytesSent,
+                         (unsigned long)link.framesReceived, (unsigned long)link.bytesReceived,
+                         (unsigned long)link.crcErrors, (unsigned long)link.retries);
         
-        for (const auto& slave : allSlaves) {
-            WebSerial.printf("Slave ID: %d, Type: %d\n", slave.id, slave.type);
+        for (SlaveRegistry::Slave slave : slaves.slaves()) {
+            if (telemetry.valid(slave.id)) {
+                WebSerial.printf("Slave ID: %d, Type: %d, Output: %d, Cmd: 0x%X\n", slave.id, slave.type,
+                                 telemetry.output(slave.id), telemetry.status(slave.id));
+            } else {
+                WebSerial.printf("Slave ID: %d, Type: %d\n", slave.id, slave.type);
+            }
         }
         
         // Example commands:
         
         // 1. Send LED toggle command (0x10) to all slaves of type 1 using broadcast
-        if (master.getSlavesByType(1).size() > 0) {
+        if (slaves.hasSlaveOfType(1)) {
             uint8_t ledState = (millis() / 10000) % 2; // Toggle every 5 seconds
-            master.sendCommandToSlaveType(1, 0x10, &ledState, 1);
+            sendCommandToType(1, 0x10, &ledState, 1);
             WebSerial.printf("Sent LED broadcast command (%d) to type 1 slaves\n", ledState);
         }
-        if( master.getSlavesByType(7).size() > 0) {
+        if (slaves.hasSlaveOfType(7)) {
             // 1. Send LED toggle command (0x10) to all slaves of type 7 using broadcast
             uint8_t ledState = (millis() / 10000) % 2; // Toggle every 5 seconds
-            master.sendCommandToSlaveType(7, 0x10, &ledState, 1);
+            sendCommandToType(7, 0x10, &ledState, 1);
             WebSerial.printf("Sent LED broadcast command (%d) to type 7 slaves\n", ledState);
         }
 
 
         
         // 2. Send temperature request (0x20) to all slaves of type 2 using broadcast
-        if (master.getSlavesByType(2).size() > 0) {
-            master.sendCommandToSlaveType(2, 0x20);
+        if (slaves.hasSlaveOfType(2)) {
+            sendCommandToType(2, 0x20);
 
             WebSerial.println("Sent temperature request broadcast to type 2 slaves");
         }
+
+        // 3. Refresh the whole grid in a single frame instead of one per plant
+        SceneBuilder scene;
+        for (uint8_t type = 1; type <= 8; type++) {
+            scene.setType(type, gridCommands[type]);
+        }
+        if (sendScene(scene)) {
+            WebSerial.printf("Sent grid scene (%d bytes)\n", scene.length());
+        }
+        for (uint8_t type = 1; type <= 8; type++) {
+            slaves.forEachSlave(type, [type](uint8_t id, uint8_t) {
+                fleet.set(id, gridCommands[type]);
+            });
+        }
         
         lastCommand = millis();
     }
+
+    // 4. Idempotent resync of every slave at a fixed bus cost
+    static unsigned long lastFleetSync = 0;
+    if (millis() - lastFleetSync > FLEET_SYNC_INTERVAL && !fleet.empty()) {
+        if (sendFleetSync()) {
+            WebSerial.printf("Sent fleet sync (%d frames)\n", fleet.frameCount());
+        }
+        lastFleetSync = millis();
+    }
+#ifdef STARWIRE_LINK_STATS_INTERVAL_MS
+    // 5. One slave's link stats at a time
+    static unsigned long lastLinkStats = 0;
+    if (millis() - lastLinkStats > STARWIRE_LINK_STATS_INTERVAL_MS) {
+        requestLinkStats();
+        lastLinkStats = millis();
+    }
+#endif
     /*
     // Print slave list every second
     static unsigned long lastListPrint = 0;
     if (millis() - lastListPrint > 1000) {
-        auto slaves = master.getConnectedSlaves();
-        //WebSerial.printf("Active slaves (%d): ", slaves.size());
+        //WebSerial.printf("Active slaves (%d): ", slaves.count());
         
-        if (slaves.empty()) {
+        if (slaves.count() == 0) {
             //WebSerial.println("None");
         } else {
-            for (const auto& slave : slaves) {
+            for (SlaveRegistry::Slave slave : slaves.slaves()) {
                 WebSerial.printf("ID: %d, Type: %d ", slave.id, slave.type);
             }
             WebSerial.println();
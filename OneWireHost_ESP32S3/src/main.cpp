@@ -1,23 +1,225 @@
 #include <Arduino.h>
 #include <com-prot.h>
+#include <latency_histogram.h>
+#include <slave_registry.h>
+#include <spsc_queue.h>
+#include <telemetry.h>
+#include <heartbeat_schedule.h>
+
+/*
+ * Dual-core master.
+ *
+ *   core 0  "starwire" task: master.update(), sending, bus timing. Nothing
+ *           else runs here, so a slow Serial print or (later) the web
+ *           telemetry on the other core cannot delay the bus.
+ *   core 1  Arduino loop(): slave bookkeeping, command scheduling, logging.
+ *
+ * SWBB has no receive buffer: a frame that starts while nobody is inside
+ * master.update() is lost, not delayed. The bus task blocks on an edge
+ * interrupt of the bus pin, so it is back in master.update() a context
+ * switch after a frame starts, and wakes every millisecond to send.
+ *
+ * The cores only talk through two lock-free SPSC rings: bus events
+ * (heartbeats, other frames) from core 0 to core 1, and commands to send
+ * from core 1 to core 0. ComProtMaster is only ever touched by core 0.
+ */
 
 // Create master instance
 // Using GPIO 19 for OneWire communication on ESP32-S3
-ComProtMaster master(1, 19); // Master ID 1, pin GPIO 19
+const uint8_t BUS_PIN = 19;
+ComProtMaster master(1, BUS_PIN); // Master ID 1, pin GPIO 19
+
+const BaseType_t BUS_CORE = 0;
+const UBaseType_t BUS_PRIORITY = 10;          // above loop() (1), below the WiFi/lwIP tasks (18+) on core 0
+const TickType_t BUS_IDLE_TICKS = pdMS_TO_TICKS(1); // wake without line activity, for sending and timeouts
+const uint32_t SLAVE_TIMEOUT_MS = 2000;         // same as the com-prot heartbeat timeout
+const unsigned long LATENCY_REPORT_INTERVAL = 30000;
+
+// Frame seen by the bus task, handed to core 1
+struct BusEvent {
+    uint8_t senderId;
+    uint8_t messageType;
+    uint8_t arg1;       // heartbeat: slave id
+    uint8_t arg2;       // heartbeat: slave type
+    uint16_t intervalMs; // heartbeat: announced interval, HEARTBEAT_DEFAULT_MS if none
+    uint16_t length;
+    uint32_t receivedUs; // when master.update() handed it to the debug handler
+    uint8_t telemetryLength; // telemetry bytes from a heartbeat or telemetry response
+    uint8_t telemetry[TelemetryEncoder::MAX_LENGTH];
+};
+
+// Command queued by core 1 for the bus task
+struct BusCommand {
+    bool toType;        // true: sendCommandToSlaveType, false: sendCommandToSlaveId
+    uint8_t target;     // slave type or slave id
+    uint8_t command;
+    uint8_t dataLen;
+    uint8_t data[8];
+    uint32_t typeIds[8]; // toType: the type's slaves in core 1's registry, one bit per id
+};
+
+SpscQueue<BusEvent, 64> busEvents;      // core 0 -> core 1
+SpscQueue<BusCommand, 16> busCommands;  // core 1 -> core 0
+
+// Core 1 state
+SlaveRegistry slaves(SLAVE_TIMEOUT_MS);
+LatencyHistogram heartbeatLatency;      // bus task handler -> processed on core 1
+TelemetryTable telemetry;               // measured output + applied command per slave
+
+// Written by the bus task, copied out by core 1 under busStatsLock. Up to
+// BUS_IDLE_TICKS is the task waiting for the line; anything longer means it
+// was held up and frames starting meanwhile were missed.
+LatencyHistogram busPollInterval;
+portMUX_TYPE busStatsLock = portMUX_INITIALIZER_UNLOCKED;
+TaskHandle_t busTaskHandle = nullptr;
 
-// Debug receive handler - called for every received message
+// Written by the bus task, read by core 1
+volatile uint32_t busMaxLoopUs = 0;
+
+// Debug receive handler - runs on core 0 inside master.update(), only queues
 void debugReceiveHandler(uint8_t* payload, uint16_t length, uint8_t senderId, uint8_t messageType) {
-    // Only log non-heartbeat messages to avoid spam
-    if (messageType != 0x03) { // Skip heartbeat messages
-        Serial.printf("[DEBUG] RX from slave %d: type=0x%02X, len=%d\n", senderId, messageType, length);
+    BusEvent event;
+    event.senderId = senderId;
+    event.messageType = messageType;
+    event.arg1 = length > 1 ? payload[1] : 0;
+    event.arg2 = length > 2 ? payload[2] : 0;
+    event.intervalMs = HEARTBEAT_DEFAULT_MS;
+    event.length = length;
+    event.receivedUs = micros();
+    // Telemetry follows the heartbeat header or [0x05, STARWIRE_CMD_TELEMETRY]
+    const uint8_t* telemetryData = nullptr;
+    uint16_t telemetryLength = 0;
+    HeartbeatFrame heartbeat;
+    if (messageType == STARWIRE_MSG_HEARTBEAT && parseHeartbeat(payload, length, heartbeat)) {
+        event.arg2 = heartbeat.slaveType;
+        event.intervalMs = heartbeat.intervalMs;
+        telemetryData = heartbeat.extension;
+        telemetryLength = heartbeat.extensionLength;
+    } else if (messageType == STARWIRE_MSG_RESPONSE && length > 2 && payload[1] == STARWIRE_CMD_TELEMETRY) {
+        telemetryData = payload + 2;
+        telemetryLength = length - 2;
     }
-    
-    // Log heartbeat messages with less detail
-    if (messageType == 0x03) {
-        static unsigned long lastHeartbeatLog = 0;
-        if (millis() - lastHeartbeatLog > 5000) { // Log every 5 seconds
-            Serial.printf("[DEBUG] Heartbeats active from %d slaves\n", master.getSlaveCount());
-            lastHeartbeatLog = millis();
+    event.telemetryLength = telemetryLength > sizeof(event.telemetry) ? sizeof(event.telemetry) : telemetryLength;
+    if (event.telemetryLength) {
+        memcpy(event.telemetry, telemetryData, event.telemetryLength);
+    }
+    busEvents.push(event);
+}
+
+// First edge on the bus pin while the bus task is blocked: wake it
+void IRAM_ATTR busLineEdge() {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(busTaskHandle, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// com-prot only broadcasts to types in its own registry, which drops a
+// slave 2 s after its last heartbeat; slaves on a HeartbeatSchedule may idle
+// at 4 s and announce it. When com-prot refuses, unicast to the slaves core
+// 1's registry, which honours the announced intervals, held at queue time.
+void sendCommandToType(const BusCommand& command, const uint8_t* data) {
+    if (master.sendCommandToSlaveType(command.target, command.command, data, command.dataLen)) {
+        return;
+    }
+    for (uint16_t id = 1; id < 256; id++) {
+        if (command.typeIds[id >> 5] & (1UL << (id & 31))) {
+            master.sendCommandToSlaveId(id, command.command, data, command.dataLen);
+        }
+    }
+}
+
+// Bus task pinned to core 0. Between passes it blocks until the bus pin
+// moves or BUS_IDLE_TICKS pass; the edge interrupt is only armed while it
+// waits, so it never cuts into the bit-banged reception.
+void busTask(void*) {
+    busTaskHandle = xTaskGetCurrentTaskHandle();
+    uint32_t lastPollUs = micros();
+    for (;;) {
+        attachInterrupt(digitalPinToInterrupt(BUS_PIN), busLineEdge, CHANGE);
+        ulTaskNotifyTake(pdTRUE, BUS_IDLE_TICKS);
+        detachInterrupt(digitalPinToInterrupt(BUS_PIN));
+
+        uint32_t startUs = micros();
+        portENTER_CRITICAL(&busStatsLock);
+        busPollInterval.add(startUs - lastPollUs);
+        portEXIT_CRITICAL(&busStatsLock);
+        lastPollUs = startUs;
+
+        master.update();
+
+        BusCommand command;
+        while (busCommands.pop(command)) {
+            const uint8_t* data = command.dataLen ? command.data : nullptr;
+            if (command.toType) {
+                sendCommandToType(command, data);
+            } else {
+                master.sendCommandToSlaveId(command.target, command.command, data, command.dataLen);
+            }
+        }
+
+        uint32_t busyUs = micros() - startUs;
+        if (busyUs > busMaxLoopUs) {
+            busMaxLoopUs = busyUs;
+        }
+    }
+}
+
+// Queues a command for the bus task; false if the ring is full
+bool queueCommand(bool toType, uint8_t target, uint8_t command, const uint8_t* data = nullptr, uint8_t dataLen = 0) {
+    BusCommand queued;
+    if (dataLen > sizeof(queued.data)) {
+        return false;
+    }
+    queued.toType = toType;
+    queued.target = target;
+    queued.command = command;
+    queued.dataLen = dataLen;
+    if (dataLen) {
+        memcpy(queued.data, data, dataLen);
+    }
+    memset(queued.typeIds, 0, sizeof(queued.typeIds));
+    if (toType) {
+        slaves.forEachSlave(target, [&queued](uint8_t id, uint8_t) { queued.typeIds[id >> 5] |= 1UL << (id & 31); });
+    }
+    if (!busCommands.push(queued)) {
+        return false;
+    }
+    if (busTaskHandle) {
+        xTaskNotifyGive(busTaskHandle); // send now rather than at the next idle wake
+    }
+    return true;
+}
+
+// Core 1: consume what the bus task saw
+void processBusEvents() {
+    BusEvent event;
+    while (busEvents.pop(event)) {
+        if (event.messageType == STARWIRE_MSG_HEARTBEAT) {
+            if (event.length >= 3) {
+                slaves.heartbeat(event.arg1, event.arg2, millis(), heartbeatTimeoutMs(event.intervalMs));
+                telemetry.update(event.arg1, event.telemetry, event.telemetryLength);
+            }
+            heartbeatLatency.add(micros() - event.receivedUs);
+        } else if (event.telemetryLength) {
+            telemetry.update(event.senderId, event.telemetry, event.telemetryLength);
+        } else {
+            Serial.printf("[DEBUG] RX from slave %d: type=0x%02X, len=%d\n", event.senderId, event.messageType, event.length);
+        }
+    }
+    slaves.expire(millis(), [](uint8_t slaveId, uint8_t) { telemetry.forget(slaveId); });
+}
+
+void printHistogram(const char* name, const LatencyHistogram& histogram) {
+    Serial.printf("%s: n=%lu p50<=%lu us p90<=%lu us p99<=%lu us max=%lu us\n", name,
+                  (unsigned long)histogram.count(), (unsigned long)histogram.percentile(0.50f),
+                  (unsigned long)histogram.percentile(0.90f), (unsigned long)histogram.percentile(0.99f),
+                  (unsigned long)histogram.max());
+    for (uint8_t i = 0; i < LatencyHistogram::BUCKETS; i++) {
+        if (histogram.bucket(i)) {
+            Serial.printf("  <=%8lu us %lu\n", (unsigned long)LatencyHistogram::bucketLimitUs(i),
+                          (unsigned long)histogram.bucket(i));
         }
     }
 }
@@ -42,39 +244,45 @@ void setup() {
     
     // Initialize the master
     master.begin();
+
+    // From here on only the bus task touches the master
+    xTaskCreatePinnedToCore(busTask, "starwire", 4096, nullptr, BUS_PRIORITY, nullptr, BUS_CORE);
     
     Serial.println("PJON Master initialized with Com-Prot library and debug handler");
-    Serial.printf("OneWire pin: GPIO %d\n", 19);
+    Serial.printf("OneWire pin: GPIO %d, bus task on core %d, loop on core %d\n", BUS_PIN, BUS_CORE, xPortGetCoreID());
 }
 
 void loop() {
-    // Update master (handles incoming messages and timeouts)
-    master.update();
+    processBusEvents();
     
     // Example: Send commands to slaves every 5 seconds
     static unsigned long lastCommand = 0;
     if (millis() - lastCommand > 5000) {
         
-        // Get all connected slaves
-        auto allSlaves = master.getConnectedSlaves();
-        Serial.printf("Connected slaves: %d\n", allSlaves.size());
+        // Connected slaves as last reported by the bus task
+        Serial.printf("Connected slaves: %d\n", slaves.count());
         
-        for (const auto& slave : allSlaves) {
-            Serial.printf("Slave ID: %d, Type: %d\n", slave.id, slave.type);
+        for (SlaveRegistry::Slave slave : slaves.slaves()) {
+            if (telemetry.valid(slave.id)) {
+                Serial.printf("Slave ID: %d, Type: %d, Output: %d, Cmd: 0x%X\n", slave.id, slave.type,
+                              telemetry.output(slave.id), telemetry.status(slave.id));
+            } else {
+                Serial.printf("Slave ID: %d, Type: %d\n", slave.id, slave.type);
+            }
         }
         
         // Example commands:
         
         // 1. Send LED toggle command (0x10) to all slaves of type 1 using broadcast
-        if (master.getSlavesByType(1).size() > 0) {
+        if (slaves.hasSlaveOfType(1)) {
             uint8_t ledState = (millis() / 5000) % 2; // Toggle every 5 seconds
-            master.sendCommandToSlaveType(1, 0x10, &ledState, 1);
+            queueCommand(true, 1, 0x10, &ledState, 1);
             Serial.printf("Sent LED broadcast command (%d) to type 1 slaves\n", ledState);
         }
         
         // 2. Send temperature request (0x20) to all slaves of type 2 using broadcast
-        if (master.getSlavesByType(2).size() > 0) {
-            master.sendCommandToSlaveType(2, 0x20);
+        if (slaves.hasSlaveOfType(2)) {
+            queueCommand(true, 2, 0x20);
             Serial.println("Sent temperature request broadcast to type 2 slaves");
         }
         
@@ -88,24 +296,21 @@ void loop() {
         
         lastCommand = millis();
     }
-    
-    // Optional: Uncomment to print slave list every second
-    /*
-    static unsigned long lastListPrint = 0;
-    if (millis() - lastListPrint > 1000) {
-        auto slaves = master.getConnectedSlaves();
-        Serial.printf("Active slaves (%d): ", slaves.size());
-        
-        if (slaves.empty()) {
-            Serial.println("None");
-        } else {
-            for (const auto& slave : slaves) {
-                Serial.printf("ID: %d, Type: %d ", slave.id, slave.type);
-            }
-            Serial.println();
-        }
-        
-        lastListPrint = millis();
+
+    // 4. Heartbeat processing latency across the cores
+    static unsigned long lastLatencyReport = 0;
+    if (millis() - lastLatencyReport > LATENCY_REPORT_INTERVAL) {
+        printHistogram("Heartbeat latency (bus task -> core 1)", heartbeatLatency);
+        portENTER_CRITICAL(&busStatsLock);
+        LatencyHistogram pollInterval = busPollInterval;
+        portEXIT_CRITICAL(&busStatsLock);
+        printHistogram("Bus poll interval (core 0)", pollInterval);
+        Serial.printf("Bus task max pass %lu us, events dropped %lu, commands dropped %lu\n",
+                      (unsigned long)busMaxLoopUs, (unsigned long)busEvents.dropped(),
+                      (unsigned long)busCommands.dropped());
+        lastLatencyReport = millis();
     }
-    */
+
+    // Core 1 has nothing time-critical; give the idle task a turn
+    delay(1);
 }
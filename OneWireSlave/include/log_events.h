@@ -0,0 +1,26 @@
+#ifndef LOG_EVENTS_H
+#define LOG_EVENTS_H
+
+/*
+ * Event ids of the slave's binary log (StarWireKit binary_log.h).
+ *
+ * The comment after each id is the text the host prints for it, with
+ * {n} replaced by argument n (Python format syntax).
+ * StarWireKit/tools/log_decode.py reads the formats from this file, so
+ * keep one event per line and the format in double quotes.
+ */
+
+#include <stdint.h>
+
+enum LogEvent : uint8_t
+{
+    EV_COMMAND = 1,        // "[CMD] cmd=0x{0:X} action={1} from master {2}"
+    EV_SOLAR = 2,          // "[SOLAR] A0={0}, Mode={1}, RGB=#{2:06X}"
+    EV_ALIVE = 3,          // "Looping... (uptime: {0} seconds) data_received: {1}, log dropped: {2}"
+    EV_BUS_POLLS = 4,      // "[BUS] polls {0}, gaps: {1} (max {2} us)"
+    EV_BUS_QUEUE = 5,      // "[BUS] late: {0} of {1} (max {2} us), dropped {3}"
+    EV_WIND_SPEEDUP = 6,   // "Wind motor speedup active: {0}"
+    EV_LED_REFRESH = 7,    // "[LED] last minute: {0} refreshes, {1} saved"
+};
+
+#endif // LOG_EVENTS_H
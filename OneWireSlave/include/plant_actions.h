@@ -0,0 +1,222 @@
+#ifndef PLANT_ACTIONS_H
+#define PLANT_ACTIONS_H
+
+/*
+ * Command -> actuator state tables for every powerplant type.
+ *
+ * The host sends a 4-bit command. Each SLAVE_TYPE has a 16-entry table
+ * indexed directly by that command, holding the precomputed actuator
+ * state, so dispatching a command is one indexed load and one actuator
+ * write instead of a switch over the command codes. Entries with
+ * ACTION_NONE are not registered with the bus and are never dispatched.
+ *
+ * LED entries hold the final PWM colour (led_gradient.h: gamma-corrected,
+ * brightness multiplied in), so the strip stays at setBrightness(255) and
+ * a command is one setColor(). The tables live in flash (flash_table.h);
+ * read entries with flashRead().
+ */
+
+#include <stdint.h>
+#include <flash_table.h>
+#include <led_gradient.h>
+
+// Types
+#define TYPE_PHOTOVOLTAIC 1
+#define TYPE_WIND 2
+#define TYPE_NUCLEAR 3
+#define TYPE_GAS 4
+#define TYPE_HYDRO 5
+#define TYPE_HYDRO_STORAGE 6
+#define TYPE_COAL 7
+#define TYPE_BATTERY 8
+
+#define PLANT_TYPE_COUNT 9   // index 0 unused
+#define PLANT_COMMAND_COUNT 16
+
+// 4-bit commands
+static const uint8_t CMD_ON = 0x01;
+static const uint8_t CMD_OFF = 0x02;
+static const uint8_t BAT_IDLE = 0x03;
+static const uint8_t BAT_CHARGING = 0x04;
+static const uint8_t BAT_DISCHARGE = 0x05;
+
+// Gas powerplant specific commands (expanded to 10 levels)
+// We reuse the 4-bit command space (0x0 - 0xF). Codes are shared across types, so
+// overlapping numeric values with other powerplants is acceptable.
+// The levels take the top GAS_LEVEL_COUNT codes and their colours come from
+// GAS_GRADIENT, so changing the count is the only edit needed (16 uses the
+// whole nibble, CMD_OFF included).
+static const uint8_t GAS_LEVEL_COUNT = 10;
+static const uint8_t GAS_LEVEL_1  = PLANT_COMMAND_COUNT - GAS_LEVEL_COUNT; // 0x06: 10%
+static const uint8_t GAS_LEVEL_2  = GAS_LEVEL_1 + 1; // 20%
+static const uint8_t GAS_LEVEL_3  = GAS_LEVEL_1 + 2; // 30%
+static const uint8_t GAS_LEVEL_4  = GAS_LEVEL_1 + 3; // 40%
+static const uint8_t GAS_LEVEL_5  = GAS_LEVEL_1 + 4; // 50%
+static const uint8_t GAS_LEVEL_6  = GAS_LEVEL_1 + 5; // 60%
+static const uint8_t GAS_LEVEL_7  = GAS_LEVEL_1 + 6; // 70%
+static const uint8_t GAS_LEVEL_8  = GAS_LEVEL_1 + 7; // 80%
+static const uint8_t GAS_LEVEL_9  = GAS_LEVEL_1 + 8; // 90%
+static const uint8_t GAS_LEVEL_10 = GAS_LEVEL_1 + 9; // 100% (peak)
+
+// Red -> green, low -> high production; the middle stop gives the blue
+// tint the hand-picked ten-level table had
+constexpr LedColor GAS_GRADIENT[] = {{255, 0, 0}, {128, 128, 160}, {0, 255, 0}};
+
+// Hydro Storage specific commands (5 levels)
+static const uint8_t HYDRO_STORAGE_LEVEL_1 = 0x0B; // Green - 100% (Discharging)
+static const uint8_t HYDRO_STORAGE_LEVEL_2 = 0x0C; // Light Green - 75%
+static const uint8_t HYDRO_STORAGE_LEVEL_3 = 0x0D; // Orange - 50% (Idle)
+static const uint8_t HYDRO_STORAGE_LEVEL_4 = 0x0E; // Light Red - 25%
+static const uint8_t HYDRO_STORAGE_LEVEL_5 = 0x0F; // Red - 0% (Charging)
+
+enum PlantActionKind : uint8_t {
+    ACTION_NONE = 0,   // command not used by this type
+    ACTION_LED,        // setColor(red, green, blue) + show(), brightness already applied
+    ACTION_MOTOR,      // forward(value), stop() when value is 0
+    ACTION_ATOMIZER,   // drive the atomizer to value (1 = active)
+    ACTION_SOLAR_MODE  // switch the photovoltaic light-follow mode to value
+};
+
+/**
+ * @brief Precomputed actuator state for one (type, command) pair.
+ */
+struct PlantAction {
+    uint8_t kind;
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+    uint16_t value;  // motor duty, atomizer target or solar mode
+};
+
+constexpr PlantAction noAction() { return {ACTION_NONE, 0, 0, 0, 0}; }
+constexpr PlantAction ledAction(LedColor output) {
+    return {ACTION_LED, output.red, output.green, output.blue, 0};
+}
+constexpr PlantAction ledAction(uint8_t r, uint8_t g, uint8_t b, uint8_t brightness) {
+    return ledAction(ledOutput({r, g, b}, brightness));
+}
+constexpr PlantAction motorAction(uint16_t duty) { return {ACTION_MOTOR, 0, 0, 0, duty}; }
+constexpr PlantAction atomizerAction(bool active) { return {ACTION_ATOMIZER, 0, 0, 0, active}; }
+constexpr PlantAction solarModeAction(uint8_t mode) { return {ACTION_SOLAR_MODE, 0, 0, 0, mode}; }
+
+constexpr PlantAction gasAction(uint8_t cmd) {
+    return cmd >= GAS_LEVEL_1 ? ledAction(ledOutput(ledGradient(GAS_GRADIENT, 3, cmd - GAS_LEVEL_1, GAS_LEVEL_COUNT)))
+         : cmd == CMD_OFF ? ledAction(0, 0, 0, 0)
+         : noAction();
+}
+
+#define PLANT_ROW(action)                                                           \
+    { action(0x0), action(0x1), action(0x2), action(0x3), action(0x4), action(0x5), \
+      action(0x6), action(0x7), action(0x8), action(0x9), action(0xA), action(0xB), \
+      action(0xC), action(0xD), action(0xE), action(0xF) }
+
+#define PLANT_NONE_ROW                                                              \
+    { noAction(), noAction(), noAction(), noAction(), noAction(), noAction(),       \
+      noAction(), noAction(), noAction(), noAction(), noAction(), noAction(),       \
+      noAction(), noAction(), noAction(), noAction() }
+
+// Rows are indexed [SLAVE_TYPE][cmd4]; columns 0x0 .. 0xF.
+constexpr PlantAction PLANT_ACTIONS[PLANT_TYPE_COUNT][PLANT_COMMAND_COUNT] STARWIRE_FLASH = {
+    // 0: unused
+    PLANT_NONE_ROW,
+    // TYPE_PHOTOVOLTAIC: 0=idle (green), 1=half power (orange), 2=night (red)
+    { noAction(), solarModeAction(1), solarModeAction(2), solarModeAction(0),
+      noAction(), noAction(), noAction(), noAction(),
+      noAction(), noAction(), noAction(), noAction(),
+      noAction(), noAction(), noAction(), noAction() },
+    // TYPE_WIND: 150 duty ~ the 70 power level the turbine was tuned for
+    { noAction(), motorAction(150), motorAction(0), noAction(),
+      noAction(), noAction(), noAction(), noAction(),
+      noAction(), noAction(), noAction(), noAction(),
+      noAction(), noAction(), noAction(), noAction() },
+    // TYPE_NUCLEAR
+    { noAction(), atomizerAction(true), atomizerAction(false), noAction(),
+      noAction(), noAction(), noAction(), noAction(),
+      noAction(), noAction(), noAction(), noAction(),
+      noAction(), noAction(), noAction(), noAction() },
+    // TYPE_GAS: GAS_GRADIENT over GAS_LEVEL_COUNT levels
+    PLANT_ROW(gasAction),
+    // TYPE_HYDRO: full speed
+    { noAction(), motorAction(1023), motorAction(0), noAction(),
+      noAction(), noAction(), noAction(), noAction(),
+      noAction(), noAction(), noAction(), noAction(),
+      noAction(), noAction(), noAction(), noAction() },
+    // TYPE_HYDRO_STORAGE
+    { noAction(), noAction(), ledAction(0, 0, 0, 0), noAction(),
+      noAction(), noAction(), noAction(), noAction(),
+      noAction(), noAction(), noAction(),
+      ledAction(0, 255, 0, 255),     // HYDRO_STORAGE_LEVEL_1
+      ledAction(128, 255, 128, 192), // HYDRO_STORAGE_LEVEL_2
+      ledAction(255, 140, 0, 128),   // HYDRO_STORAGE_LEVEL_3
+      ledAction(255, 128, 128, 96),  // HYDRO_STORAGE_LEVEL_4
+      ledAction(255, 0, 0, 64) },    // HYDRO_STORAGE_LEVEL_5
+    // TYPE_COAL
+    { noAction(), atomizerAction(true), atomizerAction(false), noAction(),
+      noAction(), noAction(), noAction(), noAction(),
+      noAction(), noAction(), noAction(), noAction(),
+      noAction(), noAction(), noAction(), noAction() },
+    // TYPE_BATTERY: dimmed to 64
+    { noAction(), noAction(), noAction(),
+      ledAction(255, 140, 0, 64),    // BAT_IDLE
+      ledAction(255, 0, 0, 64),      // BAT_CHARGING
+      ledAction(0, 255, 0, 64),      // BAT_DISCHARGE
+      noAction(), noAction(),
+      noAction(), noAction(), noAction(), noAction(),
+      noAction(), noAction(), noAction(), noAction() },
+};
+
+#undef PLANT_NONE_ROW
+#undef PLANT_ROW
+
+// Photovoltaic light-follow colours, indexed by A0 >> SOLAR_LUT_SHIFT
+// (A0 reads 0..1024). Brightness ramps 16 -> 255 with the light. Mode 0
+// (idle) goes yellow -> green, mode 1 (half power) red -> orange, mode 2
+// (night) ignores the light.
+static const uint8_t SOLAR_LUT_SHIFT = 5;
+static const uint8_t SOLAR_LUT_LEVELS = (1024 >> SOLAR_LUT_SHIFT) + 1;
+constexpr LedColor SOLAR_IDLE_STOPS[] = {{255, 255, 0}, {0, 255, 0}};
+constexpr LedColor SOLAR_HALF_STOPS[] = {{255, 0, 0}, {255, 165, 0}};
+constexpr LedLut<SOLAR_LUT_LEVELS> SOLAR_LUTS[2] STARWIRE_FLASH = {
+    makeLedLut<SOLAR_LUT_LEVELS>(SOLAR_IDLE_STOPS, 2, 16, 255),
+    makeLedLut<SOLAR_LUT_LEVELS>(SOLAR_HALF_STOPS, 2, 16, 255),
+};
+constexpr LedColor SOLAR_NIGHT = ledOutput({255, 0, 0}, 32);
+
+// A0 pipeline: one reading every SOLAR_SAMPLE_MS (as often as the slave
+// always read it), AdcFilter with 2^SOLAR_OVERSAMPLE_SHIFT readings per
+// output, median of 3 and EMA 1/2^SOLAR_EMA_SHIFT, then SOLAR_HYSTERESIS
+// A0 counts (a LUT step is 32). BusSimulator's --bench adc and its trace
+// test use the same settings.
+static const uint16_t SOLAR_SAMPLE_MS = 50;
+static const uint8_t SOLAR_OVERSAMPLE_SHIFT = 0;
+static const uint8_t SOLAR_EMA_SHIFT = 2;
+static const uint16_t SOLAR_HYSTERESIS = 6;
+
+/**
+ * @brief The single actuator kind a type's table drives.
+ *
+ * Every row uses one kind only, so a build can resolve the actuator at
+ * compile time and the handler is left with the table load and the write.
+ */
+constexpr uint8_t plantActionKind(uint8_t type, uint8_t cmd = 0) {
+    return cmd >= PLANT_COMMAND_COUNT ? (uint8_t)ACTION_NONE
+         : PLANT_ACTIONS[type][cmd].kind != ACTION_NONE ? PLANT_ACTIONS[type][cmd].kind
+         : plantActionKind(type, cmd + 1);
+}
+
+constexpr bool plantRowUniform(uint8_t type, uint8_t cmd = 0) {
+    return cmd >= PLANT_COMMAND_COUNT
+        || ((PLANT_ACTIONS[type][cmd].kind == ACTION_NONE || PLANT_ACTIONS[type][cmd].kind == plantActionKind(type))
+            && plantRowUniform(type, cmd + 1));
+}
+
+static_assert(plantRowUniform(TYPE_PHOTOVOLTAIC) && plantRowUniform(TYPE_WIND) && plantRowUniform(TYPE_NUCLEAR)
+                  && plantRowUniform(TYPE_GAS) && plantRowUniform(TYPE_HYDRO) && plantRowUniform(TYPE_HYDRO_STORAGE)
+                  && plantRowUniform(TYPE_COAL) && plantRowUniform(TYPE_BATTERY),
+              "each powerplant type must drive a single actuator kind");
+static_assert(PLANT_ACTIONS[TYPE_GAS][PLANT_COMMAND_COUNT - 1].green == 255, "gas table out of order");
+static_assert(PLANT_ACTIONS[TYPE_HYDRO_STORAGE][HYDRO_STORAGE_LEVEL_5].red == 64,
+              "hydro storage table out of order");
+static_assert(PLANT_ACTIONS[TYPE_BATTERY][BAT_DISCHARGE].green == 64, "battery table out of order");
+
+#endif // PLANT_ACTIONS_H
@@ -12,8 +12,99 @@ uint8_t solarMode = 0; // 0=idle (green), 1=half power (orange), 2=night (red)
 #include <Arduino.h>
 #include <com-prot.h>
 #include "PeripheralFactory.h"
+#include "plant_actions.h"
+#include <scene_frame.h>
+#include <fleet_state.h>
+#include <bus_service_stats.h>
+#include <spsc_queue.h>
+#include <animator.h>
+#include <change_tracking.h>
+#include <adc_filter.h>
+#include <telemetry.h>
+#include <heartbeat_schedule.h>
+#include <latency_histogram.h>
+#include <link_stats.h>
 #define DEBUG_MODE
 
+// Hot-path logging goes through a binary ring (see log_events.h) that
+// loop() drains only as fast as the UART FIFO takes it. Records above
+// STARWIRE_LOG_LEVEL are compiled out; build with -D STARWIRE_LOG_LEVEL=0
+// for none at all. Decode with StarWireKit/tools/log_decode.py.
+#ifndef STARWIRE_LOG_LEVEL
+#ifdef DEBUG_MODE
+#define STARWIRE_LOG_LEVEL 4 // STARWIRE_LOG_DEBUG
+#else
+#define STARWIRE_LOG_LEVEL 0 // STARWIRE_LOG_OFF
+#endif
+#endif
+#include <binary_log.h>
+#include "log_events.h"
+
+// Bus servicing. By default loop() polls the bus after the peripheral work,
+// so slow actuators delay reception. ESP32/ESP32-S3 builds with
+// -D BUS_SERVICE_TASK poll from a FreeRTOS task pinned to BUS_SERVICE_CORE
+// instead; handlers then only queue the decoded command and loop() applies
+// it. The ESP8266 has no such mode: com-prot cannot run from a timer ISR.
+#ifndef BUS_SERVICE_GAP_BUDGET_US
+#define BUS_SERVICE_GAP_BUDGET_US 2000 // longer between polls and frames can be missed
+#endif
+#ifndef BUS_SERVICE_LATE_BUDGET_US
+#define BUS_SERVICE_LATE_BUDGET_US 20000 // queued command applied later than this is late
+#endif
+#ifndef BUS_SERVICE_CORE
+#define BUS_SERVICE_CORE 0 // ESP32: core for the bus task, loop() runs on core 1
+#endif
+#ifndef BUS_SERVICE_PRIORITY
+#define BUS_SERVICE_PRIORITY 10 // above loop() (1), below the WiFi/lwIP tasks (18+) on core 0
+#endif
+#ifndef BUS_SERVICE_IDLE_MS
+#define BUS_SERVICE_IDLE_MS 1 // bus task wakes at least this often without line activity
+#endif
+#if defined(BUS_SERVICE_TASK) && !defined(ESP32)
+#error "BUS_SERVICE_TASK needs an ESP32/ESP32-S3, on the ESP8266 loop() services the bus"
+#endif
+
+// Output transitions. Commands retarget a fixed-point fade that
+// factory.update() advances every FADE_PERIOD_MS. A fade or ramp time of
+// 0 ms switches instantly.
+#ifndef FADE_PERIOD_MS
+#define FADE_PERIOD_MS 10
+#endif
+#ifndef LED_FADE_MS
+#define LED_FADE_MS 400 // colour/brightness change of commandLed
+#endif
+#ifndef MOTOR_RAMP_MS
+#define MOTOR_RAMP_MS 1500 // duty ramp of commandMotor, spares the gearbox
+#endif
+
+// Telemetry. The measured output and the applied command ride on the
+// heartbeat, delta encoded (see telemetry.h); a full value goes out at
+// least every TELEMETRY_KEYFRAME_INTERVAL heartbeats.
+#ifndef TELEMETRY_KEYFRAME_INTERVAL
+#define TELEMETRY_KEYFRAME_INTERVAL 10
+#endif
+#ifndef TELEMETRY_INTERVAL_MS
+#define TELEMETRY_INTERVAL_MS 1000 // com-prot builds without heartbeat extension: own frame, only on change
+#endif
+
+// Heartbeat timing (com-prot builds with COM_PROT_HEARTBEAT_SCHEDULE). The
+// phase comes from SLAVE_ID and every gap is jittered, so slaves powered up
+// together do not beat in lockstep; a busy bus and idling stretch the gap.
+// The master times each slave out on the interval it announces. Other
+// com-prot builds only get the SLAVE_ID phase, by delaying slave.begin().
+#ifndef HEARTBEAT_INTERVAL_MS
+#define HEARTBEAT_INTERVAL_MS 1000
+#endif
+#ifndef HEARTBEAT_IDLE_INTERVAL_MS
+#define HEARTBEAT_IDLE_INTERVAL_MS 4000 // after HEARTBEAT_IDLE_AFTER_MS without a command
+#endif
+#ifndef HEARTBEAT_IDLE_AFTER_MS
+#define HEARTBEAT_IDLE_AFTER_MS 30000
+#endif
+#ifndef HEARTBEAT_JITTER_PERCENT
+#define HEARTBEAT_JITTER_PERCENT 20
+#endif
+
 using namespace StarWire;
 
 #ifdef DEBUG_MODE
@@ -26,6 +117,8 @@ using namespace StarWire;
 #define DEBUG_PRINTF(x, ...)
 #endif
 
+#define LOG_EVENT(level, event, ...) STARWIRE_LOG(binlog, level, event, ##__VA_ARGS__)
+
 #ifndef SLAVE_ID
 #define SLAVE_ID 1000
 #endif
@@ -37,16 +130,6 @@ using namespace StarWire;
 #endif
 
 
-// Types
-#define TYPE_PHOTOVOLTAIC 1
-#define TYPE_WIND 2
-#define TYPE_NUCLEAR 3
-#define TYPE_GAS 4
-#define TYPE_HYDRO 5
-#define TYPE_HYDRO_STORAGE 6
-#define TYPE_COAL 7
-#define TYPE_BATTERY 8
-
 #define DATA_PIN D1
 #define CLK_PIN D7
 #if (SLAVE_TYPE != TYPE_PHOTOVOLTAIC) && (SLAVE_TYPE != TYPE_WIND) && (SLAVE_TYPE != TYPE_NUCLEAR) && (SLAVE_TYPE != TYPE_GAS) && (SLAVE_TYPE != TYPE_HYDRO) && (SLAVE_TYPE != TYPE_HYDRO_STORAGE) && (SLAVE_TYPE != TYPE_COAL) && (SLAVE_TYPE != TYPE_BATTERY)
@@ -65,6 +148,12 @@ RGBLED *gasLed = nullptr; // for GAS
 Motor *hydroMotor = nullptr; // for HYDRO
 RGBLED *hydroStorageLed = nullptr; // for HYDRO_STORAGE
 Motor *windMotor = nullptr; // for WIND
+RGBLED *commandLed = nullptr; // whichever LED the action table drives
+Motor *commandMotor = nullptr; // whichever motor the action table drives
+
+// Actions of this build, indexed by the 4-bit command
+static const PlantAction *const ACTIONS = PLANT_ACTIONS[SLAVE_TYPE];
+static const uint8_t ACTION_KIND = plantActionKind(SLAVE_TYPE); // folds the switch below
 
 #ifdef OTA_MODE_ENABLED
 #include <ota.h>
@@ -88,270 +177,371 @@ Motor *windMotor = nullptr; // for WIND
 #define DEBUG_WEB_FLUSH()
 #endif
 
-// 4-bit commands
-static const uint8_t CMD_ON = 0x01;
-static const uint8_t CMD_OFF = 0x02;
-static const uint8_t BAT_IDLE = 0x03;
-static const uint8_t BAT_CHARGING = 0x04;
-static const uint8_t BAT_DISCHARGE = 0x05;
-
-// Gas powerplant specific commands (expanded to 10 levels)
-// We reuse the 4-bit command space (0x0 - 0xF). Codes are shared across types, so
-// overlapping numeric values with other powerplants is acceptable.
-// Gradient (low -> high production) per user spec:
-// 1: (255, 0, 0)
-// 2: (227, 28, 36)
-// 3: (198, 57, 71)
-// 4: (170, 85,107)
-// 5: (142,113,142)
-// 6: (113,142,142)
-// 7: ( 85,170,107)
-// 8: ( 57,198, 71)
-// 9: ( 28,227, 36)
-//10: (  0,255,  0)
-// Level numbering kept sequential for clarity.
-static const uint8_t GAS_LEVEL_1  = 0x06; // 10%  Red
-static const uint8_t GAS_LEVEL_2  = 0x07; // 20%  Purple
-static const uint8_t GAS_LEVEL_3  = 0x08; // 30%  Blue
-static const uint8_t GAS_LEVEL_4  = 0x09; // 40%  Light Blue
-static const uint8_t GAS_LEVEL_5  = 0x0A; // 50%  Cyan
-static const uint8_t GAS_LEVEL_6  = 0x0B; // 60%  Teal
-static const uint8_t GAS_LEVEL_7  = 0x0C; // 70%  Green
-static const uint8_t GAS_LEVEL_8  = 0x0D; // 80%  Lime
-static const uint8_t GAS_LEVEL_9  = 0x0E; // 90%  Yellow-Green
-static const uint8_t GAS_LEVEL_10 = 0x0F; // 100% Yellow (peak)
-
-// Hydro Storage specific commands (5 levels)
-static const uint8_t HYDRO_STORAGE_LEVEL_1 = 0x0B; // Green - 100% (Discharging)
-static const uint8_t HYDRO_STORAGE_LEVEL_2 = 0x0C; // Light Green - 75%
-static const uint8_t HYDRO_STORAGE_LEVEL_3 = 0x0D; // Orange - 50% (Idle)
-static const uint8_t HYDRO_STORAGE_LEVEL_4 = 0x0E; // Light Red - 25%
-static const uint8_t HYDRO_STORAGE_LEVEL_5 = 0x0F; // Red - 0% (Charging)
-
 bool data_recieved = false;
 
 // Photovoltaic specific variables
 #define SOLAR_PIN A0
-unsigned long lastSolarUpdate = 0;
-const unsigned long SOLAR_UPDATE_INTERVAL = 50; // Update every 100ms
+unsigned long lastSolarSample = 0;
+// Settings in plant_actions.h; compare them with BusSimulator --bench adc [--trace FILE]
+AdcFilter solarFilter(SOLAR_OVERSAMPLE_SHIFT, SOLAR_EMA_SHIFT);
+AnalogHysteresis solarLight(SOLAR_HYSTERESIS);
 uint8_t solarMode = 0; // 0=default green, 1=high production, 2=low production
 
-// ---------- Handlers ----------
-static void handleMisty(uint8_t cmd4, uint8_t senderId)
+uint8_t appliedCmd = 0; // last command acted on, 0 = none since boot
+
+Animator<3> ledFade; // commandLed red, green, blue (brightness is in the colour)
+Animator<1> motorRamp; // commandMotor duty
+
+// Every slave drives at most one strip; a WS2812 refresh blocks interrupts
+// (~30 us per LED) and so competes with the bus, push only real changes
+LedShadow ledShadow;
+const unsigned long LED_REPORT_INTERVAL = 60000;
+
+TelemetryEncoder telemetry(TELEMETRY_KEYFRAME_INTERVAL);
+
+BinaryLog<16> binlog;
+BusServiceStats busStats(BUS_SERVICE_GAP_BUDGET_US, BUS_SERVICE_LATE_BUDGET_US);
+
+// Start-to-start time of loop(), sent with the link stats
+LatencyHistogram loopTime;
+uint32_t lastLoopUs = 0;
+
+#ifdef BUS_SERVICE_TASK
+// Decoded command handed from the bus task to loop()
+struct QueuedCommand
 {
-    DEBUG_PRINTF("[MISTY] cmd=0x%X from master %u\n", cmd4, senderId);
-    data_recieved = true;
-    if (!atomizer)
-        return;
+    uint8_t cmd4;
+    uint8_t senderId;
+    bool resync; // from a fleet sync, skip if already applied
+    uint32_t receivedUs;
+};
+SpscQueue<QueuedCommand, 16> commandQueue;
+volatile bool linkStatsRequested = false;
+volatile bool heartbeatActivityPending = false; // set by loop(), the bus task owns the heartbeat schedule
+
+// Response built by loop(), sent by the bus task: only that task enters com-prot
+struct OutboundFrame
+{
+    uint8_t command;
+    uint8_t length;
+    uint8_t data[LINK_STATS_LENGTH]; // the longest response, telemetry is shorter
+};
+SpscQueue<OutboundFrame, 4> outboundQueue;
+#endif
 
-    bool wantOn = (cmd4 == CMD_ON);
-    bool wantOff = (cmd4 == CMD_OFF);
+#ifndef COM_PROT_LINK_STATS
+// com-prot keeps no link counters: count the frames this sketch sends and
+// its debug hook sees. Heartbeats, CRC errors and retries stay invisible.
+LinkCounters sketchLink;
+#endif
 
-    if (!wantOn && !wantOff)
-    {
-        DEBUG_PRINTLN("[MISTY] Unknown cmd, ignored.");
-        return;
-    }
+// Every response leaves through here, from loop() or the bus task
+static void transmitResponse(uint8_t command, const uint8_t *data, uint8_t length)
+{
+    slave.sendResponse(command, data, length);
+#ifndef COM_PROT_LINK_STATS
+    linkCountSent(sketchLink, 2 + length); // [COM_PROT_RESPONSE, command, data]
+#endif
+}
 
-    bool target = wantOn;
+// Refreshes the strip only if the colour differs from what it shows
+static bool showIfChanged(RGBLED *led, uint8_t red, uint8_t green, uint8_t blue)
+{
+    if (!ledShadow.changed(red, green, blue))
+        return false;
+    led->setColor(red, green, blue);
+    led->show();
+    return true;
+}
 
-    DEBUG_PRINTF("[MISTY] Target state: %s\n", target ? "Active" : "Inactive");
-    if (target != atomizer->getTargetState())
-    {
-        atomizer->toggle();
-        DEBUG_PRINTF("[MISTY] Toggled -> %s\n", atomizer->getTargetState() ? "Active" : "Inactive");
-    }
+// Table colours already have gamma and brightness applied, so the strip stays at full brightness
+static inline void showLed(RGBLED *led, LedColor color)
+{
+    led->setBrightness(255);
+    ledShadow.invalidate();
+    showIfChanged(led, color.red, color.green, color.blue);
 }
 
-static void handleBattery(uint8_t cmd4, uint8_t senderId)
+// Shows the boot colour and starts the fades from it
+static inline void initCommandLed(RGBLED *led, LedColor color)
 {
-    data_recieved = true;
-    DEBUG_PRINTF("[BAT] cmd=0x%X from master %u\n", cmd4, senderId);
-    if (!batteryLed)
+    showLed(led, color);
+    const uint16_t start[3] = {color.red, color.green, color.blue};
+    ledFade.reset(start);
+    commandLed = led;
+}
+
+// Runs every FADE_PERIOD_MS from factory.update(); writes only changed outputs
+static void animateOutputs()
+{
+    if (commandLed && ledFade.active())
     {
-        DEBUG_PRINTLN("[BAT] LED not initialized");
-        return;
+        ledFade.tick();
+        showIfChanged(commandLed, ledFade.output(0), ledFade.output(1), ledFade.output(2));
     }
+    if (commandMotor && motorRamp.tick())
+    {
+        if (motorRamp.output(0))
+            commandMotor->forward(motorRamp.output(0));
+        else
+            commandMotor->stop();
+    }
+}
 
-    switch (cmd4)
+// What the plant produces right now, 0..255
+static uint8_t measuredOutput()
+{
+    switch (ACTION_KIND)
     {
-    case BAT_CHARGING:
-        batteryLed->setColor(255, 0, 0);
-        DEBUG_PRINTLN("Battery: Charging -> RED");
-        break;
-    case BAT_IDLE:
-        batteryLed->setColor(255, 140, 0);
-        DEBUG_PRINTLN("Battery: Idle -> ORANGE");
-        break;
-    case BAT_DISCHARGE:
-        batteryLed->setColor(0, 255, 0);
-        DEBUG_PRINTLN("Battery: Discharging -> GREEN");
-        break;
-    default:
-        DEBUG_PRINTF("Battery: Unknown cmd 0x%X (ignored)\n", cmd4);
-        return;
+    case ACTION_LED:
+    {
+        uint16_t level = ledFade.output(0); // brightest channel, brightness is in the colour
+        for (uint8_t i = 1; i < 3; i++)
+        {
+            if (ledFade.output(i) > level)
+                level = ledFade.output(i);
+        }
+        return (uint8_t)level;
     }
-    batteryLed->show();
+    case ACTION_MOTOR:
+        return motorRamp.output(0);
+    case ACTION_ATOMIZER:
+        return atomizer && atomizer->getTargetState() ? 255 : 0;
+    case ACTION_SOLAR_MODE:
+        return solarLight.value() >= 1020 ? 255 : solarLight.value() >> 2;
+    }
+    return 0;
+}
+
+// Sends a response from loop(), or from a handler when loop() services the
+// bus. With BUS_SERVICE_TASK it is queued for the bus task; false if the
+// queue is full.
+static bool sendResponse(uint8_t command, const uint8_t *data, uint8_t length)
+{
+#ifdef BUS_SERVICE_TASK
+    OutboundFrame frame;
+    frame.command = command;
+    frame.length = length;
+    memcpy(frame.data, data, length);
+    return outboundQueue.push(frame);
+#else
+    transmitResponse(command, data, length);
+    return true;
+#endif
+}
+
+#ifdef COM_PROT_HEARTBEAT_EXTENSION
+// Called by com-prot for every heartbeat; the status nibble is the applied command
+static uint8_t heartbeatTelemetry(uint8_t *data, uint8_t maxLength)
+{
+    if (maxLength < TelemetryEncoder::MAX_LENGTH)
+        return 0;
+    return telemetry.encode(measuredOutput(), appliedCmd, data);
+}
+#else
+// Same bytes as a response frame, sent only when the encoder has something to say.
+// A frame that never left would break the master's delta chain, so the next one is full.
+static void sendTelemetry()
+{
+    uint8_t data[TelemetryEncoder::MAX_LENGTH];
+    uint8_t length = telemetry.encode(measuredOutput(), appliedCmd, data);
+    if (length && !sendResponse(STARWIRE_CMD_TELEMETRY, data, length))
+        telemetry.reset();
+}
+#endif
+
+// Answers the master's STARWIRE_CMD_LINK_STATS request: link counters from
+// com-prot (if it keeps them, else sketchLink), update gap and loop time from here. With
+// BUS_SERVICE_TASK the counters are read while the bus task may be counting,
+// which is fine for statistics; the answer itself goes out from that task.
+static void sendLinkStats()
+{
+#ifdef COM_PROT_LINK_STATS
+    const LinkCounters link = slave.linkCounters();
+#else
+    const LinkCounters link = sketchLink;
+#endif
+    uint8_t data[LINK_STATS_LENGTH];
+    uint8_t length = linkStatsEncode(link, busStats.maxGapUs(), loopTime, data);
+    sendResponse(STARWIRE_CMD_LINK_STATS, data, length);
 }
 
-static void handlePhotovoltaic(uint8_t cmd4, uint8_t senderId)
+// ---------- Handler ----------
+// Look up the precomputed state and write it to the actuator.
+static void applyCommand(uint8_t cmd4, uint8_t senderId, bool resync)
 {
+    // Periodic resync: only act when it differs from what we already run
+    if (resync && (cmd4 & 0x0F) == appliedCmd)
+        return;
+
+    const PlantAction action = flashRead(&ACTIONS[cmd4 & 0x0F]);
     data_recieved = true;
-    DEBUG_PRINTF("[SOLAR] cmd=0x%X from master %u\n", cmd4, senderId);
-    if (!solarLed)
+#ifdef COM_PROT_HEARTBEAT_SCHEDULE
+    // Repeated scenes of the same command do not keep the heartbeat fast
+    if ((cmd4 & 0x0F) != appliedCmd)
     {
-        DEBUG_PRINTLN("[SOLAR] LED not initialized");
-        return;
+#ifdef BUS_SERVICE_TASK
+        heartbeatActivityPending = true;
+#else
+        slave.heartbeatActivity();
+#endif
     }
+#endif
+    appliedCmd = cmd4 & 0x0F;
+    LOG_EVENT(STARWIRE_LOG_INFO, EV_COMMAND, cmd4, action.kind, senderId);
 
-    switch (cmd4)
+    switch (ACTION_KIND)
+    {
+    case ACTION_LED:
     {
-    case CMD_ON: // Half power mode (orange)
-        solarMode = 1;
-        DEBUG_PRINTLN("Solar: Half power mode (orange)");
+        const uint16_t color[3] = {action.red, action.green, action.blue};
+        ledFade.retarget(color, LED_FADE_MS / FADE_PERIOD_MS);
         break;
-    case CMD_OFF: // Night mode (red, no light reaction)
-        solarMode = 2;
-        DEBUG_PRINTLN("Solar: Night mode (red)");
+    }
+    case ACTION_MOTOR:
+        motorRamp.retarget(&action.value, MOTOR_RAMP_MS / FADE_PERIOD_MS);
         break;
-    case BAT_IDLE: // Idle mode (green)
-        solarMode = 0;
-        DEBUG_PRINTLN("Solar: Idle mode (green)");
+    case ACTION_ATOMIZER:
+        if (atomizer && (bool)action.value != atomizer->getTargetState())
+            atomizer->toggle();
+        break;
+    case ACTION_SOLAR_MODE:
+        solarMode = action.value;
         break;
-    default:
-        DEBUG_PRINTF("Solar: Unknown cmd 0x%X (ignored)\n", cmd4);
-        return;
     }
 }
 
-static void handleGas(uint8_t cmd4, uint8_t senderId)
+// Runs wherever the bus is serviced: applies right away when that is
+// loop(), otherwise hands the command over and returns.
+static void dispatchCommand(uint8_t cmd4, uint8_t senderId, bool resync)
 {
-    data_recieved = true;
-    DEBUG_PRINTF("[GAS] cmd=0x%X from master %u\n", cmd4, senderId);
-    if (!gasLed) {
-        DEBUG_PRINTLN("[GAS] LED not initialized");
-        return;
-    }
+#ifdef BUS_SERVICE_TASK
+    commandQueue.push({cmd4, senderId, resync, (uint32_t)micros()});
+#else
+    applyCommand(cmd4, senderId, resync);
+#endif
+}
 
-    switch (cmd4) {
-    case GAS_LEVEL_1:  gasLed->setColor(255, 0, 0);    gasLed->setBrightness(255); DEBUG_PRINTLN("Gas: Level 1 -> (255,0,0)"); break;
-    case GAS_LEVEL_2:  gasLed->setColor(227, 28, 36);  gasLed->setBrightness(255); DEBUG_PRINTLN("Gas: Level 2 -> (227,28,36)"); break;
-    case GAS_LEVEL_3:  gasLed->setColor(198, 57, 71);  gasLed->setBrightness(255); DEBUG_PRINTLN("Gas: Level 3 -> (198,57,71)"); break;
-    case GAS_LEVEL_4:  gasLed->setColor(170, 85,107);  gasLed->setBrightness(255); DEBUG_PRINTLN("Gas: Level 4 -> (170,85,107)"); break;
-    case GAS_LEVEL_5:  gasLed->setColor(142,113,142);  gasLed->setBrightness(255); DEBUG_PRINTLN("Gas: Level 5 -> (142,113,142)"); break;
-    case GAS_LEVEL_6:  gasLed->setColor(113,142,142);  gasLed->setBrightness(255); DEBUG_PRINTLN("Gas: Level 6 -> (113,142,142)"); break;
-    case GAS_LEVEL_7:  gasLed->setColor(85,170,107);   gasLed->setBrightness(255); DEBUG_PRINTLN("Gas: Level 7 -> (85,170,107)"); break;
-    case GAS_LEVEL_8:  gasLed->setColor(57,198,71);    gasLed->setBrightness(255); DEBUG_PRINTLN("Gas: Level 8 -> (57,198,71)"); break;
-    case GAS_LEVEL_9:  gasLed->setColor(28,227,36);    gasLed->setBrightness(255); DEBUG_PRINTLN("Gas: Level 9 -> (28,227,36)"); break;
-    case GAS_LEVEL_10: gasLed->setColor(0,255,0);      gasLed->setBrightness(255); DEBUG_PRINTLN("Gas: Level 10 -> (0,255,0) MAX"); break;
-    case CMD_OFF:      gasLed->setColor(0,0,0);        gasLed->setBrightness(0);   DEBUG_PRINTLN("Gas: OFF"); break;
-    default: DEBUG_PRINTF("Gas: Unknown cmd 0x%X (ignored)\n", cmd4); return; }
-    gasLed->show();
+// One handler for every registered command. Only codes with an action are registered.
+static void handleCommand(uint8_t cmd4, uint8_t senderId)
+{
+    dispatchCommand(cmd4, senderId, false);
 }
 
-static void handleHydro(uint8_t cmd4, uint8_t senderId)
+// Scene and fleet sync frames arrive as broadcast commands the slave never
+// registers a handler for; the debug hook sees every frame, so pick our
+// nibble here. Ids in these frames are 8-bit, like the PJON ids the master uses.
+static void handleFrame(uint8_t *payload, uint16_t length, uint8_t senderId, uint8_t messageType)
 {
-    DEBUG_PRINTF("[HYDRO] cmd=0x%X from master %u\n", cmd4, senderId);
-    data_recieved = true;
-    if (!hydroMotor)
+#ifndef COM_PROT_LINK_STATS
+    linkCountReceived(sketchLink, length);
+#endif
+    if (messageType != COM_PROT_COMMAND || length < 3)
         return;
 
-    bool wantOn = (cmd4 == CMD_ON);
-    bool wantOff = (cmd4 == CMD_OFF);
-
-    if (!wantOn && !wantOff)
+    if (payload[2] == STARWIRE_CMD_LINK_STATS)
     {
-        DEBUG_PRINTLN("[HYDRO] Unknown cmd, ignored.");
+#ifdef BUS_SERVICE_TASK
+        linkStatsRequested = true; // built in loop(), sent back through outboundQueue
+#else
+        sendLinkStats();
+#endif
         return;
     }
 
-    if (wantOn)
+    uint8_t cmd4 = 0;
+    bool resync = false;
+    if (payload[2] == STARWIRE_CMD_SCENE)
     {
-        hydroMotor->forward(1023); // 100% speed
-        DEBUG_PRINTLN("[HYDRO] Motor ON -> 100%");
+        if (!sceneFind(payload + 3, length - 3, (uint8_t)SLAVE_ID, SLAVE_TYPE, &cmd4))
+            return;
     }
-    else
+    else if (payload[2] == STARWIRE_CMD_FLEET_SYNC)
     {
-        hydroMotor->stop();
-        DEBUG_PRINTLN("[HYDRO] Motor OFF");
+        cmd4 = fleetFind(payload + 3, length - 3, (uint8_t)SLAVE_ID);
+        resync = true;
     }
+
+    if (cmd4 && flashRead(&ACTIONS[cmd4]).kind != ACTION_NONE)
+        dispatchCommand(cmd4, senderId, resync);
 }
 
-static void handleHydroStorage(uint8_t cmd4, uint8_t senderId)
+// ---------- Bus servicing ----------
+#ifdef BUS_SERVICE_TASK
+static TaskHandle_t busServiceHandle = nullptr;
+
+// First edge on the data line while the bus task is blocked: wake it
+static void IRAM_ATTR busLineEdge()
 {
-    data_recieved = true;
-    DEBUG_PRINTF("[HYDRO_STORAGE] cmd=0x%X from master %u\n", cmd4, senderId);
-    if (!hydroStorageLed)
-    {
-        DEBUG_PRINTLN("[HYDRO_STORAGE] LED not initialized");
-        return;
-    }
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(busServiceHandle, &woken);
+    if (woken)
+        portYIELD_FROM_ISR();
+}
 
-    switch (cmd4)
+// SWBB has no receive buffer: a frame that starts while nobody is in
+// slave.update() is lost. Instead of spinning, the task blocks until the
+// data line moves and is back in slave.update() a context switch later,
+// while the frame's sync pad is still on the wire. The edge interrupt is
+// only armed while blocked, so it never disturbs the bit-banged timing.
+// The BUS_SERVICE_IDLE_MS timeout covers heartbeats and queued responses.
+static void busServiceTask(void *)
+{
+    busServiceHandle = xTaskGetCurrentTaskHandle();
+    for (;;)
     {
-    case HYDRO_STORAGE_LEVEL_1: // Green - 100% (Full/Discharging)
-        hydroStorageLed->setColor(0, 255, 0);
-        hydroStorageLed->setBrightness(255);
-        DEBUG_PRINTLN("Hydro Storage: Level 1 -> GREEN (100% - Full/Discharging)");
-        break;
-    case HYDRO_STORAGE_LEVEL_2: // Light Green - 75%
-        hydroStorageLed->setColor(128, 255, 128);
-        hydroStorageLed->setBrightness(192);
-        DEBUG_PRINTLN("Hydro Storage: Level 2 -> LIGHT GREEN (75%)");
-        break;
-    case HYDRO_STORAGE_LEVEL_3: // Orange - 50% (Idle)
-        hydroStorageLed->setColor(255, 140, 0);
-        hydroStorageLed->setBrightness(128);
-        DEBUG_PRINTLN("Hydro Storage: Level 3 -> ORANGE (50% - Idle)");
-        break;
-    case HYDRO_STORAGE_LEVEL_4: // Light Red - 25%
-        hydroStorageLed->setColor(255, 128, 128);
-        hydroStorageLed->setBrightness(96);
-        DEBUG_PRINTLN("Hydro Storage: Level 4 -> LIGHT RED (25%)");
-        break;
-    case HYDRO_STORAGE_LEVEL_5: // Red - 0% (Empty/Charging)
-        hydroStorageLed->setColor(255, 0, 0);
-        hydroStorageLed->setBrightness(64);
-        DEBUG_PRINTLN("Hydro Storage: Level 5 -> RED (0% - Empty/Charging)");
-        break;
-    case CMD_OFF: // Turn off
-        hydroStorageLed->setColor(0, 0, 0);
-        hydroStorageLed->setBrightness(0);
-        DEBUG_PRINTLN("Hydro Storage: OFF");
-        break;
-    default:
-        DEBUG_PRINTF("Hydro Storage: Unknown cmd 0x%X (ignored)\n", cmd4);
-        return;
+        attachInterrupt(digitalPinToInterrupt(DATA_PIN), busLineEdge, CHANGE);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(BUS_SERVICE_IDLE_MS));
+        detachInterrupt(digitalPinToInterrupt(DATA_PIN));
+
+        busStats.serviced(micros());
+        slave.update();
+#ifdef COM_PROT_HEARTBEAT_SCHEDULE
+        if (heartbeatActivityPending)
+        {
+            heartbeatActivityPending = false;
+            slave.heartbeatActivity();
+        }
+#endif
+        OutboundFrame frame;
+        while (outboundQueue.pop(frame))
+            transmitResponse(frame.command, frame.data, frame.length);
     }
-    hydroStorageLed->show();
 }
 
-static void handleWind(uint8_t cmd4, uint8_t senderId)
+static void startBusService()
 {
-    DEBUG_PRINTF("[WIND] cmd=0x%X from master %u\n", cmd4, senderId);
-    data_recieved = true;
-    if (!windMotor)
-        return;
-
-    bool wantOn = (cmd4 == CMD_ON);
-    bool wantOff = (cmd4 == CMD_OFF);
-
-    if (!wantOn && !wantOff)
-    {
-        DEBUG_PRINTLN("[WIND] Unknown cmd, ignored.");
-        return;
-    }
+    xTaskCreatePinnedToCore(busServiceTask, "starwire", 4096, nullptr, BUS_SERVICE_PRIORITY, nullptr, BUS_SERVICE_CORE);
+}
+#endif
 
-    if (wantOn)
+// Applies what the bus side queued; a no-op when loop() services the bus itself.
+static void drainCommands()
+{
+#ifdef BUS_SERVICE_TASK
+    QueuedCommand queued;
+    while (commandQueue.pop(queued))
     {
-        windMotor->forward(150); // 70 power level as specified
-        DEBUG_PRINTLN("[WIND] Motor ON -> 70 power level");
+        applyCommand(queued.cmd4, queued.senderId, queued.resync);
+        busStats.applied(queued.receivedUs, micros());
     }
-    else
+    if (linkStatsRequested)
     {
-        windMotor->stop();
-        DEBUG_PRINTLN("[WIND] Motor OFF");
+        linkStatsRequested = false;
+        sendLinkStats();
     }
+#endif
+}
+
+// Polls the bus from loop(). Without BUS_SERVICE_TASK loop() calls this
+// between its slow steps (strip refresh, ADC, logging), so the longest gap
+// is one step rather than the whole pass; busStats records the gaps.
+static void serviceBus()
+{
+#ifndef BUS_SERVICE_TASK
+    busStats.serviced(micros());
+    slave.update();
+#endif
 }
 
 // ---------- Setup ----------
@@ -377,77 +567,60 @@ void setup()
     }
 #endif
 
-    // Register handlers (4-bit, no payload)
-#if SLAVE_TYPE == TYPE_BATTERY
-    slave.setCommandHandler(BAT_IDLE, handleBattery);
-    slave.setCommandHandler(BAT_CHARGING, handleBattery);
-    slave.setCommandHandler(BAT_DISCHARGE, handleBattery);
-#elif SLAVE_TYPE == TYPE_PHOTOVOLTAIC
-    slave.setCommandHandler(CMD_ON, handlePhotovoltaic);
-    slave.setCommandHandler(CMD_OFF, handlePhotovoltaic);
-    slave.setCommandHandler(BAT_IDLE, handlePhotovoltaic);
-#elif SLAVE_TYPE == TYPE_GAS
-    slave.setCommandHandler(GAS_LEVEL_1, handleGas);
-    slave.setCommandHandler(GAS_LEVEL_2, handleGas);
-    slave.setCommandHandler(GAS_LEVEL_3, handleGas);
-    slave.setCommandHandler(GAS_LEVEL_4, handleGas);
-    slave.setCommandHandler(GAS_LEVEL_5, handleGas);
-    slave.setCommandHandler(GAS_LEVEL_6, handleGas);
-    slave.setCommandHandler(GAS_LEVEL_7, handleGas);
-    slave.setCommandHandler(GAS_LEVEL_8, handleGas);
-    slave.setCommandHandler(GAS_LEVEL_9, handleGas);
-    slave.setCommandHandler(GAS_LEVEL_10, handleGas);
-    slave.setCommandHandler(CMD_OFF, handleGas);
-#elif SLAVE_TYPE == TYPE_HYDRO
-    slave.setCommandHandler(CMD_ON, handleHydro);
-    slave.setCommandHandler(CMD_OFF, handleHydro);
-#elif SLAVE_TYPE == TYPE_HYDRO_STORAGE
-    slave.setCommandHandler(HYDRO_STORAGE_LEVEL_1, handleHydroStorage);
-    slave.setCommandHandler(HYDRO_STORAGE_LEVEL_2, handleHydroStorage);
-    slave.setCommandHandler(HYDRO_STORAGE_LEVEL_3, handleHydroStorage);
-    slave.setCommandHandler(HYDRO_STORAGE_LEVEL_4, handleHydroStorage);
-    slave.setCommandHandler(HYDRO_STORAGE_LEVEL_5, handleHydroStorage);
-    slave.setCommandHandler(CMD_OFF, handleHydroStorage);
-#elif SLAVE_TYPE == TYPE_WIND
-    slave.setCommandHandler(CMD_ON, handleWind);
-    slave.setCommandHandler(CMD_OFF, handleWind);
+    // Register handlers (4-bit, no payload) for every command this type acts on
+    for (uint8_t cmd = 0; cmd < PLANT_COMMAND_COUNT; cmd++)
+    {
+        if (flashRead(&ACTIONS[cmd]).kind != ACTION_NONE)
+            slave.setCommandHandler(cmd, handleCommand);
+    }
+
+    slave.setDebugReceiveHandler(handleFrame);
+#ifdef COM_PROT_HEARTBEAT_EXTENSION
+    slave.setHeartbeatExtension(heartbeatTelemetry);
+#endif
+#ifdef COM_PROT_HEARTBEAT_SCHEDULE
+    HeartbeatSchedule schedule;
+    schedule.intervalMs = HEARTBEAT_INTERVAL_MS;
+    schedule.idleIntervalMs = HEARTBEAT_IDLE_INTERVAL_MS;
+    schedule.idleAfterMs = HEARTBEAT_IDLE_AFTER_MS;
+    schedule.jitterPercent = HEARTBEAT_JITTER_PERCENT;
+    slave.setHeartbeatSchedule(schedule);
 #else
-    // All other powerplant types use the same ON/OFF commands
-    slave.setCommandHandler(CMD_ON, handleMisty);
-    slave.setCommandHandler(CMD_OFF, handleMisty);
+    // com-prot beats every 1 s on its own from begin(); start it at the
+    // SLAVE_ID phase so slaves powered up together do not beat in lockstep
+    HeartbeatScheduler phase(SLAVE_ID);
+    phase.begin(0);
+    delay(phase.nextMs());
 #endif
 
     slave.begin();
+#ifdef BUS_SERVICE_TASK
+    startBusService();
+    DEBUG_PRINTF("Bus serviced by a task on core %u\n", (unsigned)BUS_SERVICE_CORE);
+#endif
 
     DEBUG_PRINTF("Slave ready: ID=%u, Type=%u\n", SLAVE_ID, SLAVE_TYPE);
 
 #if SLAVE_TYPE == TYPE_BATTERY
     batteryLed = factory.createRGBLED(D2, 1);
-    batteryLed->setBrightness(64);
-    batteryLed->setColor(255, 140, 0);
-    batteryLed->show();
+    initCommandLed(batteryLed, ledOutput({255, 140, 0}, 64)); // Idle
 #elif SLAVE_TYPE == TYPE_PHOTOVOLTAIC
     solarLed = factory.createRGBLED(D2, 1);
-    solarLed->setBrightness(32); // Start with low brightness
-    solarLed->setColor(0, 255, 0); // Default green
-    solarLed->show();
+    showLed(solarLed, ledOutput({0, 255, 0}, 32)); // Default green, low brightness
     pinMode(SOLAR_PIN, INPUT);
     DEBUG_PRINTLN("Solar panel initialized on A0, LED on D2");
 #elif SLAVE_TYPE == TYPE_GAS
     gasLed = factory.createRGBLED(D2, 1);
-    gasLed->setBrightness(255);
-    gasLed->setColor(255, 0, 0); // Start at Level 1 color
-    gasLed->show();
-    DEBUG_PRINTLN("Gas powerplant LED initialized on D2 (10-level mode)");
+    initCommandLed(gasLed, ledOutput(GAS_GRADIENT[0])); // Start at Level 1 color
+    DEBUG_PRINTF("Gas powerplant LED initialized on D2 (%u-level mode)\n", GAS_LEVEL_COUNT);
 #elif SLAVE_TYPE == TYPE_HYDRO
     hydroMotor = factory.createMotor(D5, D6, 1000); // Motor on D5, 1kHz PWM
     hydroMotor->stop(); // Start with motor off
+    commandMotor = hydroMotor;
     DEBUG_PRINTLN("Hydro motor initialized on D5");
 #elif SLAVE_TYPE == TYPE_HYDRO_STORAGE
     hydroStorageLed = factory.createRGBLED(D2, 1);
-    hydroStorageLed->setBrightness(128);
-    hydroStorageLed->setColor(255, 140, 0); // Start with orange (50% - Idle)
-    hydroStorageLed->show();
+    initCommandLed(hydroStorageLed, ledOutput({255, 140, 0}, 128)); // Start with orange (50% - Idle)
     DEBUG_PRINTLN("Hydro Storage LED initialized on D2");
 #elif SLAVE_TYPE == TYPE_WIND
     windMotor = factory.createMotor(D5, D6, 20000); // Motor on D5, 20kHz PWM as specified
@@ -455,75 +628,68 @@ void setup()
    // windMotor->setSpeedupConfig(2.5f, 1000); // 2.5x multiplier, 1000ms duration
 
     windMotor->stop(); // Start with motor off
+    commandMotor = windMotor;
 
     DEBUG_PRINTLN("Wind motor initialized on D5 with speedup enabled");
 #else
     // All other powerplant types use atomizer
     atomizer = factory.createAtomizer(D2);
 #endif
+
+    if (commandLed || commandMotor)
+        factory.createPeriodic(FADE_PERIOD_MS, animateOutputs);
+#ifndef COM_PROT_HEARTBEAT_EXTENSION
+    factory.createPeriodic(TELEMETRY_INTERVAL_MS, sendTelemetry);
+#endif
+    lastLoopUs = micros();
 }
 
 // ---------- Loop ----------
 void loop()
 {
+    uint32_t loopUs = micros();
+    loopTime.add(loopUs - lastLoopUs);
+    lastLoopUs = loopUs;
+
+    drainCommands();
     factory.update();
+    serviceBus();
 
 #if SLAVE_TYPE == TYPE_PHOTOVOLTAIC
-    // Update solar panel brightness based on A0 reading
-    if (millis() - lastSolarUpdate >= SOLAR_UPDATE_INTERVAL)
+    // Update solar panel brightness based on the filtered A0 reading
+    if (millis() - lastSolarSample >= SOLAR_SAMPLE_MS)
     {
-        lastSolarUpdate = millis();
+        lastSolarSample = millis();
         
         int analogValue = analogRead(SOLAR_PIN);
-        float voltage = (analogValue / 1024.0) * 3.3; // Convert to voltage (0-3.3V)
-        
-        // Map analog value to brightness (minimum 16, maximum 255)
-        uint8_t brightness = map(analogValue, 0, 1024, 16, 255);
-        
-        uint8_t red = 0, green = 0, blue = 0;
-        
-        switch (solarMode)
+        if (analogValue > 1024)
+            analogValue = 1024;
+
+        // A new filtered value per 2^SOLAR_OVERSAMPLE_SHIFT readings; mode changes show with it
+        if (solarFilter.add(analogValue))
         {
-        case 0: // Idle mode (green) - shifts to orange when A0 is low
-            {
-                // Green (0,255,0) to Orange (255,165,0)
-                // Map analogValue: 1024 = pure green, 0 = orange
-                uint8_t lightLevel = map(analogValue, 0, 1024, 0, 255);
-                red = 255 - lightLevel; // More red when light is low
-                green = 255; // Always full green
-                blue = 0;
-            }
-            break;
-            
-        case 1: // Half power mode (orange) - shifts to red when A0 is low
-            {
-                // Orange (255,165,0) to Red (255,0,0)
-                // Map analogValue: 1024 = orange, 0 = red
-                uint8_t lightLevel = map(analogValue, 0, 1024, 0, 165);
-                red = 255; // Always full red
-                green = lightLevel; // Less green when light is low
-                blue = 0;
-            }
-            break;
-            
-        case 2: // Night mode (red) - no reaction to light
-            red = 255;
-            green = 0;
-            blue = 0;
-            // For night mode, use fixed low brightness regardless of A0
-            brightness = 32;
-            break;
+            solarLight.update(solarFilter.value()); // ignores what noise is left around a LUT step
+
+            // Idle and half power follow the light through SOLAR_LUTS (colour and
+            // brightness precomputed per A0 step), night mode ignores it
+            LedColor color = solarMode < 2 ? flashRead(&SOLAR_LUTS[solarMode].colors[solarLight.value() >> SOLAR_LUT_SHIFT])
+                                           : SOLAR_NIGHT;
+            if (showIfChanged(solarLed, color.red, color.green, color.blue))
+                LOG_EVENT(STARWIRE_LOG_DEBUG, EV_SOLAR, solarLight.value(), solarMode,
+                          ((uint32_t)color.red << 16) | ((uint32_t)color.green << 8) | color.blue);
         }
-        
-        solarLed->setColor(red, green, blue);
-        solarLed->setBrightness(brightness);
-        solarLed->show();
-        
-        DEBUG_PRINTF("[SOLAR] A0=%d, V=%.2fV, Bright=%d, Mode=%d, RGB=(%d,%d,%d)\n", 
-                    analogValue, voltage, brightness, solarMode, red, green, blue);
     }
+    serviceBus();
 #endif
 
+    static unsigned long lastLedReport = 0;
+    if (millis() - lastLedReport >= LED_REPORT_INTERVAL)
+    {
+        LOG_EVENT(STARWIRE_LOG_INFO, EV_LED_REFRESH, ledShadow.pushed(), ledShadow.skipped());
+        ledShadow.resetCounters();
+        lastLedReport = millis();
+    }
+
 #ifdef OTA_MODE_ENABLED
     if (otaMode)
         handleOTA();
@@ -532,13 +698,19 @@ void loop()
 static long startTime = millis();
 if (millis() - startTime > 1000)
 {
-    DEBUG_PRINTF("Looping... (uptime: %ld seconds) data_received: %s\n", (millis() / 1000), data_recieved ? "true" : "false");
+    LOG_EVENT(STARWIRE_LOG_INFO, EV_ALIVE, millis() / 1000, data_recieved, binlog.dropped());
     DEBUG_WEB_PRINTF("Looping... (uptime: %ld seconds) data_received: %s\n", (millis() / 1000), data_recieved ? "true" : "false");
     startTime = millis();
+    // Gap/late budgets are BUS_SERVICE_GAP_BUDGET_US/BUS_SERVICE_LATE_BUDGET_US
+    LOG_EVENT(STARWIRE_LOG_INFO, EV_BUS_POLLS, busStats.services(), busStats.gaps(), busStats.maxGapUs());
+#ifdef BUS_SERVICE_TASK
+    LOG_EVENT(STARWIRE_LOG_INFO, EV_BUS_QUEUE, busStats.late(), busStats.applied(), busStats.maxLatencyUs(),
+              commandQueue.dropped());
+#endif
     if(windMotor)
     {
         // is speedup active
-        DEBUG_PRINTF("Wind motor speedup active: %s\n", windMotor->isSpeedupActive() ? "true" : "false");
+        LOG_EVENT(STARWIRE_LOG_DEBUG, EV_WIND_SPEEDUP, windMotor->isSpeedupActive());
     }
 
 
@@ -546,5 +718,9 @@ if (millis() - startTime > 1000)
 #endif
 
      
-    slave.update();
+    serviceBus();
+
+    // Only what fits in the UART FIFO right now; the rest waits in the ring
+    if (starwireLogEnabled(STARWIRE_LOG_ERROR))
+        binlog.drain(Serial);
 }
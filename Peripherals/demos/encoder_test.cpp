@@ -18,9 +18,12 @@
 #define OLED_RESET_PIN -1
 #define I2C_ADDRESS 0x3C
 
-#define ENCODER_PIN_A  D0 
-#define ENCODER_PIN_B  D5 
-#define ENCODER_PIN_SW D7
+// A and B need pin interrupts, which D0 (GPIO16) lacks. The button is only
+// read from the loop, so it takes D3 (GPIO0, pulled up on the board; only
+// held down through a reset does it select the flash mode).
+#define ENCODER_PIN_A  D7
+#define ENCODER_PIN_B  D5
+#define ENCODER_PIN_SW D3
 
 // MAX7219 Seven Segment Display Definitions (if used)
 // #define MAX7219_DATA_PIN D1
@@ -1,5 +1,6 @@
 #include <Arduino.h>
 #include "PeripheralFactory.h"
+#include "segment_format.h"
 
 #define LATCH_PIN D1
 #define DATA_PIN  D2
@@ -47,17 +48,36 @@ void toggleReverse() {
 	Serial.println(reversed ? F("Bargraph reversed") : F("Bargraph normal"));
 }
 
+// Seconds in fixed point straight from millis(), no soft-float on the ESP8266.
+// Rounded to the shown decimal like printf (negative values too), the
+// arithmetic BusSimulator --bench segment times. The time wraps after
+// 10000 s before anything is multiplied, so the largest product (x6) stays
+// below 6e7 and nothing overflows however long the demo runs.
 void updateDisplays() {
-	float timesec = (float)millis()/1000;
-	display1->displayNumber(timesec, 1);
-	display2->displayNumber((float)1000 - timesec, 1);
-	display3->displayNumber((float)timesec * 2, 1);
-	display4->displayNumber((float)timesec * 3, 1);
-	display5->displayNumber((float)timesec * 4, 1);
-	display6->displayNumber((float)timesec * 5, 1);
-	display7->displayNumber((float)timesec * 6, 1);
-	ldisplay1->displayNumber((float)timesec, 4);
-	ldisplay2->displayNumber((float)(1000 - timesec), 4);
+	int32_t wrapped = millis() % 10000000;
+	display1->displayFixed(segment::divideRounded(wrapped, 100), 1);
+	display2->displayFixed(segment::divideRounded(1000000 - wrapped, 100), 1);
+	display3->displayFixed(segment::divideRounded(wrapped * 2, 100), 1);
+	display4->displayFixed(segment::divideRounded(wrapped * 3, 100), 1);
+	display5->displayFixed(segment::divideRounded(wrapped * 4, 100), 1);
+	display6->displayFixed(segment::divideRounded(wrapped * 5, 100), 1);
+	display7->displayFixed(segment::divideRounded(wrapped * 6, 100), 1);
+	ldisplay1->displayFixed(wrapped * 10, 4);
+	ldisplay2->displayFixed(10000000 - wrapped * 10, 4);
+}
+
+// What the unchanged-frame skip really saves here: nothing. Every display
+// moves to its next digit on each pass, so no two frames are equal; a host
+// replay of this demo at 0.5..2 ms per loop sends 16..64 kB/s and saves
+// 0 B/s. Only chains that hold still (bargraphs, blank displays) gain.
+void reportShiftSavings() {
+	static uint32_t lastPushed = 0;
+	static uint32_t lastSkipped = 0;
+	Serial.printf("Shift chain: %lu B/s sent, %lu B/s saved\n",
+		(unsigned long)(shiftChain->bytesPushed() - lastPushed),
+		(unsigned long)(shiftChain->bytesSkipped() - lastSkipped));
+	lastPushed = shiftChain->bytesPushed();
+	lastSkipped = shiftChain->bytesSkipped();
 }
 
 void setup() {
@@ -84,9 +104,20 @@ void setup() {
 
 	reversed = false;
 
-	factory.createPeriodic(10, updateDisplays);
-	factory.createPeriodic(10, updateBargraphs);
-	factory.createPeriodic(11000, toggleReverse);
+	factory.createPeriodic(10, updateDisplays)->setName("displays");
+	factory.createPeriodic(10, updateBargraphs)->setName("bargraphs");
+	factory.createPeriodic(11000, toggleReverse)->setName("reverse");
+	factory.createPeriodic(1000, reportShiftSavings)->setName("savings");
+
+#ifdef PERIPHERAL_PROFILING
+	factory.setProfileLabel(shiftChain, "chain");
+	factory.createPeriodic(5000, []() {
+		factory.profiler().report(Serial);
+		factory.profiler().reset();
+		factory.scheduler().report(Serial);
+		factory.scheduler().resetStats();
+	});
+#endif
 }
 
 void loop() {
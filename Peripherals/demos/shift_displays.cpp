@@ -49,6 +49,7 @@ void setup() {
 	Serial.println(WiFi.localIP());
 }
 
+// Blanks whenever the loop does anything else; see shift_displays_mux.cpp for the timer-driven version
 void displayNumber(int number) {
 	// Break number into digits
 	byte digits[4];
@@ -0,0 +1,25 @@
+#include <Arduino.h>
+#include "segment_multiplexer.h"
+
+// Same wiring as shift_displays.cpp
+#define LATCH_PIN D1 // RCLK (latch)
+#define DATA_PIN  D2 // SER (data)
+#define CLOCK_PIN D0 // SRCLK (clock)
+
+SegmentMultiplexer display(LATCH_PIN, DATA_PIN, CLOCK_PIN, 8);
+
+void setup() {
+	Serial.begin(115200);
+
+	if (!display.begin(125)) {
+		Serial.println(F("Multiplexer timer not available"));
+	}
+}
+
+void loop() {
+	// Seconds with 2 decimals; the timer keeps the display lit while the loop is busy
+	display.displayFixed(millis() / 10, 2);
+	display.show();
+
+	delay(50); // stands in for bus, encoder and OLED work
+}
@@ -11,29 +11,18 @@ ShiftRegisterChain* shiftChain = factory.createShiftRegisterChain(LATCH_PIN, DAT
 Bargraph* bargraph1 = factory.createBargraph(shiftChain, 10);
 SegmentDisplay* display1 = factory.createSegmentDisplay(shiftChain, 4);
 
-unsigned long lastUpdateTime = 0;
-
 bool reversed;
 void setup() {
 	Serial.begin(115200);
-	
-	factory.init();
 
 	reversed = false;
-}
-
-
-void loop() {
-	factory.update();
-	
-	if(millis() % 100 == 0) {
-		float timesec = (float)millis()/1000;
 
-		display1->displayNumber(timesec, 1);
-	}
-	
-	if(millis() % 1000 == 0) {
+	// Scheduled tasks instead of millis() % 100 == 0, which misses every tick the loop does not hit exactly
+	factory.createPeriodic(100, []() {
+		display1->displayFixed(millis() / 100, 1);
+	});
 
+	factory.createPeriodic(1000, []() {
 		bargraph1->setValue((millis() / 1000) % 11);
 
 		if ((millis() / 1000) % 11 == 0) {
@@ -41,6 +30,10 @@ void loop() {
 			bargraph1->setReversed(reversed);
 			Serial.println(reversed ? F("Bargraph reversed") : F("Bargraph normal"));
 		}
-	}
+	});
+}
+
 
+void loop() {
+	factory.update();
 }
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include <Arduino.h>
+#include "PeripheralFactory.h"
+
+// Hardware SPI needs the HSPI pins on the ESP8266; the bit-banged
+// chain runs on the same wires first, so one chain serves both.
+#define LATCH_PIN D1
+#define DATA_PIN  D7 // HSPI MOSI
+#define CLOCK_PIN D5 // HSPI SCLK
+
+#define SPI_CLOCK_HZ 4000000
+#define REFRESHES    200
+#define MAX_BARGRAPHS 16 // 2 registers each, 32 like multiple_chain_devices.cpp
+
+PeripheralFactory factory;
+Bargraph* bargraphs[MAX_BARGRAPHS];
+
+// Average time of one refresh in us, growing the chain two registers at a time
+void measure(ShiftRegisterChain* chain, unsigned long* results) {
+	for (int i = 0; i < MAX_BARGRAPHS; i++) {
+		chain->addDevice(bargraphs[i]);
+
+		unsigned long start = micros();
+		for (int n = 0; n < REFRESHES; n++) {
+			// A changed frame each time, or the chain skips the push
+			bargraphs[0]->setValue(n & 1 ? 16 : 0);
+			chain->update();
+		}
+		results[i] = (micros() - start) / REFRESHES;
+		yield();
+	}
+}
+
+void setup() {
+	Serial.begin(115200);
+	delay(500);
+
+	for (int i = 0; i < MAX_BARGRAPHS; i++) {
+		bargraphs[i] = new Bargraph(16);
+		bargraphs[i]->setValue(i + 1);
+	}
+
+	unsigned long bitBang[MAX_BARGRAPHS];
+	unsigned long spi[MAX_BARGRAPHS];
+	measure(factory.createShiftRegisterChain(LATCH_PIN, DATA_PIN, CLOCK_PIN), bitBang);
+	measure(factory.createShiftRegisterChain(LATCH_PIN, DATA_PIN, CLOCK_PIN, SPI_CLOCK_HZ), spi);
+
+	Serial.println(F("registers  shiftOut us  SPI us"));
+	for (int i = 0; i < MAX_BARGRAPHS; i++) {
+		Serial.printf("%9d  %11lu  %6lu\n", (i + 1) * 2, bitBang[i], spi[i]);
+	}
+}
+
+void loop() {
+}
@@ -0,0 +1,150 @@
+#include "encoder.h"
+
+// Index: old AB << 2 | new AB. One Gray code step is +-1; no change,
+// and both pins changing at once (a missed edge or a bounce), are 0.
+static const int8_t QUADRATURE_TABLE[16] = {
+	 0, -1,  1,  0,
+	 1,  0,  0, -1,
+	-1,  0,  0,  1,
+	 0,  1, -1,  0
+};
+
+Encoder::Encoder(uint8_t pinA, uint8_t pinB, uint8_t pinSW, int16_t minVal, int16_t maxVal, int16_t steps_per_click,
+	bool enable_speedup, unsigned int speedup_increment, unsigned int speedup_interval) : 
+	_pinA(pinA),
+	_pinB(pinB),
+	_pinSW(pinSW),
+	_minVal(minVal), 
+	_maxVal(maxVal),
+	_stepsPerClick(steps_per_click > 0 ? steps_per_click : 1),
+	_speedup(enable_speedup),
+	_speedupIncrement(speedup_increment),
+	_speedupIntervalUs(speedup_interval * 1000UL),
+	_interrupts(false),
+	_pollingReported(false),
+	_steps(0),
+	_enabled(true),
+	_transitions(0),
+	_lastDetentUs(0),
+	_consumed(0),
+	_value(minVal)
+{
+	pinMode(_pinA, INPUT_PULLUP);
+	pinMode(_pinB, INPUT_PULLUP);
+	if (_pinSW != 255) {
+		pinMode(_pinSW, INPUT_PULLUP);
+	}
+	_state = (digitalRead(_pinA) << 1) | digitalRead(_pinB);
+
+	// Both pins or neither: a polled pin must not race the ISR over _state
+	if (digitalPinToInterrupt(_pinA) != NOT_AN_INTERRUPT && digitalPinToInterrupt(_pinB) != NOT_AN_INTERRUPT) {
+		attachInterruptArg(digitalPinToInterrupt(_pinA), onEdge, this, CHANGE);
+		attachInterruptArg(digitalPinToInterrupt(_pinB), onEdge, this, CHANGE);
+		_interrupts = true;
+	}
+}
+
+Encoder::~Encoder() {
+	if (_interrupts) {
+		detachInterrupt(digitalPinToInterrupt(_pinA));
+		detachInterrupt(digitalPinToInterrupt(_pinB));
+	}
+}
+
+void IRAM_ATTR Encoder::onEdge(void* arg) {
+	static_cast<Encoder*>(arg)->decode();
+}
+
+void IRAM_ATTR Encoder::decode() {
+	uint8_t state = (digitalRead(_pinA) << 1) | digitalRead(_pinB);
+	int8_t direction = QUADRATURE_TABLE[(_state << 2) | state];
+	_state = state;
+	if (direction == 0) {
+		return;
+	}
+
+	// A reversal mid-detent cancels out instead of counting twice
+	_transitions += direction;
+	if (_transitions > -_stepsPerClick && _transitions < _stepsPerClick) {
+		return;
+	}
+	_transitions = 0;
+
+	uint32_t now = micros();
+	uint32_t amount = 1;
+	if (_speedup && now - _lastDetentUs < _speedupIntervalUs) {
+		amount = _speedupIncrement;
+	}
+	_lastDetentUs = now;
+
+	if (_enabled) {
+		// Single writer, one aligned 32-bit store: the loop never sees half of it
+		_steps = _steps + (direction > 0 ? amount : (uint32_t)-amount);
+	}
+}
+
+void Encoder::update() {
+	if (!_interrupts) {
+		// Not from the constructor: encoders are often built before Serial.begin()
+		if (!_pollingReported) {
+			Serial.println(F("Encoder: pin A or B has no interrupt, polling from update()"));
+			_pollingReported = true;
+		}
+		decode();
+	}
+}
+
+int16_t Encoder::clamp(int32_t value) const {
+	if (value < _minVal) {
+		return _minVal;
+	}
+	if (value > _maxVal) {
+		return _maxVal;
+	}
+	return (int16_t)value;
+}
+
+int16_t Encoder::getValue() {
+	uint32_t steps = _steps;
+	int32_t delta = (int32_t)(steps - _consumed);
+	_consumed = steps;
+	_value = clamp((int32_t)_value + delta);
+	return _value;
+}
+
+void Encoder::setValue(int16_t value) {
+	// Steps already counted belong to the old value
+	_consumed = _steps;
+	_value = clamp(value);
+}
+
+bool Encoder::isButtonPressed() {
+	return _pinSW != 255 && digitalRead(_pinSW) == LOW;
+}
+
+void Encoder::setRange(int16_t minVal, int16_t maxVal) {
+	_minVal = minVal;
+	_maxVal = maxVal;
+	_value = clamp(_value);
+}
+
+int16_t Encoder::getUpperBound() {
+	return _maxVal;
+}
+
+int16_t Encoder::getLowerBound() {
+	return _minVal;
+}
+
+int16_t Encoder::getStepsPerClick() {
+	return _stepsPerClick;
+}
+
+void Encoder::enable() {
+	_consumed = _steps;
+	_enabled = true;
+}
+
+void Encoder::disable() {
+	_enabled = false;
+}
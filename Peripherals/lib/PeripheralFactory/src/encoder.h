@@ -0,0 +1,79 @@
+#ifndef ENCODER_H
+#define ENCODER_H
+
+#include "Peripheral.h"
+#include <Arduino.h>
+
+/**
+ * @brief Quadrature rotary encoder with push button, decoded in pin-change interrupts.
+ *
+ * Every edge on A or B runs a 16-entry state table (old AB, new AB) that
+ * rejects bounces and invalid jumps; stepsPerClick valid transitions make
+ * one detent. The ISR is the only writer of a free-running step counter,
+ * the loop only reads it and keeps its own position, so no lock is needed
+ * and no step is lost however long the loop takes. With speedup enabled a
+ * detent that follows the previous one within speedupInterval ms counts
+ * speedupIncrement steps, timed from the ISR.
+ *
+ * Pins without an interrupt (GPIO16/D0 on the ESP8266) fall back to
+ * decoding from update(), with the same table; steps that come faster than
+ * the loop polls are lost, so the first update() prints a warning.
+ */
+class Encoder : public Peripheral {
+public:
+    Encoder(uint8_t pinA, uint8_t pinB, uint8_t pinSW, int16_t minVal = 0, int16_t maxVal = 100, int16_t steps_per_click = 1,
+    bool enable_speedup = false, unsigned int speedup_increment = 5, unsigned int speedup_interval = 75);
+    ~Encoder();
+    
+    void update() override;
+
+    int16_t getValue();
+    void setValue(int16_t value);
+    bool isButtonPressed();
+    void setRange(int16_t minVal, int16_t maxVal);
+	void enable();
+	void disable();
+    int16_t getUpperBound();
+    int16_t getLowerBound();
+    int16_t getStepsPerClick();
+
+    /**
+     * @brief Free-running signed step count since boot (wraps); diff two
+     * readings for a delta without going through getValue()'s range.
+     */
+    uint32_t getSteps() const { return _steps; }
+
+    /**
+     * @brief True if the pins are decoded in interrupts, false if polled from update().
+     */
+    bool usesInterrupts() const { return _interrupts; }
+    
+private:
+    static void IRAM_ATTR onEdge(void* arg);
+    void IRAM_ATTR decode();
+    int16_t clamp(int32_t value) const;
+
+    uint8_t _pinA;
+    uint8_t _pinB;
+    uint8_t _pinSW;
+    int16_t _minVal;
+    int16_t _maxVal;
+    int16_t _stepsPerClick;
+    bool _speedup;
+    uint16_t _speedupIncrement;
+    uint32_t _speedupIntervalUs;
+    bool _interrupts;
+    bool _pollingReported;   // warning printed once
+
+    // Written by the ISR only
+    volatile uint32_t _steps;
+    volatile bool _enabled;
+    uint8_t _state;          // last AB
+    int8_t _transitions;     // towards the next detent
+    uint32_t _lastDetentUs;
+
+    // Loop side
+    uint32_t _consumed;      // _steps already applied to _value
+    int16_t _value;
+};
+#endif
@@ -0,0 +1,76 @@
+#include "periodic.h"
+#include <Arduino.h>
+
+Periodic::Periodic(unsigned long interval, std::function<void()> callback, Policy policy) {
+	this->interval = interval;
+	this->callback = callback;
+	this->policy = policy;
+	this->name = nullptr;
+	this->lastRun = millis();
+	this->nextRun = this->lastRun; // first run right away, like before the scheduler
+	resetStats();
+}
+
+void Periodic::setInterval(unsigned long interval) {
+	this->interval = interval;
+}
+
+void Periodic::setCallback(std::function<void()> callback) {
+	this->callback = callback;
+}
+
+void Periodic::setPolicy(Policy policy) {
+	this->policy = policy;
+}
+
+void Periodic::setName(const char* name) {
+	this->name = name;
+}
+
+void Periodic::resetStats() {
+	runs = 0;
+	skipped = 0;
+	lateMaxMs = 0;
+	lateTotalMs = 0;
+	durationMaxUs = 0;
+	durationTotalUs = 0;
+}
+
+void Periodic::update() {
+	unsigned long now = millis();
+	if (due(now)) {
+		run(now);
+	}
+}
+
+void Periodic::run(unsigned long now) {
+	uint32_t late = now - nextRun;
+	if (late > lateMaxMs) {
+		lateMaxMs = late;
+	}
+	lateTotalMs += late;
+	runs++;
+
+	unsigned long start = micros();
+	if (callback) {
+		callback();
+	}
+	uint32_t duration = micros() - start;
+	if (duration > durationMaxUs) {
+		durationMaxUs = duration;
+	}
+	durationTotalUs += duration;
+
+	lastRun = now;
+	if (interval == 0) {
+		nextRun = now; // every pass, there is no deadline to miss
+		return;
+	}
+	nextRun += interval;
+	if (policy == Policy::Skip && due(now)) {
+		// Next deadline on the grid that is still ahead
+		unsigned long missed = (now - nextRun) / interval + 1;
+		skipped += missed;
+		nextRun += missed * interval;
+	}
+}
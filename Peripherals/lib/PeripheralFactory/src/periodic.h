@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Peripheral.h"
+#include <functional>
+#include <stdint.h>
+
+/**
+ * @brief Calls a function every interval milliseconds.
+ *
+ * The first run is due at creation. Deadlines stay on the grid of the
+ * first one (next = previous deadline + interval), so a late run does not
+ * push the later ones back. An interval of 0 runs on every pass. Created by
+ * PeripheralFactory::createPeriodic() it is run from the factory's
+ * PeriodicScheduler; update() runs it standalone.
+ */
+class Periodic : public Peripheral {
+	public:
+		/**
+		 * @brief What a run that comes one or more whole intervals late does with the missed deadlines.
+		 */
+		enum class Policy : uint8_t {
+			Skip,   // drop them, run once and wait for the next deadline still ahead
+			CatchUp // run once for each of them, back to back
+		};
+
+	private:
+		unsigned long interval;
+		unsigned long lastRun;
+		unsigned long nextRun;
+		std::function<void()> callback;
+		Policy policy;
+		const char* name;
+
+		uint32_t runs;
+		uint32_t skipped;
+		uint32_t lateMaxMs;
+		uint64_t lateTotalMs;
+		uint32_t durationMaxUs;
+		uint64_t durationTotalUs;
+
+	public:
+		Periodic(unsigned long interval, std::function<void()> callback, Policy policy = Policy::Skip);
+		/**
+		 * @brief Takes effect after the next run, the deadline already set stays.
+		 */
+		void setInterval(unsigned long interval);
+		void setCallback(std::function<void()> callback);
+		void setPolicy(Policy policy);
+		/**
+		 * @brief Names the task in the scheduler report; not copied.
+		 */
+		void setName(const char* name);
+		void update() override;
+
+		bool due(unsigned long now) const { return (long)(now - nextRun) >= 0; }
+		unsigned long getNextRun() const { return nextRun; }
+
+		/**
+		 * @brief Calls the callback for the deadline that is due and sets the next one.
+		 */
+		void run(unsigned long now);
+
+		// --- Timing since the last resetStats() ---
+		const char* getName() const { return name; }
+		uint32_t getRuns() const { return runs; }
+		uint32_t getSkipped() const { return skipped; }
+		uint32_t getLateMaxMs() const { return lateMaxMs; }
+		uint64_t getLateTotalMs() const { return lateTotalMs; }
+		uint32_t getDurationMaxUs() const { return durationMaxUs; }
+		uint64_t getDurationTotalUs() const { return durationTotalUs; }
+		void resetStats();
+};
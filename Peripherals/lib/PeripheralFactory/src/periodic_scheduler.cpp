@@ -0,0 +1,79 @@
+#include "periodic_scheduler.h"
+#include <algorithm>
+
+PeriodicScheduler::~PeriodicScheduler() {
+	for (Periodic* task : _tasks) {
+		delete task;
+	}
+}
+
+// Wrap-safe: deadlines are never 24 days apart
+bool PeriodicScheduler::later(const Periodic* a, const Periodic* b) {
+	return (long)(a->getNextRun() - b->getNextRun()) > 0;
+}
+
+void PeriodicScheduler::add(Periodic* task) {
+	_tasks.push_back(task);
+	_heap.push_back(task);
+	std::push_heap(_heap.begin(), _heap.end(), later);
+}
+
+void PeriodicScheduler::run(unsigned long now) {
+	// A running task is out of the heap, so its callback may add() others
+	while (due(now)) {
+		std::pop_heap(_heap.begin(), _heap.end(), later);
+		Periodic* task = _heap.back();
+		_heap.pop_back();
+		task->run(now);
+		_ran.push_back(task);
+	}
+	for (Periodic* task : _ran) {
+		_heap.push_back(task);
+		std::push_heap(_heap.begin(), _heap.end(), later);
+	}
+	_ran.clear();
+}
+
+void PeriodicScheduler::resetStats() {
+	for (Periodic* task : _tasks) {
+		task->resetStats();
+	}
+}
+
+// Average with one decimal, without float printing
+static void printAverage(Print& out, uint64_t total, uint32_t count) {
+	uint32_t tenths = count ? (uint32_t)(total * 10 / count) : 0;
+	out.print((unsigned long)(tenths / 10));
+	out.print('.');
+	out.print((unsigned long)(tenths % 10));
+}
+
+void PeriodicScheduler::report(Print& out) const {
+	out.print(F("Periodic: "));
+	out.print((unsigned long)_tasks.size());
+	out.println(F(" tasks, late avg/max ms, run avg/max us"));
+
+	for (size_t i = 0; i < _tasks.size(); i++) {
+		const Periodic* task = _tasks[i];
+		out.print(F("  "));
+		if (task->getName()) {
+			out.print(task->getName());
+		} else {
+			out.print('#');
+			out.print((unsigned long)i);
+		}
+		out.print(F(": "));
+		out.print((unsigned long)task->getRuns());
+		out.print(F(" runs, "));
+		out.print((unsigned long)task->getSkipped());
+		out.print(F(" skipped, late "));
+		printAverage(out, task->getLateTotalMs(), task->getRuns());
+		out.print('/');
+		out.print((unsigned long)task->getLateMaxMs());
+		out.print(F(", run "));
+		printAverage(out, task->getDurationTotalUs(), task->getRuns());
+		out.print('/');
+		out.print((unsigned long)task->getDurationMaxUs());
+		out.println();
+	}
+}
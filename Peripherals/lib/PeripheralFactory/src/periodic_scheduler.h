@@ -0,0 +1,54 @@
+#ifndef PERIODIC_SCHEDULER_H
+#define PERIODIC_SCHEDULER_H
+
+#include <Arduino.h>
+#include <vector>
+
+#include "periodic.h"
+
+/**
+ * @brief Runs Periodic tasks in deadline order from a min-heap.
+ *
+ * run() only looks at the earliest deadline, so a loop in which nothing is
+ * due costs one comparison however many tasks there are. Each due task is
+ * taken out, run, and pushed back with its next deadline once the pass is
+ * over, so it runs at most once per pass: a CatchUp task far behind spreads
+ * its backlog over several passes instead of holding the loop, and an
+ * interval of 0 means once per pass. Callbacks may create new tasks.
+ */
+class PeriodicScheduler {
+public:
+    ~PeriodicScheduler();
+
+    /**
+     * @brief Schedules @p task; the scheduler owns it from now on.
+     */
+    void add(Periodic* task);
+
+    /**
+     * @brief Runs the tasks due at @p now (millis()).
+     */
+    void run(unsigned long now);
+
+    /**
+     * @brief True if some task is due at @p now.
+     */
+    bool due(unsigned long now) const { return !_heap.empty() && _heap.front()->due(now); }
+
+    size_t size() const { return _tasks.size(); }
+
+    /**
+     * @brief Prints runs, skipped deadlines, lateness (jitter) and run time of every task.
+     */
+    void report(Print& out) const;
+    void resetStats();
+
+private:
+    static bool later(const Periodic* a, const Periodic* b);
+
+    std::vector<Periodic*> _heap;  // earliest deadline in front
+    std::vector<Periodic*> _tasks; // creation order, for the report
+    std::vector<Periodic*> _ran;   // run in this pass, back into the heap after it
+};
+
+#endif // PERIODIC_SCHEDULER_H
@@ -0,0 +1,114 @@
+#include "peripheral_profiler.h"
+
+uint32_t PeripheralProfiler::ticksPerUs() {
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+	return ESP.getCpuFreqMHz();
+#else
+	return 1000;
+#endif
+}
+
+void PeripheralProfiler::track(size_t index) {
+	if (index >= _entries.size()) {
+		_entries.resize(index + 1);
+	}
+}
+
+void PeripheralProfiler::setLabel(size_t index, const char* label) {
+	track(index);
+	_entries[index].label = label;
+}
+
+void PeripheralProfiler::add(Entry& entry, uint32_t ticks) {
+	if (entry.calls == 0 || ticks < entry.minTicks) {
+		entry.minTicks = ticks;
+	}
+	if (ticks > entry.maxTicks) {
+		entry.maxTicks = ticks;
+	}
+	entry.totalTicks += ticks;
+	entry.calls++;
+}
+
+void PeripheralProfiler::reset() {
+	for (auto& entry : _entries) {
+		const char* label = entry.label;
+		entry = Entry();
+		entry.label = label;
+	}
+	_periodic = Entry();
+	_pass = Entry();
+}
+
+int PeripheralProfiler::worst() const {
+	int worst = -1;
+	for (size_t i = 0; i < _entries.size(); i++) {
+		if (_entries[i].calls && (worst < 0 || _entries[i].totalTicks > _entries[worst].totalTicks)) {
+			worst = (int)i;
+		}
+	}
+	return worst;
+}
+
+// Microseconds with one decimal, without pulling in float printing
+void PeripheralProfiler::printUs(Print& out, uint32_t ticks) {
+	uint32_t tenths = (uint32_t)((uint64_t)ticks * 10 / ticksPerUs());
+	out.print((unsigned long)(tenths / 10));
+	out.print('.');
+	out.print((unsigned long)(tenths % 10));
+}
+
+void PeripheralProfiler::report(Print& out) const {
+	if (_pass.calls == 0) {
+		out.println(F("Profiler: no update() pass yet"));
+		return;
+	}
+
+	out.print(F("Profiler: "));
+	out.print((unsigned long)_pass.calls);
+	out.print(F(" passes, us min/avg/max "));
+	printUs(out, _pass.minTicks);
+	out.print('/');
+	printUs(out, _pass.avgTicks());
+	out.print('/');
+	printUs(out, _pass.maxTicks);
+	out.println();
+
+	int worstIndex = worst();
+	for (size_t i = 0; i < _entries.size(); i++) {
+		const Entry& entry = _entries[i];
+		if (entry.calls == 0) {
+			continue;
+		}
+		out.print(F("  "));
+		if (entry.label) {
+			out.print(entry.label);
+		} else {
+			out.print('#');
+			out.print((unsigned long)i);
+		}
+		out.print(F(": "));
+		printEntry(out, entry);
+		if ((int)i == worstIndex) {
+			out.print(F("  <- worst"));
+		}
+		out.println();
+	}
+
+	if (_periodic.calls) {
+		out.print(F("  periodic tasks: "));
+		printEntry(out, _periodic);
+		out.println();
+	}
+}
+
+void PeripheralProfiler::printEntry(Print& out, const Entry& entry) const {
+	printUs(out, entry.minTicks);
+	out.print('/');
+	printUs(out, entry.avgTicks());
+	out.print('/');
+	printUs(out, entry.maxTicks);
+	out.print(F(" us, "));
+	out.print((unsigned long)(entry.totalTicks * 100 / _pass.totalTicks));
+	out.print('%');
+}
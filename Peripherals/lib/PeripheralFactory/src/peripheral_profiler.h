@@ -0,0 +1,110 @@
+#ifndef PERIPHERAL_PROFILER_H
+#define PERIPHERAL_PROFILER_H
+
+#include <Arduino.h>
+#include <vector>
+
+#if !defined(ARDUINO_ARCH_ESP8266) && !defined(ARDUINO_ARCH_ESP32)
+#include <chrono>
+#endif
+
+/**
+ * @brief Times every peripheral's update() inside PeripheralFactory::update().
+ *
+ * Only built with the PERIPHERAL_PROFILING flag (build_flags = -D PERIPHERAL_PROFILING);
+ * without it the factory loop is the plain one. On the ESP the time is the CPU
+ * cycle counter (ESP.getCycleCount(), a single register read), on the host
+ * std::chrono::steady_clock in nanoseconds. Times are kept in ticks and only
+ * converted to microseconds for the report.
+ */
+class PeripheralProfiler {
+public:
+	/**
+	 * @brief Timings of one peripheral (or of the whole pass) since the last reset().
+	 */
+	struct Entry {
+		const char* label = nullptr;
+		uint32_t calls = 0;
+		uint32_t minTicks = 0;
+		uint32_t maxTicks = 0;
+		uint64_t totalTicks = 0;
+
+		uint32_t avgTicks() const { return calls ? (uint32_t)(totalTicks / calls) : 0; }
+	};
+
+	/**
+	 * @brief Current tick count; only differences are meaningful (it wraps).
+	 */
+	static inline uint32_t now() {
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+		return ESP.getCycleCount();
+#else
+		return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	/**
+	 * @brief Ticks per microsecond: the CPU clock in MHz on the ESP, 1000 on the host.
+	 */
+	static uint32_t ticksPerUs();
+
+	/**
+	 * @brief Makes room for peripheral @p index (called as peripherals are added).
+	 */
+	void track(size_t index);
+
+	/**
+	 * @brief Names peripheral @p index in the report instead of its number.
+	 * @param label Not copied, so a string literal or something that outlives the profiler.
+	 */
+	void setLabel(size_t index, const char* label);
+
+	/**
+	 * @brief One update() of peripheral @p index took @p ticks.
+	 */
+	void record(size_t index, uint32_t ticks) { add(_entries[index], ticks); }
+
+	/**
+	 * @brief The periodic tasks due in one pass took @p ticks together
+	 * (PeriodicScheduler::report() has them one by one).
+	 */
+	void recordPeriodic(uint32_t ticks) { add(_periodic, ticks); }
+
+	/**
+	 * @brief One whole PeripheralFactory::update() pass took @p ticks.
+	 */
+	void recordPass(uint32_t ticks) { add(_pass, ticks); }
+
+	/**
+	 * @brief Clears all timings, keeping the labels.
+	 */
+	void reset();
+
+	/**
+	 * @brief Index of the peripheral with the most time spent in total, -1 before the first pass.
+	 */
+	int worst() const;
+
+	const Entry& entry(size_t index) const { return _entries[index]; }
+	const Entry& periodic() const { return _periodic; }
+	const Entry& pass() const { return _pass; }
+	size_t size() const { return _entries.size(); }
+
+	/**
+	 * @brief Prints min/avg/max in us and the share of the pass for every
+	 * peripheral, marking the worst offender.
+	 */
+	void report(Print& out) const;
+
+private:
+	static void add(Entry& entry, uint32_t ticks);
+	static void printUs(Print& out, uint32_t ticks);
+	void printEntry(Print& out, const Entry& entry) const;
+
+	std::vector<Entry> _entries;
+	Entry _periodic;
+	Entry _pass;
+};
+
+#endif // PERIPHERAL_PROFILER_H
@@ -0,0 +1,93 @@
+#include "segment_display.h"
+#include "segment_format.h"
+#include <string.h>
+#include <stdlib.h>
+
+const byte SegmentDisplay::digitSelect[8] = {
+	(byte)~(1 << 0), (byte)~(1 << 1), (byte)~(1 << 2), (byte)~(1 << 3),
+	(byte)~(1 << 4), (byte)~(1 << 5), (byte)~(1 << 6), (byte)~(1 << 7)
+};
+
+SegmentDisplay::SegmentDisplay(uint8_t numDigits) 
+	: _numDigits(numDigits), _currentDigit(0) {
+	_segments = new byte[_numDigits];
+	clear(); // Initialize display to be blank
+}
+
+SegmentDisplay::~SegmentDisplay() {
+	delete[] _segments;
+}
+
+void SegmentDisplay::clear() {
+	memset(_segments, segment::BLANK, _numDigits);
+}
+
+void SegmentDisplay::displayNumber(long number) {
+	segment::renderInteger(number, _segments, _numDigits);
+}
+
+void SegmentDisplay::displayFixed(long value, uint8_t decimals) {
+	segment::renderFixed(value, decimals, _segments, _numDigits);
+}
+
+void SegmentDisplay::displayNumber(float number, uint8_t decimalPlaces) {
+	static const long scale[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000};
+	if (decimalPlaces > 7) {
+		decimalPlaces = 7;
+	}
+
+	// Clamped to what fits a 32-bit long, rounded half away from zero like printf
+	float scaled = number * scale[decimalPlaces];
+	if (scaled > 2.0e9f) {
+		scaled = 2.0e9f;
+	} else if (scaled < -2.0e9f) {
+		scaled = -2.0e9f;
+	}
+	displayFixed((long)(scaled + (scaled < 0 ? -0.5f : 0.5f)), decimalPlaces);
+}
+
+void SegmentDisplay::displayString(const char* str) {
+	clear();
+	int len = strlen(str);
+	int displayPos = _numDigits - 1;
+	bool decimalFound = false;
+
+	for (int i = len - 1; i >= 0 && displayPos >= 0; i--) {
+		char c = str[i];
+		if (c >= '0' && c <= '9') {
+			_segments[displayPos--] = segment::DIGITS[c - '0'] | (decimalFound ? segment::DP : 0);
+			decimalFound = false;
+		} else if (c == '.') {
+			decimalFound = true;
+		} else if (c == '-') {
+			_segments[displayPos--] = segment::MINUS;
+		} else if (c == ' ') {
+			_segments[displayPos--] = segment::BLANK;
+		}
+	}
+}
+
+const byte* SegmentDisplay::getShiftData() const {
+	return _shiftData;
+}
+
+uint8_t SegmentDisplay::getRegisterCount() const {
+	return 2; // This device always uses 2 shift registers
+}
+
+bool SegmentDisplay::isLit(uint8_t digit) const {
+	return _segments[digit] != segment::BLANK;
+}
+
+void SegmentDisplay::update() {
+	if (isLit(_currentDigit)) {
+		_shiftData[0] = digitSelect[_currentDigit];
+		_shiftData[1] = _segments[_currentDigit];
+	} else {
+		// Dark slot: no digit selected (an all-blank display repeats this)
+		_shiftData[0] = 0xFF;
+		_shiftData[1] = segment::BLANK;
+	}
+
+	_currentDigit = (_currentDigit + 1) % _numDigits;
+}
\ No newline at end of file
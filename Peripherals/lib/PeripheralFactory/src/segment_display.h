@@ -0,0 +1,80 @@
+#ifndef SEGMENT_DISPLAY_H
+#define SEGMENT_DISPLAY_H
+
+#include "shift_register_device.h"
+
+/**
+ * @brief A logical device that controls a 7-segment display module.
+ * 
+ * This class manages the state of a multi-digit 7-segment display.
+ * It handles number-to-segment conversion and multiplexing. It does not
+ * directly control hardware pins; instead, it provides its data to a
+ * ShiftRegisterChain controller.
+ */
+class SegmentDisplay : public ShiftRegisterDevice {
+public:
+    /**
+     * @brief Construct a new Segment Display object.
+     * @param numDigits The number of digits on the display module (e.g., 4 or 8).
+     */
+    SegmentDisplay(uint8_t numDigits = 4);
+    ~SegmentDisplay(); // Add destructor declaration
+
+    /**
+     * @brief Sets the number to be displayed.
+     * @param number The integer to display.
+     */
+    void displayNumber(long number);
+
+    /**
+     * @brief Displays a fixed-point number without touching floats.
+     * @param value The number times 10^decimals, e.g. millis() / 100 with 1 decimal for seconds.
+     * @param decimals Digits after the decimal point; dropped from the right if the number does not fit.
+     */
+    void displayFixed(long value, uint8_t decimals);
+
+    /**
+     * @brief Displays a float, scaled once to fixed point (no printf).
+     * Prefer displayFixed() in hot paths, it saves the soft-float multiply.
+     */
+    void displayNumber(float number, uint8_t decimalPlaces = 2);
+    void displayString(const char* str);
+    void clear();
+
+    // --- Implementations for the ShiftRegisterDevice interface ---
+
+    /**
+     * @brief Gets the data to be shifted out for this device.
+     * @return A const pointer to the internal data buffer (2 bytes).
+     */
+    const byte* getShiftData() const override;
+
+    /**
+     * @brief Gets the number of shift registers this device uses.
+     * @return Always returns 2 (one for segments, one for digits).
+     */
+    uint8_t getRegisterCount() const override;
+
+    /**
+     * @brief Updates the internal state for multiplexing.
+     * This should be called on every loop by the chain controller.
+     * Every digit keeps its time slot, so brightness does not depend on
+     * how many are lit; a blank digit's slot selects no digit at all.
+     */
+    void update() override;
+
+    void test();
+
+private:
+    bool isLit(uint8_t digit) const;
+
+    static const byte digitSelect[8];
+
+    uint8_t _numDigits;
+    uint8_t _currentDigit;
+    byte* _segments; // Segment pattern (with DP) for each digit position, see segment_format.h
+
+    byte _shiftData[2];
+};
+
+#endif // SEGMENT_DISPLAY_H
\ No newline at end of file
@@ -0,0 +1,103 @@
+#ifndef SEGMENT_FORMAT_H
+#define SEGMENT_FORMAT_H
+
+#include <stdint.h>
+
+/**
+ * @brief Integer-only number formatting for 7-segment displays.
+ *
+ * Numbers are rendered straight into segment bitmasks (bit 0 = a ... bit 6 = g,
+ * bit 7 = DP, common cathode), without printf, floats or heap. Plain C++ so the
+ * host benchmarks can build it too.
+ */
+namespace segment {
+
+// pgfedcba
+constexpr uint8_t DIGITS[10] = {
+	0b00111111, // 0
+	0b00000110, // 1
+	0b01011011, // 2
+	0b01001111, // 3
+	0b01100110, // 4
+	0b01101101, // 5
+	0b01111101, // 6
+	0b00000111, // 7
+	0b01111111, // 8
+	0b01101111  // 9
+};
+constexpr uint8_t DP = 0b10000000;
+constexpr uint8_t MINUS = 0b01000000;
+constexpr uint8_t BLANK = 0b00000000;
+
+/**
+ * @brief Digits needed for @p magnitude shown with @p decimals decimals (at least one before the point).
+ */
+inline uint8_t digitCount(uint32_t magnitude, uint8_t decimals) {
+	uint8_t count = 1;
+	while (magnitude >= 10) {
+		magnitude /= 10;
+		count++;
+	}
+	return count > decimals ? count : decimals + 1;
+}
+
+/**
+ * @brief Renders @p value / 10^@p decimals right-aligned into @p out.
+ *
+ * out[width - 1] is the rightmost digit. If the number is too wide, decimals
+ * are dropped (rounded) first; if the integer part still does not fit, only
+ * its lowest digits are shown, like an odometer.
+ */
+inline void renderFixed(int32_t value, uint8_t decimals, uint8_t* out, uint8_t width) {
+	if (width == 0) {
+		return;
+	}
+	bool negative = value < 0;
+	uint32_t magnitude = negative ? 0u - (uint32_t)value : (uint32_t)value;
+
+	while (decimals > 0 && digitCount(magnitude, decimals) + negative > width) {
+		magnitude = (magnitude + 5) / 10;
+		decimals--;
+	}
+	if (magnitude == 0) {
+		negative = false;
+	}
+
+	uint8_t pos = width;
+	uint8_t produced = 0;
+	do {
+		uint8_t pattern = DIGITS[magnitude % 10];
+		if (decimals && produced == decimals) {
+			pattern |= DP;
+		}
+		out[--pos] = pattern;
+		magnitude /= 10;
+		produced++;
+	} while (pos > 0 && (magnitude || produced <= decimals));
+
+	if (negative && pos > 0) {
+		out[--pos] = MINUS;
+	}
+	while (pos > 0) {
+		out[--pos] = BLANK;
+	}
+}
+
+/**
+ * @brief @p value / @p divisor rounded half away from zero, like printf
+ * rounds the last shown decimal. @p divisor must be positive.
+ */
+inline int32_t divideRounded(int32_t value, int32_t divisor) {
+	return value < 0 ? (value - divisor / 2) / divisor : (value + divisor / 2) / divisor;
+}
+
+/**
+ * @brief Renders an integer right-aligned into @p out.
+ */
+inline void renderInteger(int32_t value, uint8_t* out, uint8_t width) {
+	renderFixed(value, 0, out, width);
+}
+
+} // namespace segment
+
+#endif // SEGMENT_FORMAT_H
@@ -0,0 +1,164 @@
+#include "segment_multiplexer.h"
+#include "segment_format.h"
+#include <string.h>
+
+SegmentMultiplexer* SegmentMultiplexer::_running = nullptr;
+
+// Called from the timer ISR on the ESP8266, so no flash code: GPIO 0-15
+// through the set/clear registers, GPIO16 (D0) through its own one.
+static inline void IRAM_ATTR writePin(uint8_t pin, bool high) {
+#if defined(ARDUINO_ARCH_ESP8266)
+	if (pin < 16) {
+		if (high) {
+			GPOS = 1 << pin;
+		} else {
+			GPOC = 1 << pin;
+		}
+	} else if (high) {
+		GP16O |= 1;
+	} else {
+		GP16O &= ~1;
+	}
+#else
+	digitalWrite(pin, high ? HIGH : LOW);
+#endif
+}
+
+SegmentMultiplexer::SegmentMultiplexer(uint8_t latchPin, uint8_t dataPin, uint8_t clockPin, uint8_t numDigits)
+	: _latchPin(latchPin), _dataPin(dataPin), _clockPin(clockPin),
+	  _numDigits(numDigits > MAX_DIGITS ? MAX_DIGITS : numDigits), _front(0), _pending(false), _currentDigit(0) {
+	pinMode(_latchPin, OUTPUT);
+	pinMode(_dataPin, OUTPUT);
+	pinMode(_clockPin, OUTPUT);
+#if defined(ARDUINO_ARCH_ESP32)
+	_timer = nullptr;
+#endif
+	// Both frames blank
+	clear();
+	fill(0);
+	fill(1);
+}
+
+SegmentMultiplexer::~SegmentMultiplexer() {
+	end();
+}
+
+bool SegmentMultiplexer::begin(uint16_t refreshHz) {
+	if (_running || refreshHz == 0) {
+		return false;
+	}
+	uint32_t tickUs = 1000000UL / ((uint32_t)refreshHz * _numDigits);
+	_running = this;
+
+#if defined(ARDUINO_ARCH_ESP8266)
+	// 80 MHz / 16: 5 ticks per us
+	timer1_attachInterrupt(onTimer);
+	timer1_enable(TIM_DIV16, TIM_EDGE, TIM_LOOP);
+	timer1_write(tickUs * 5);
+	return true;
+#elif defined(ARDUINO_ARCH_ESP32)
+	esp_timer_create_args_t args = {};
+	args.callback = [](void*) { onTimer(); };
+	args.name = "segmux";
+	if (esp_timer_create(&args, &_timer) != ESP_OK || esp_timer_start_periodic(_timer, tickUs) != ESP_OK) {
+		_running = nullptr;
+		return false;
+	}
+	return true;
+#else
+	(void)tickUs;
+	_running = nullptr;
+	return false;
+#endif
+}
+
+void SegmentMultiplexer::end() {
+	if (_running != this) {
+		return;
+	}
+#if defined(ARDUINO_ARCH_ESP8266)
+	timer1_disable();
+	timer1_detachInterrupt();
+#elif defined(ARDUINO_ARCH_ESP32)
+	esp_timer_stop(_timer);
+	esp_timer_delete(_timer);
+	_timer = nullptr;
+#endif
+	_running = nullptr;
+	// A frame the timer never picked up is the latest one
+	if (_pending.load(std::memory_order_acquire)) {
+		_front ^= 1;
+		_pending.store(false, std::memory_order_relaxed);
+	}
+}
+
+void SegmentMultiplexer::clear() {
+	memset(_back, segment::BLANK, sizeof(_back));
+}
+
+void SegmentMultiplexer::setSegments(uint8_t digit, uint8_t segments) {
+	if (digit < _numDigits) {
+		_back[digit] = segments;
+	}
+}
+
+void SegmentMultiplexer::displayNumber(long number) {
+	segment::renderInteger(number, _back, _numDigits);
+}
+
+void SegmentMultiplexer::displayFixed(long value, uint8_t decimals) {
+	segment::renderFixed(value, decimals, _back, _numDigits);
+}
+
+void SegmentMultiplexer::fill(uint8_t frame) {
+	for (uint8_t i = 0; i < _numDigits; i++) {
+		// Active LOW digit select, as SegmentDisplay
+		_frames[frame][i].select = (uint8_t)~(1 << i);
+		_frames[frame][i].segments = _back[i];
+	}
+}
+
+bool SegmentMultiplexer::show() {
+	// Until the timer has swapped, the other frame may be the one it reads
+	if (_pending.load(std::memory_order_acquire)) {
+		return false;
+	}
+	fill(_front ^ 1);
+	if (_running != this) {
+		_front ^= 1; // no timer to hand it to
+		return true;
+	}
+	_pending.store(true, std::memory_order_release);
+	return true;
+}
+
+void IRAM_ATTR SegmentMultiplexer::onTimer() {
+	if (_running) {
+		_running->tick();
+	}
+}
+
+void IRAM_ATTR SegmentMultiplexer::shiftByte(uint8_t value) {
+	for (uint8_t bit = 0x80; bit; bit >>= 1) {
+		writePin(_dataPin, value & bit);
+		writePin(_clockPin, true);
+		writePin(_clockPin, false);
+	}
+}
+
+void IRAM_ATTR SegmentMultiplexer::tick() {
+	if (_pending.load(std::memory_order_acquire)) {
+		_front ^= 1;
+		_pending.store(false, std::memory_order_release);
+	}
+	const DigitBytes& digit = _frames[_front][_currentDigit];
+
+	writePin(_latchPin, false);
+	shiftByte(digit.select);
+	shiftByte(digit.segments);
+	writePin(_latchPin, true);
+
+	if (++_currentDigit >= _numDigits) {
+		_currentDigit = 0;
+	}
+}
@@ -0,0 +1,88 @@
+#ifndef SEGMENT_MULTIPLEXER_H
+#define SEGMENT_MULTIPLEXER_H
+
+#include <Arduino.h>
+#include <atomic>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_timer.h>
+#endif
+
+/**
+ * @brief Timer-driven multiplexing for a 7-segment module on its own two shift registers.
+ *
+ * A timer lights one digit per tick, (digitSelect, segments) shifted out
+ * like demos/shift_displays.cpp does by hand, so the display keeps its
+ * refresh rate no matter what loop() is doing. The loop renders into a back
+ * buffer and publishes it with show(); the timer only ever reads the front
+ * one, which holds the precomputed bytes for each digit. The timer makes the
+ * swap itself, on its next tick, so the loop never writes a frame the timer
+ * may be reading (on the ESP32 the esp_timer task runs next to loop()).
+ *
+ * The timer is the ESP8266's Timer1 (an ISR; analogWrite, tone and Servo
+ * use the same timer, so not together with those) or an esp_timer on the
+ * ESP32. Only one multiplexer runs at a time.
+ *
+ * Not for displays on a ShiftRegisterChain: SegmentDisplay multiplexes
+ * those from the chain's update().
+ */
+class SegmentMultiplexer {
+public:
+    static const uint8_t MAX_DIGITS = 8;
+
+    /**
+     * @brief Construct a new multiplexer; the leftmost digit is selected by bit 0.
+     * @param numDigits Digits on the module, up to MAX_DIGITS.
+     */
+    SegmentMultiplexer(uint8_t latchPin, uint8_t dataPin, uint8_t clockPin, uint8_t numDigits = 4);
+    ~SegmentMultiplexer();
+
+    /**
+     * @brief Starts the timer.
+     * @param refreshHz How often every digit is lit per second; the timer runs numDigits times faster.
+     * @return false if another multiplexer is running or the platform has no timer support.
+     */
+    bool begin(uint16_t refreshHz = 125);
+    void end();
+
+    // --- Drawing into the back buffer, shown after show() ---
+
+    void clear();
+    void setSegments(uint8_t digit, uint8_t segments);
+    void displayNumber(long number);
+    void displayFixed(long value, uint8_t decimals);
+
+    /**
+     * @brief Makes the back buffer visible from the next digit on. The back
+     * buffer keeps its contents, so the next frame can be drawn incrementally.
+     * @return false if the timer has not picked up the previous frame yet
+     * (two calls within one tick); nothing changed, call again later.
+     */
+    bool show();
+
+private:
+    struct DigitBytes {
+        uint8_t select;
+        uint8_t segments;
+    };
+
+    void tick();
+    void fill(uint8_t frame);
+    void shiftByte(uint8_t value);
+    static void onTimer();
+
+    static SegmentMultiplexer* _running;
+
+    uint8_t _latchPin, _dataPin, _clockPin;
+    uint8_t _numDigits;
+    DigitBytes _frames[2][MAX_DIGITS];
+    uint8_t _front;                 // written by the timer while it runs
+    std::atomic<bool> _pending;     // the other frame is ready, the timer swaps on its next tick
+    uint8_t _currentDigit;
+    uint8_t _back[MAX_DIGITS]; // segments being drawn
+#if defined(ARDUINO_ARCH_ESP32)
+    esp_timer_handle_t _timer;
+#endif
+};
+
+#endif // SEGMENT_MULTIPLEXER_H
@@ -0,0 +1,76 @@
+#include "shift_register_chain.h"
+
+#if defined(ARDUINO_ARCH_ESP8266)
+// HSPI has no pin matrix on the ESP8266
+static const uint8_t HSPI_DATA_PIN = 13;
+static const uint8_t HSPI_CLOCK_PIN = 14;
+#endif
+
+ShiftRegisterChain::ShiftRegisterChain(uint8_t latchPin, uint8_t dataPin, uint8_t clockPin, uint32_t spiClockHz)
+    : _latchPin(latchPin), _dataPin(dataPin), _clockPin(clockPin), _spiClockHz(spiClockHz) {
+	pinMode(_latchPin, OUTPUT);
+	digitalWrite(_latchPin, HIGH);
+
+#if defined(ARDUINO_ARCH_ESP8266)
+	if (_spiClockHz && (_dataPin != HSPI_DATA_PIN || _clockPin != HSPI_CLOCK_PIN)) {
+		Serial.println(F("ShiftRegisterChain: hardware SPI needs data on D7 and clock on D5, bit-banging"));
+		_spiClockHz = 0;
+	}
+#endif
+
+	if (_spiClockHz) {
+#if defined(ARDUINO_ARCH_ESP32)
+		SPI.begin(_clockPin, -1, _dataPin, -1);
+#else
+		SPI.begin();
+#endif
+	} else {
+		pinMode(_dataPin, OUTPUT);
+		pinMode(_clockPin, OUTPUT);
+	}
+}
+
+void ShiftRegisterChain::addDevice(ShiftRegisterDevice* device) {
+	_devices.push_back(device);
+}
+
+void ShiftRegisterChain::update() {
+	// First, call the internal update on all devices so they can update their state (e.g., multiplexing)
+	for (ShiftRegisterDevice* device : _devices) {
+		device->update();
+	}
+
+	// Gather the data from all devices into one frame, furthest device first.
+	_frame.clear();
+	for (ShiftRegisterDevice* device : _devices) {
+		const byte* data = device->getShiftData();
+		_frame.insert(_frame.end(), data, data + device->getRegisterCount());
+	}
+
+	// Nothing changed (static bargraphs, blank displays): the registers already show it
+	if (_frame == _shown) {
+		_bytesSkipped += _frame.size();
+		return;
+	}
+
+	push();
+	_bytesPushed += _frame.size();
+	_frame.swap(_shown);
+}
+
+void ShiftRegisterChain::push() {
+	digitalWrite(_latchPin, LOW);
+
+	if (_spiClockHz) {
+		// 74HC595 samples on the rising edge: mode 0, MSB first like shiftOut
+		SPI.beginTransaction(SPISettings(_spiClockHz, MSBFIRST, SPI_MODE0));
+		SPI.writeBytes(_frame.data(), _frame.size());
+		SPI.endTransaction();
+	} else {
+		for (byte value : _frame) {
+			shiftOut(_dataPin, _clockPin, MSBFIRST, value);
+		}
+	}
+
+	digitalWrite(_latchPin, HIGH);
+}
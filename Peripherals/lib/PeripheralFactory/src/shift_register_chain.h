@@ -0,0 +1,68 @@
+#ifndef SHIFT_REGISTER_CHAIN_H
+#define SHIFT_REGISTER_CHAIN_H
+
+#include "Peripheral.h"
+#include "shift_register_device.h"
+#include <SPI.h>
+#include <vector>
+
+/**
+ * @brief Drives a daisy chain of 74HC595-style shift registers.
+ *
+ * Every update() collects the bytes of all devices into one frame and
+ * pushes it out in one go, latched at the end. The frame goes out either
+ * bit-banged (shiftOut, any pins) or through the hardware SPI peripheral:
+ * HSPI on the ESP8266, whose pins are fixed (data D7/GPIO13, clock D5/GPIO14),
+ * or the default SPI (SPI2) on the ESP32 with any data and clock pins.
+ * demos/spi_chain_benchmark.cpp compares the two per chain length.
+ *
+ * The registers hold their outputs, so a frame equal to the one shifted
+ * last time is not sent again; bytesSkipped() counts what that saved.
+ */
+class ShiftRegisterChain : public Peripheral {
+public:
+    /**
+     * @brief Construct a new chain.
+     * @param spiClockHz 0 bit-bangs. Otherwise the hardware SPI clock; on the
+     * ESP8266 this falls back to bit-banging unless the pins are the HSPI ones.
+     */
+    ShiftRegisterChain(uint8_t latchPin, uint8_t dataPin, uint8_t clockPin, uint32_t spiClockHz = 0);
+
+    void update() override;
+
+    // Add devices to the chain, from furthest to closest to the MCU.
+    void addDevice(ShiftRegisterDevice* device);
+
+    /**
+     * @brief True if the frame goes out through the SPI peripheral.
+     */
+    bool usesHardwareSpi() const { return _spiClockHz != 0; }
+
+    /**
+     * @brief Number of bytes (registers) in the last frame pushed.
+     */
+    size_t frameLength() const { return _shown.size(); }
+
+    /**
+     * @brief Bytes shifted out since boot.
+     */
+    uint32_t bytesPushed() const { return _bytesPushed; }
+
+    /**
+     * @brief Bytes not shifted out since boot because the frame was unchanged.
+     */
+    uint32_t bytesSkipped() const { return _bytesSkipped; }
+
+private:
+    void push();
+
+    uint8_t _latchPin, _dataPin, _clockPin;
+    uint32_t _spiClockHz;
+    std::vector<ShiftRegisterDevice*> _devices;
+    std::vector<byte> _frame; // being gathered
+    std::vector<byte> _shown; // in the registers
+    uint32_t _bytesPushed = 0;
+    uint32_t _bytesSkipped = 0;
+};
+
+#endif // SHIFT_REGISTER_CHAIN_H
@@ -0,0 +1,92 @@
+#ifndef ADC_FILTER_H
+#define ADC_FILTER_H
+
+/*
+ * Integer sampling stage for a noisy ADC input.
+ *
+ *   raw readings --(sum of 2^oversampleShift)--> block average
+ *                --(median of the last 3 blocks, optional)--> spike rejection
+ *                --(EMA, alpha = 1/2^emaShift)--> value()
+ *
+ * One filtered value comes out per 2^oversampleShift readings, which is the
+ * decimation. Everything is shifts and adds (the ESP8266 has no FPU and no
+ * divider); the EMA keeps 8 fractional bits so small steps are not lost.
+ */
+
+#include <stdint.h>
+
+class AdcFilter {
+public:
+    /**
+     * @param oversampleShift Readings per output as a power of two (0 = every reading).
+     * @param emaShift        EMA smoothing, 0 = off, 2 = alpha 1/4, 3 = 1/8 ...
+     * @param median          Median of the last three blocks before the EMA.
+     */
+    AdcFilter(uint8_t oversampleShift, uint8_t emaShift, bool median = true)
+        : _oversampleShift(oversampleShift), _emaShift(emaShift), _median(median) {
+        reset();
+    }
+
+    void reset() {
+        _sum = 0;
+        _count = 0;
+        _history[0] = _history[1] = _history[2] = 0;
+        _next = 0;
+        _blocks = 0;
+        _ema = 0;
+    }
+
+    /** @brief Adds a reading. @return true when value() has a new output. */
+    bool add(uint16_t reading) {
+        _sum += reading;
+        if (++_count < (1U << _oversampleShift)) {
+            return false;
+        }
+        uint16_t block = (uint16_t)((_sum + ((1UL << _oversampleShift) >> 1)) >> _oversampleShift);
+        _sum = 0;
+        _count = 0;
+
+        _history[_next] = block;
+        _next = _next == 2 ? 0 : _next + 1;
+        if (_blocks < 3) {
+            _blocks++;
+        }
+        uint16_t sample = _median && _blocks >= 3 ? median3(_history[0], _history[1], _history[2]) : block;
+
+        int32_t fixed = (int32_t)sample << 8;
+        if (_blocks == 1 || _emaShift == 0) {
+            _ema = fixed; // start from the first reading instead of rising from 0
+        } else {
+            _ema += (fixed - _ema) >> _emaShift;
+        }
+        return true;
+    }
+
+    /** @brief Filtered reading, same scale as the input. */
+    uint16_t value() const { return (uint16_t)((_ema + 0x80) >> 8); }
+
+    uint8_t oversampleShift() const { return _oversampleShift; }
+    uint8_t emaShift() const { return _emaShift; }
+
+private:
+    // Written as min/max so it compiles to conditional moves: on noise the
+    // branches of a compare chain are taken at random
+    static uint16_t median3(uint16_t a, uint16_t b, uint16_t c) {
+        uint16_t low = a < b ? a : b;
+        uint16_t high = a < b ? b : a;
+        uint16_t clamped = c < high ? c : high;
+        return clamped > low ? clamped : low;
+    }
+
+    uint8_t _oversampleShift;
+    uint8_t _emaShift;
+    bool _median;
+    uint32_t _sum;
+    uint16_t _count;
+    uint16_t _history[3];
+    uint8_t _next;
+    uint8_t _blocks; // saturates at 3
+    int32_t _ema; // 24.8
+};
+
+#endif // ADC_FILTER_H
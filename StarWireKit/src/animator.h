@@ -0,0 +1,104 @@
+#ifndef ANIMATOR_H
+#define ANIMATOR_H
+
+/*
+ * Fixed-point output animator.
+ *
+ * Moves a few output channels (RGB of an LED, duty of a motor) linearly
+ * to a new target over a number of ticks. Values are kept in unsigned 16.16
+ * fixed point, so the whole uint16_t range works; retarget() does the only
+ * division, a tick is one add per channel.
+ * tick() reports whether the integer output changed, so the caller writes
+ * the hardware (setColor()/show(), forward()) only when it would differ.
+ *
+ * Call tick() at a fixed rate, e.g. from factory.createPeriodic().
+ */
+
+#include <stdint.h>
+
+template <uint8_t Channels>
+class Animator {
+public:
+    Animator() : _ticksLeft(0) {
+        for (uint8_t i = 0; i < Channels; i++) {
+            _value[i] = 0;
+            _step[i] = 0;
+            _target[i] = 0;
+            _output[i] = 0;
+        }
+    }
+
+    /** @brief Jumps to @p values; the next tick() reports the change. */
+    void set(const uint16_t* values) {
+        for (uint8_t i = 0; i < Channels; i++) {
+            _target[i] = values[i];
+            _value[i] = (uint32_t)values[i] << 16;
+            _step[i] = 0;
+        }
+        _ticksLeft = 1;
+    }
+
+    /** @brief Jumps to @p values the hardware already shows; tick() reports nothing. */
+    void reset(const uint16_t* values) {
+        for (uint8_t i = 0; i < Channels; i++) {
+            _target[i] = values[i];
+            _output[i] = values[i];
+            _value[i] = (uint32_t)values[i] << 16;
+            _step[i] = 0;
+        }
+        _ticksLeft = 0;
+    }
+
+    /**
+     * @brief Starts moving from the current output to @p values over @p ticks.
+     *
+     * All channels arrive together. @p ticks 0 is the same as set().
+     */
+    void retarget(const uint16_t* values, uint16_t ticks) {
+        if (ticks == 0) {
+            set(values);
+            return;
+        }
+        for (uint8_t i = 0; i < Channels; i++) {
+            _target[i] = values[i];
+            // A full-range move needs 33 bits; from 2 ticks on the step fits in
+            // 32, and a single tick lands on the target without one
+            int64_t distance = ((int64_t)values[i] << 16) - (int64_t)_value[i];
+            _step[i] = ticks > 1 ? (int32_t)(distance / ticks) : 0;
+        }
+        _ticksLeft = ticks;
+    }
+
+    /** @brief Advances one tick. @return true if any output() changed. */
+    bool tick() {
+        if (_ticksLeft == 0) {
+            return false;
+        }
+        _ticksLeft--;
+        bool changed = false;
+        for (uint8_t i = 0; i < Channels; i++) {
+            // Land exactly on the target, the steps are truncated (towards the
+            // start, so the value never leaves the range and the add wraps back)
+            _value[i] = _ticksLeft ? _value[i] + (uint32_t)_step[i] : (uint32_t)_target[i] << 16;
+            uint16_t output = (uint16_t)((_value[i] + 0x8000) >> 16);
+            if (output != _output[i]) {
+                _output[i] = output;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    uint16_t output(uint8_t channel) const { return _output[channel]; }
+    uint16_t target(uint8_t channel) const { return _target[channel]; }
+    bool active() const { return _ticksLeft != 0; }
+
+private:
+    uint32_t _value[Channels]; // 16.16
+    int32_t _step[Channels];   // 16.16 per tick
+    uint16_t _target[Channels];
+    uint16_t _output[Channels];
+    uint16_t _ticksLeft;
+};
+
+#endif // ANIMATOR_H
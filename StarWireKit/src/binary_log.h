@@ -0,0 +1,161 @@
+#ifndef BINARY_LOG_H
+#define BINARY_LOG_H
+
+/*
+ * Binary event log.
+ *
+ * A log call stores an event id and up to four integer arguments in a ring;
+ * nothing is formatted on the device. drain() later encodes the records and
+ * writes them only while the UART has room in its TX FIFO, so logging never
+ * blocks the loop. When the ring is full new records are dropped and
+ * counted instead. tools/log_decode.py turns the stream back into text.
+ *
+ * Record on the wire:
+ *
+ *   0xA5  event  level<<4|argc  varint(ms)  zigzag-varint(arg)...  xor
+ *
+ * xor covers every byte after 0xA5, which lets the decoder resync when the
+ * stream is mixed with plain text (boot messages, Serial.println).
+ *
+ * Levels above STARWIRE_LOG_LEVEL are removed at compile time: the
+ * STARWIRE_LOG() condition is a constant expression, so the call and the
+ * evaluation of its arguments fold away.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "spsc_queue.h"
+
+#define STARWIRE_LOG_OFF 0
+#define STARWIRE_LOG_ERROR 1
+#define STARWIRE_LOG_WARN 2
+#define STARWIRE_LOG_INFO 3
+#define STARWIRE_LOG_DEBUG 4
+
+#ifndef STARWIRE_LOG_LEVEL
+#define STARWIRE_LOG_LEVEL STARWIRE_LOG_INFO
+#endif
+
+static const uint8_t STARWIRE_LOG_SYNC = 0xA5;
+static const uint8_t STARWIRE_LOG_MAX_ARGS = 4;
+static const uint8_t STARWIRE_LOG_MAX_RECORD = 3 + 5 + STARWIRE_LOG_MAX_ARGS * 5 + 1;
+
+/** @brief True if records of @p level are compiled in. */
+constexpr bool starwireLogEnabled(uint8_t level) {
+    return level != STARWIRE_LOG_OFF && level <= STARWIRE_LOG_LEVEL;
+}
+
+#define STARWIRE_LOG(log, level, event, ...)                        \
+    do {                                                            \
+        if (starwireLogEnabled(level)) {                            \
+            (log).write((level), (event), millis(), ##__VA_ARGS__); \
+        }                                                           \
+    } while (0)
+
+struct LogRecord {
+    uint32_t timeMs;
+    uint8_t event;
+    uint8_t level;
+    uint8_t argCount;
+    int32_t args[STARWIRE_LOG_MAX_ARGS];
+};
+
+template <uint8_t Size = 16>
+class BinaryLog {
+public:
+    BinaryLog() : _pendingLength(0), _pendingOffset(0), _bytesWritten(0) {}
+
+    /** @brief Queues a record; extra arguments beyond STARWIRE_LOG_MAX_ARGS are a compile error. */
+    template <typename... Args>
+    bool write(uint8_t level, uint8_t event, uint32_t timeMs, Args... args) {
+        static_assert(sizeof...(Args) <= STARWIRE_LOG_MAX_ARGS, "too many log arguments");
+        LogRecord record;
+        record.timeMs = timeMs;
+        record.event = event;
+        record.level = level;
+        record.argCount = sizeof...(Args);
+        int32_t values[sizeof...(Args) + 1] = {static_cast<int32_t>(args)..., 0};
+        for (uint8_t i = 0; i < sizeof...(Args); i++) {
+            record.args[i] = values[i];
+        }
+        return _records.push(record);
+    }
+
+    /**
+     * @brief Writes queued records to @p out without blocking.
+     *
+     * @p out needs availableForWrite() and write(const uint8_t*, size_t),
+     * like HardwareSerial. A record that does not fit yet stays pending for
+     * the next call. @return Bytes written.
+     */
+    template <typename Sink>
+    size_t drain(Sink& out) {
+        size_t written = 0;
+        for (;;) {
+            if (_pendingOffset == _pendingLength) {
+                LogRecord record;
+                if (!_records.pop(record)) {
+                    break;
+                }
+                _pendingLength = encode(record, _pending);
+                _pendingOffset = 0;
+            }
+            int room = out.availableForWrite();
+            if (room <= 0) {
+                break;
+            }
+            size_t chunk = _pendingLength - _pendingOffset;
+            if (chunk > (size_t)room) {
+                chunk = room;
+            }
+            out.write(_pending + _pendingOffset, chunk);
+            _pendingOffset += chunk;
+            written += chunk;
+        }
+        _bytesWritten += written;
+        return written;
+    }
+
+    /** @brief Records lost because the ring was full. */
+    uint32_t dropped() const { return _records.dropped(); }
+    uint32_t bytesWritten() const { return _bytesWritten; }
+    uint8_t queued() const { return _records.size(); }
+
+    /** @brief Encodes @p record into @p out (STARWIRE_LOG_MAX_RECORD bytes). @return Length. */
+    static uint8_t encode(const LogRecord& record, uint8_t* out) {
+        uint8_t length = 0;
+        out[length++] = STARWIRE_LOG_SYNC;
+        out[length++] = record.event;
+        out[length++] = (uint8_t)(record.level << 4) | record.argCount;
+        length += putVarint(out + length, record.timeMs);
+        for (uint8_t i = 0; i < record.argCount; i++) {
+            int32_t value = record.args[i];
+            length += putVarint(out + length, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+        }
+        uint8_t check = 0;
+        for (uint8_t i = 1; i < length; i++) {
+            check ^= out[i];
+        }
+        out[length++] = check;
+        return length;
+    }
+
+private:
+    static uint8_t putVarint(uint8_t* out, uint32_t value) {
+        uint8_t length = 0;
+        while (value >= 0x80) {
+            out[length++] = (uint8_t)(value | 0x80);
+            value >>= 7;
+        }
+        out[length++] = (uint8_t)value;
+        return length;
+    }
+
+    SpscQueue<LogRecord, Size> _records;
+    uint8_t _pending[STARWIRE_LOG_MAX_RECORD];
+    uint8_t _pendingLength;
+    uint8_t _pendingOffset;
+    uint32_t _bytesWritten;
+};
+
+#endif // BINARY_LOG_H
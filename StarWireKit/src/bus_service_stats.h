@@ -0,0 +1,87 @@
+#ifndef BUS_SERVICE_STATS_H
+#define BUS_SERVICE_STATS_H
+
+/*
+ * How well the bus is being serviced on a slave.
+ *
+ *   gap   time between two bus polls above the budget; frames that arrive
+ *         in such a gap can be missed
+ *   late  command applied more than the budget after it was received
+ *         (only when commands are queued from a timer/task to loop())
+ *
+ * serviced() runs on the bus side (ISR, task or loop), the rest on loop();
+ * counters are 32-bit so reading them from loop() is never torn.
+ */
+
+#include <stdint.h>
+
+class BusServiceStats {
+public:
+    BusServiceStats(uint32_t gapBudgetUs, uint32_t lateBudgetUs)
+        : _gapBudgetUs(gapBudgetUs), _lateBudgetUs(lateBudgetUs) {
+        reset();
+    }
+
+    void reset() {
+        _lastServiceUs = 0;
+        _services = 0;
+        _gaps = 0;
+        _maxGapUs = 0;
+        _applied = 0;
+        _late = 0;
+        _maxLatencyUs = 0;
+    }
+
+    /** @brief Call at every bus poll, with micros(). */
+    void serviced(uint32_t nowUs) {
+        if (_services) {
+            uint32_t gap = nowUs - _lastServiceUs;
+            if (gap > _gapBudgetUs) {
+                _gaps = _gaps + 1;
+            }
+            if (gap > _maxGapUs) {
+                _maxGapUs = gap;
+            }
+        }
+        _lastServiceUs = nowUs;
+        _services = _services + 1;
+    }
+
+    /** @brief Call when loop() applies a queued command, with its receive time and micros(). */
+    void applied(uint32_t receivedUs, uint32_t nowUs) {
+        uint32_t latency = nowUs - receivedUs;
+        _applied++;
+        if (latency > _lateBudgetUs) {
+            _late++;
+        }
+        if (latency > _maxLatencyUs) {
+            _maxLatencyUs = latency;
+        }
+    }
+
+    uint32_t services() const { return _services; }
+    uint32_t gaps() const { return _gaps; }
+    uint32_t maxGapUs() const { return _maxGapUs; }
+    uint32_t applied() const { return _applied; }
+    uint32_t late() const { return _late; }
+    uint32_t maxLatencyUs() const { return _maxLatencyUs; }
+    uint32_t gapBudgetUs() const { return _gapBudgetUs; }
+    uint32_t lateBudgetUs() const { return _lateBudgetUs; }
+
+private:
+    uint32_t _gapBudgetUs;
+    uint32_t _lateBudgetUs;
+
+    // Bus side
+    volatile uint32_t _lastServiceUs;
+    volatile uint32_t _services;
+    volatile uint32_t _gaps;
+    volatile uint32_t _maxGapUs;
+
+    // loop() side
+    uint32_t _applied;
+    uint32_t _late;
+    uint32_t _maxLatencyUs;
+};
+
+#endif // BUS_SERVICE_STATS_H
@@ -0,0 +1,82 @@
+#ifndef CHANGE_TRACKING_H
+#define CHANGE_TRACKING_H
+
+/*
+ * Skip hardware writes that would not change anything.
+ *
+ * AnalogHysteresis only follows an ADC reading once it moves more than a
+ * threshold away from the value it holds, so noise around a boundary does
+ * not toggle whatever is derived from it. LedShadow remembers the colour
+ * last pushed to a strip; changed() says whether a refresh is needed and
+ * counts the ones it saved.
+ */
+
+#include <stdint.h>
+
+class AnalogHysteresis {
+public:
+    explicit AnalogHysteresis(uint16_t threshold) : _threshold(threshold), _value(0), _primed(false) {}
+
+    /** @brief Feeds a reading. @return true if value() moved (always for the first one). */
+    bool update(int16_t reading) {
+        int16_t delta = reading > _value ? reading - _value : _value - reading;
+        if (_primed && delta <= (int16_t)_threshold) {
+            return false;
+        }
+        _value = reading;
+        _primed = true;
+        return true;
+    }
+
+    int16_t value() const { return _value; }
+    uint16_t threshold() const { return _threshold; }
+
+private:
+    uint16_t _threshold;
+    int16_t _value;
+    bool _primed;
+};
+
+class LedShadow {
+public:
+    LedShadow() : _red(0), _green(0), _blue(0), _valid(false), _pushed(0), _skipped(0) {}
+
+    /**
+     * @brief Whether the strip needs a refresh to show this colour.
+     *
+     * A true result is taken as pushed and remembered; a false one is
+     * counted as a saved refresh.
+     */
+    bool changed(uint8_t red, uint8_t green, uint8_t blue) {
+        if (_valid && red == _red && green == _green && blue == _blue) {
+            _skipped++;
+            return false;
+        }
+        _red = red;
+        _green = green;
+        _blue = blue;
+        _valid = true;
+        _pushed++;
+        return true;
+    }
+
+    /** @brief Forces the next changed() to return true, e.g. after writing the strip directly. */
+    void invalidate() { _valid = false; }
+
+    uint32_t pushed() const { return _pushed; }
+    uint32_t skipped() const { return _skipped; }
+    void resetCounters() {
+        _pushed = 0;
+        _skipped = 0;
+    }
+
+private:
+    uint8_t _red;
+    uint8_t _green;
+    uint8_t _blue;
+    bool _valid;
+    uint32_t _pushed;
+    uint32_t _skipped;
+};
+
+#endif // CHANGE_TRACKING_H
@@ -0,0 +1,35 @@
+#ifndef FLASH_TABLE_H
+#define FLASH_TABLE_H
+
+/*
+ * Constant tables in flash.
+ *
+ * On the ESP8266 plain const data is copied to RAM at boot; STARWIRE_FLASH
+ * keeps a table in flash instead, and flashRead() copies one entry out
+ * with aligned reads. Elsewhere (ESP32, host) const data already stays in
+ * flash or is ordinary memory, so both are no-ops.
+ */
+
+#include <string.h>
+
+#if defined(ESP8266)
+#include <pgmspace.h>
+#define STARWIRE_FLASH PROGMEM
+
+/** @brief Copy of *@p entry, which lives in a STARWIRE_FLASH table. */
+template <typename T>
+inline T flashRead(const T* entry) {
+    T value;
+    memcpy_P(&value, entry, sizeof(T));
+    return value;
+}
+#else
+#define STARWIRE_FLASH
+
+template <typename T>
+inline T flashRead(const T* entry) {
+    return *entry;
+}
+#endif
+
+#endif // FLASH_TABLE_H
@@ -0,0 +1,61 @@
+#include "fleet_state.h"
+
+#include <string.h>
+
+FleetState::FleetState() {
+    clear();
+}
+
+void FleetState::clear() {
+    memset(_nibbles, 0, sizeof(_nibbles));
+    _minId = 255;
+    _maxId = 0;
+}
+
+void FleetState::set(uint8_t slaveId, uint8_t cmd4) {
+    uint8_t& packed = _nibbles[slaveId >> 1];
+    cmd4 &= 0x0F;
+    packed = (slaveId & 1) ? (uint8_t)((packed & 0x0F) | (cmd4 << 4)) : (uint8_t)((packed & 0xF0) | cmd4);
+    // The covered range only grows; forgotten ids just go out as 0.
+    if (cmd4) {
+        if (slaveId < _minId) {
+            _minId = slaveId;
+        }
+        if (slaveId > _maxId) {
+            _maxId = slaveId;
+        }
+    }
+}
+
+uint8_t FleetState::get(uint8_t slaveId) const {
+    uint8_t packed = _nibbles[slaveId >> 1];
+    return (slaveId & 1) ? (packed >> 4) : (packed & 0x0F);
+}
+
+uint8_t FleetState::frameCount() const {
+    if (empty()) {
+        return 0;
+    }
+    return (uint8_t)((_maxId - _minId) / IDS_PER_FRAME + 1);
+}
+
+uint8_t FleetState::encodeFrame(uint8_t index, uint8_t* out) const {
+    if (index >= frameCount()) {
+        return 0;
+    }
+    uint16_t first = _minId + (uint16_t)index * IDS_PER_FRAME;
+    uint16_t last = first + IDS_PER_FRAME - 1;
+    if (last > _maxId) {
+        last = _maxId;
+    }
+
+    out[0] = (uint8_t)first;
+    uint8_t bytes = (uint8_t)((last - first) / 2 + 1);
+    memset(out + 1, 0, bytes);
+    for (uint16_t id = first; id <= last; id++) {
+        uint16_t offset = id - first;
+        uint8_t cmd4 = get((uint8_t)id);
+        out[1 + (offset >> 1)] |= (offset & 1) ? (uint8_t)(cmd4 << 4) : cmd4;
+    }
+    return 1 + bytes;
+}
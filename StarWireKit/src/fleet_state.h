@@ -0,0 +1,66 @@
+#ifndef FLEET_STATE_H
+#define FLEET_STATE_H
+
+/*
+ * Fleet sync frame: the cmd4 of every slave as a nibble array indexed by
+ * slave id, for idempotent periodic resyncs.
+ *
+ * Data layout (after [COM_PROT_COMMAND, 0, STARWIRE_CMD_FLEET_SYNC]):
+ *   [baseId][packed cmd4 nibbles]
+ * The nibble for id n sits at offset n - baseId, two per byte, low nibble
+ * first. 0 means "no state for this id". One frame covers 74 ids, so the
+ * whole 8-bit id space is four frames no matter how many slaves are online.
+ */
+
+#include <stdint.h>
+
+#include "starwire_frames.h"
+
+class FleetState {
+public:
+    static const uint8_t IDS_PER_FRAME = (STARWIRE_MAX_COMMAND_DATA - 1) * 2;
+
+    FleetState();
+
+    void clear();
+
+    /** @brief Records the state of one slave; 0 forgets it. */
+    void set(uint8_t slaveId, uint8_t cmd4);
+    uint8_t get(uint8_t slaveId) const;
+
+    bool empty() const { return _minId > _maxId; }
+
+    /** @brief Frames needed to cover every id with a state. */
+    uint8_t frameCount() const;
+
+    /**
+     * @brief Writes frame @p index of the sync to @p out.
+     * @param out At least STARWIRE_MAX_COMMAND_DATA bytes.
+     * @return Number of bytes written, 0 if @p index is out of range.
+     */
+    uint8_t encodeFrame(uint8_t index, uint8_t* out) const;
+
+private:
+    uint8_t _nibbles[128];
+    uint8_t _minId;
+    uint8_t _maxId;
+};
+
+/**
+ * @brief O(1) lookup of one slave's nibble in received fleet sync data.
+ * @param data Bytes after the 3-byte command header.
+ * @return The slave's cmd4, 0 if the frame does not carry it.
+ */
+inline uint8_t fleetFind(const uint8_t* data, uint16_t length, uint8_t slaveId) {
+    if (length < 2 || slaveId < data[0]) {
+        return 0;
+    }
+    uint16_t offset = slaveId - data[0];
+    if ((offset >> 1) + 1u >= length) {
+        return 0;
+    }
+    uint8_t packed = data[1 + (offset >> 1)];
+    return (offset & 1) ? (packed >> 4) : (packed & 0x0F);
+}
+
+#endif // FLEET_STATE_H
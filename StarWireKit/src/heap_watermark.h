@@ -0,0 +1,57 @@
+#ifndef HEAP_WATERMARK_H
+#define HEAP_WATERMARK_H
+
+/*
+ * Low-water marks of the heap, sampled from loop().
+ *
+ * Takes plain numbers so it stays free of Arduino headers; on the ESP8266
+ * feed it ESP.getFreeHeap() and ESP.getMaxFreeBlockSize(). A free heap that
+ * keeps sinking over a soak is a leak, a largest block that keeps shrinking
+ * while the free heap holds is fragmentation.
+ */
+
+#include <stdint.h>
+
+class HeapWatermark {
+public:
+    HeapWatermark() { reset(); }
+
+    void reset() {
+        _samples = 0;
+        _firstFree = 0;
+        _lastFree = 0;
+        _minFree = UINT32_MAX;
+        _minLargestBlock = UINT32_MAX;
+    }
+
+    void sample(uint32_t freeBytes, uint32_t largestBlock) {
+        if (_samples == 0) {
+            _firstFree = freeBytes;
+        }
+        _samples++;
+        _lastFree = freeBytes;
+        if (freeBytes < _minFree) {
+            _minFree = freeBytes;
+        }
+        if (largestBlock < _minLargestBlock) {
+            _minLargestBlock = largestBlock;
+        }
+    }
+
+    uint32_t samples() const { return _samples; }
+    uint32_t minFree() const { return _samples ? _minFree : 0; }
+    uint32_t minLargestBlock() const { return _samples ? _minLargestBlock : 0; }
+    uint32_t lastFree() const { return _lastFree; }
+
+    /** @brief Free heap lost since the first sample, negative if it grew. */
+    int32_t drift() const { return (int32_t)(_firstFree - _lastFree); }
+
+private:
+    uint32_t _samples;
+    uint32_t _firstFree;
+    uint32_t _lastFree;
+    uint32_t _minFree;
+    uint32_t _minLargestBlock;
+};
+
+#endif // HEAP_WATERMARK_H
@@ -0,0 +1,105 @@
+#include "heartbeat_schedule.h"
+
+HeartbeatScheduler::HeartbeatScheduler(uint8_t slaveId, const HeartbeatSchedule& schedule)
+    : _schedule(schedule), _nextMs(0), _lastActivityMs(0), _announcedMs(0), _backoff(0), _clean(0),
+      _idle(false) {
+    if (_schedule.intervalMs == 0) {
+        _schedule.intervalMs = HEARTBEAT_DEFAULT_MS;
+    }
+    if (_schedule.idleIntervalMs < _schedule.intervalMs) {
+        _schedule.idleIntervalMs = _schedule.intervalMs;
+    }
+    // Neighbouring ids must not get neighbouring phases
+    _rng = (slaveId + 1) * 2654435761UL;
+    if (_rng == 0) {
+        _rng = 1;
+    }
+}
+
+uint32_t HeartbeatScheduler::random() {
+    // xorshift32
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    return _rng;
+}
+
+void HeartbeatScheduler::begin(uint32_t nowMs) {
+    _lastActivityMs = nowMs;
+    _idle = false;
+    _nextMs = nowMs + random() % _schedule.intervalMs;
+}
+
+uint32_t HeartbeatScheduler::baseMs(bool idle, uint8_t backoff) const {
+    uint32_t base = idle ? _schedule.idleIntervalMs : _schedule.intervalMs;
+    return base * (2 + backoff) / 2;
+}
+
+uint8_t HeartbeatScheduler::schedule(uint32_t nowMs, uint32_t delayMs) {
+    if (!_idle && nowMs - _lastActivityMs >= _schedule.idleAfterMs) {
+        _idle = true;
+    }
+
+    uint32_t base = baseMs(_idle, _backoff);
+    uint32_t spread = base * _schedule.jitterPercent / 100;
+    _nextMs = nowMs + base - spread + random() % (2 * spread + 1);
+
+    // The master allows two announced intervals, so if this heartbeat is
+    // lost the gap after the next one must fit too: announce the longest
+    // of both, with one more back-off level and idle if it is due by then.
+    bool idleNext = _idle || _nextMs - _lastActivityMs >= _schedule.idleAfterMs;
+    uint8_t backoffNext = _backoff < _schedule.maxBackoff ? _backoff + 1 : _backoff;
+    uint32_t longest = baseMs(idleNext, backoffNext);
+    longest += longest * _schedule.jitterPercent / 100;
+    if (longest < base + spread) {
+        longest = base + spread;
+    }
+    longest += delayMs;
+
+    // Rounded up, so the master never expects us earlier than we come
+    uint32_t units = (longest + HEARTBEAT_INTERVAL_UNIT_MS - 1) / HEARTBEAT_INTERVAL_UNIT_MS;
+    if (units > 255) {
+        units = 255;
+    }
+    _announcedMs = units * HEARTBEAT_INTERVAL_UNIT_MS;
+    return (uint8_t)units;
+}
+
+void HeartbeatScheduler::transmitted(uint8_t attempts) {
+    if (attempts > 1) {
+        if (_backoff < _schedule.maxBackoff) {
+            _backoff++;
+        }
+        _clean = 0;
+    } else if (_backoff && ++_clean >= 4) {
+        _backoff--;
+        _clean = 0;
+    }
+}
+
+void HeartbeatScheduler::activity(uint32_t nowMs) {
+    _lastActivityMs = nowMs;
+    if (!_idle) {
+        return;
+    }
+    _idle = false;
+    // Only ever earlier than announced, so the master cannot time us out
+    uint32_t soon = nowMs + random() % _schedule.intervalMs;
+    if ((int32_t)(soon - _nextMs) < 0) {
+        _nextMs = soon;
+    }
+}
+
+bool parseHeartbeat(const uint8_t* payload, uint16_t length, HeartbeatFrame& out) {
+    if (length < 3) {
+        return false;
+    }
+    out.slaveId = payload[1];
+    out.slaveType = payload[2] & ~HEARTBEAT_ANNOUNCED;
+    out.announced = (payload[2] & HEARTBEAT_ANNOUNCED) && length >= 4 && payload[3];
+    uint8_t header = (payload[2] & HEARTBEAT_ANNOUNCED) ? 4 : 3;
+    out.intervalMs = out.announced ? payload[3] * HEARTBEAT_INTERVAL_UNIT_MS : HEARTBEAT_DEFAULT_MS;
+    out.extension = payload + (length > header ? header : length);
+    out.extensionLength = length > header ? (uint8_t)(length - header) : 0;
+    return true;
+}
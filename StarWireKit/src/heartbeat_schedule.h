@@ -0,0 +1,101 @@
+#ifndef HEARTBEAT_SCHEDULE_H
+#define HEARTBEAT_SCHEDULE_H
+
+/*
+ * Adaptive, jittered heartbeat timing.
+ *
+ * Slaves that power up together and beat every 1000 ms stay phase-locked
+ * and keep colliding on the bus. HeartbeatScheduler spreads them out:
+ *   - the first heartbeat lands at a phase drawn from the slave id,
+ *   - every gap is the interval +- jitterPercent, drawn anew each time,
+ *   - a heartbeat that found the medium busy stretches the interval by
+ *     half a step per level (up to maxBackoff), clean ones shrink it again,
+ *   - after idleAfterMs without activity (commands) the slave falls back
+ *     to idleIntervalMs; activity brings the short interval back at once.
+ *
+ * Every heartbeat announces the longest gap the slave may leave before
+ * one of its next two heartbeats (including a back-off step or the switch
+ * to idle on the way), so the master can time each slave out on its own
+ * schedule after two announced intervals without losing it to a single
+ * dropped heartbeat:
+ *   [COM_PROT_HEARTBEAT, slaveId, slaveType | HEARTBEAT_ANNOUNCED, interval/100 ms, extension...]
+ * Heartbeats without the flag are the plain 1 s ones.
+ */
+
+#include <stdint.h>
+
+static const uint8_t HEARTBEAT_ANNOUNCED = 0x80;        // flag in the slave type byte
+static const uint16_t HEARTBEAT_DEFAULT_MS = 1000;      // unannounced heartbeats
+static const uint16_t HEARTBEAT_INTERVAL_UNIT_MS = 100;
+
+struct HeartbeatSchedule {
+    uint16_t intervalMs = 1000;     // while active
+    uint16_t idleIntervalMs = 4000; // after idleAfterMs without activity
+    uint32_t idleAfterMs = 30000;
+    uint8_t jitterPercent = 20;     // every gap is the interval +- this
+    uint8_t maxBackoff = 2;         // busy-medium levels, +50 % of the interval each
+};
+
+class HeartbeatScheduler {
+public:
+    explicit HeartbeatScheduler(uint8_t slaveId, const HeartbeatSchedule& schedule = HeartbeatSchedule());
+
+    /** @brief Places the first heartbeat at the id's phase within one interval. */
+    void begin(uint32_t nowMs);
+
+    bool due(uint32_t nowMs) const { return (int32_t)(nowMs - _nextMs) >= 0; }
+
+    /**
+     * @brief Called as a heartbeat is built: picks the gap to the next one.
+     * @param delayMs How much later than due a heartbeat may go out (a TDMA cycle), announced on top.
+     * @return The interval to announce in this heartbeat, in HEARTBEAT_INTERVAL_UNIT_MS.
+     */
+    uint8_t schedule(uint32_t nowMs, uint32_t delayMs = 0);
+
+    /** @brief The heartbeat went out after @p attempts tries; more than one means the bus was busy. */
+    void transmitted(uint8_t attempts);
+
+    /** @brief Something happened (command, output change): leave idle. */
+    void activity(uint32_t nowMs);
+
+    uint32_t nextMs() const { return _nextMs; }
+    uint32_t announcedMs() const { return _announcedMs; }
+    uint8_t backoff() const { return _backoff; }
+    bool idle() const { return _idle; }
+
+private:
+    uint32_t random();
+    uint32_t baseMs(bool idle, uint8_t backoff) const;
+
+    HeartbeatSchedule _schedule;
+    uint32_t _rng;
+    uint32_t _nextMs;
+    uint32_t _lastActivityMs;
+    uint32_t _announcedMs;
+    uint8_t _backoff;
+    uint8_t _clean;
+    bool _idle;
+};
+
+/** @brief One received heartbeat, announced or not. */
+struct HeartbeatFrame {
+    uint8_t slaveId;
+    uint8_t slaveType;
+    uint16_t intervalMs;          // longest announced gap, HEARTBEAT_DEFAULT_MS if unannounced
+    bool announced;
+    const uint8_t* extension;     // bytes the sketch appended (telemetry.h)
+    uint8_t extensionLength;
+};
+
+/**
+ * @brief Splits a heartbeat payload ([COM_PROT_HEARTBEAT, ...]).
+ * @return false if it is too short to be one.
+ */
+bool parseHeartbeat(const uint8_t* payload, uint16_t length, HeartbeatFrame& out);
+
+/** @brief Master timeout for a slave announcing @p intervalMs: two intervals, like 2 s for 1 s. */
+inline uint32_t heartbeatTimeoutMs(uint16_t intervalMs) {
+    return 2UL * intervalMs;
+}
+
+#endif // HEARTBEAT_SCHEDULE_H
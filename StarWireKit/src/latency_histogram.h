@@ -0,0 +1,74 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+/*
+ * Fixed-size log2 histogram of microsecond latencies.
+ *
+ * Bucket 0 holds 0 us, bucket b holds [2^(b-1), 2^b) us, so 26 buckets
+ * cover up to ~33 s in 104 bytes. Percentiles are reported as the upper
+ * edge of their bucket: coarse, but allocation-free and O(1) to add to,
+ * which is what a bus task can afford.
+ */
+
+#include <stdint.h>
+
+class LatencyHistogram {
+public:
+    static const uint8_t BUCKETS = 26;
+
+    LatencyHistogram() { reset(); }
+
+    void reset() {
+        for (uint8_t i = 0; i < BUCKETS; i++) {
+            _buckets[i] = 0;
+        }
+        _count = 0;
+        _max = 0;
+    }
+
+    void add(uint32_t us) {
+        uint8_t bucket = us ? 32 - __builtin_clz(us) : 0;
+        if (bucket >= BUCKETS) {
+            bucket = BUCKETS - 1;
+        }
+        _buckets[bucket]++;
+        _count++;
+        if (us > _max) {
+            _max = us;
+        }
+    }
+
+    uint32_t count() const { return _count; }
+    uint32_t max() const { return _max; }
+    uint32_t bucket(uint8_t index) const { return _buckets[index]; }
+
+    /** @brief Upper edge in us of bucket @p index. */
+    static uint32_t bucketLimitUs(uint8_t index) { return index ? (1UL << index) - 1 : 0; }
+
+    /** @brief Latency below which a fraction @p q (0..1) of samples fall, rounded up to the bucket edge. */
+    uint32_t percentile(float q) const {
+        if (_count == 0) {
+            return 0;
+        }
+        uint32_t rank = (uint32_t)(q * _count + 0.5f);
+        if (rank == 0) {
+            rank = 1;
+        }
+        uint32_t seen = 0;
+        for (uint8_t i = 0; i < BUCKETS; i++) {
+            seen += _buckets[i];
+            if (seen >= rank) {
+                uint32_t limit = bucketLimitUs(i);
+                return limit < _max ? limit : _max;
+            }
+        }
+        return _max;
+    }
+
+private:
+    uint32_t _buckets[BUCKETS];
+    uint32_t _count;
+    uint32_t _max;
+};
+
+#endif // LATENCY_HISTOGRAM_H
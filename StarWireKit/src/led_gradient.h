@@ -0,0 +1,129 @@
+#ifndef LED_GRADIENT_H
+#define LED_GRADIENT_H
+
+/*
+ * Compile-time LED colour tables.
+ *
+ * Colours are written the way they look on a screen (0..255 perceived);
+ * ledOutput() turns one into the PWM values for a WS2812 by applying a
+ * gamma of 2.2 and multiplying in the brightness, so the strip can stay
+ * at setBrightness(255) and a level change is a single setColor().
+ *
+ * ledGradient() spreads any number of levels evenly over a list of colour
+ * stops, and makeLedLut<Levels>() fills a whole table with it. Everything
+ * is constexpr: the tables are built by the compiler, and with
+ * STARWIRE_FLASH (flash_table.h) they stay in flash.
+ */
+
+#include <stdint.h>
+
+struct LedColor {
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+};
+
+namespace led_detail {
+
+// x^(1/5) for 0 < x <= 1 by Newton's method, starting above the root
+constexpr double fifthRoot(double x, double y = 1.0, uint8_t iterations = 24) {
+    return iterations == 0 ? y : fifthRoot(x, (4.0 * y + x / (y * y * y * y)) / 5.0, iterations - 1);
+}
+
+// x^2.2 = x^2 * x^(1/5)
+constexpr double gamma22(double x) {
+    return x <= 0.0 ? 0.0 : x * x * fifthRoot(x);
+}
+
+constexpr uint8_t lerp8(uint8_t from, uint8_t to, uint16_t step, uint16_t steps) {
+    return steps == 0 ? from : (uint8_t)((from * (steps - step) + to * step + steps / 2) / steps);
+}
+
+constexpr LedColor lerp(LedColor from, LedColor to, uint16_t step, uint16_t steps) {
+    return {lerp8(from.red, to.red, step, steps), lerp8(from.green, to.green, step, steps),
+            lerp8(from.blue, to.blue, step, steps)};
+}
+
+// Stop index the position step * (stopCount - 1) / steps falls behind
+constexpr uint8_t segment(uint8_t stopCount, uint16_t step, uint16_t steps) {
+    return step >= steps ? stopCount - 2 : (uint8_t)((uint32_t)step * (stopCount - 1) / steps);
+}
+
+template <uint8_t... Levels>
+struct LevelList {};
+
+template <uint8_t Count, uint8_t... Levels>
+struct MakeLevels : MakeLevels<Count - 1, Count - 1, Levels...> {};
+
+template <uint8_t... Levels>
+struct MakeLevels<0, Levels...> {
+    typedef LevelList<Levels...> type;
+};
+
+} // namespace led_detail
+
+/** @brief PWM value for a perceived channel value (gamma 2.2). */
+constexpr uint8_t ledGamma(uint8_t value) {
+    return (uint8_t)(led_detail::gamma22(value / 255.0) * 255.0 + 0.5);
+}
+
+/** @brief Gamma-corrected @p color with @p brightness (0..255, linear like setBrightness()) multiplied in. */
+constexpr LedColor ledOutput(LedColor color, uint8_t brightness = 255) {
+    return {(uint8_t)((ledGamma(color.red) * brightness + 127) / 255),
+            (uint8_t)((ledGamma(color.green) * brightness + 127) / 255),
+            (uint8_t)((ledGamma(color.blue) * brightness + 127) / 255)};
+}
+
+/**
+ * @brief Colour of @p level out of @p levels, spread evenly over @p stopCount stops.
+ *
+ * Level 0 is the first stop, level levels - 1 the last. Interpolation
+ * happens on the perceived values, before ledOutput().
+ */
+constexpr LedColor ledGradient(const LedColor* stops, uint8_t stopCount, uint8_t level, uint8_t levels) {
+    return stopCount < 2 || levels < 2
+        ? stops[0]
+        : led_detail::lerp(stops[led_detail::segment(stopCount, level, levels - 1)],
+                           stops[led_detail::segment(stopCount, level, levels - 1) + 1],
+                           (uint32_t)level * (stopCount - 1) - (uint32_t)led_detail::segment(stopCount, level, levels - 1) * (levels - 1),
+                           levels - 1);
+}
+
+/** @brief Brightness of @p level when it ramps from @p from to @p to over @p levels. */
+constexpr uint8_t ledRamp(uint8_t from, uint8_t to, uint8_t level, uint8_t levels) {
+    return levels < 2 ? to : led_detail::lerp8(from, to, level, levels - 1);
+}
+
+/** @brief Output colours of every level, ready for setColor(). */
+template <uint8_t Levels>
+struct LedLut {
+    LedColor colors[Levels];
+
+    static constexpr uint8_t levels() { return Levels; }
+};
+
+namespace led_detail {
+
+template <uint8_t Levels, uint8_t... Level>
+constexpr LedLut<Levels> makeLut(const LedColor* stops, uint8_t stopCount, uint8_t brightnessFrom,
+                                 uint8_t brightnessTo, LevelList<Level...>) {
+    return {{ledOutput(ledGradient(stops, stopCount, Level, Levels), ledRamp(brightnessFrom, brightnessTo, Level, Levels))...}};
+}
+
+} // namespace led_detail
+
+/**
+ * @brief Table of @p Levels output colours over @p stops, brightness ramping
+ * from @p brightnessFrom at level 0 to @p brightnessTo at the last level.
+ */
+template <uint8_t Levels>
+constexpr LedLut<Levels> makeLedLut(const LedColor* stops, uint8_t stopCount, uint8_t brightnessFrom = 255,
+                                    uint8_t brightnessTo = 255) {
+    return led_detail::makeLut<Levels>(stops, stopCount, brightnessFrom, brightnessTo,
+                                       typename led_detail::MakeLevels<Levels>::type());
+}
+
+static_assert(ledGamma(0) == 0 && ledGamma(255) == 255, "gamma must keep the end points");
+static_assert(ledGamma(128) == 56, "gamma 2.2 of mid grey");
+
+#endif // LED_GRADIENT_H
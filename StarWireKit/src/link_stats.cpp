@@ -0,0 +1,96 @@
+#include "link_stats.h"
+
+// LatencyHistogram bucket b holds [2^(b-1), 2^b) us; report bucket 0 takes
+// everything below 128 us, 1..6 one step each, the last everything above.
+static const uint8_t FIRST_FOLDED = 7;
+
+static uint8_t reportBucket(uint8_t histogramBucket) {
+    if (histogramBucket <= FIRST_FOLDED) {
+        return 0;
+    }
+    uint8_t bucket = histogramBucket - FIRST_FOLDED;
+    return bucket < LINK_STATS_LOOP_BUCKETS ? bucket : LINK_STATS_LOOP_BUCKETS - 1;
+}
+
+static uint8_t* put16(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    return out + 2;
+}
+
+static uint8_t* put32(uint8_t* out, uint32_t value) {
+    put16(out, value);
+    return put16(out + 2, value >> 16);
+}
+
+static uint32_t get16(const uint8_t* data) {
+    return data[0] | ((uint32_t)data[1] << 8);
+}
+
+static uint32_t get32(const uint8_t* data) {
+    return get16(data) | (get16(data + 2) << 16);
+}
+
+uint32_t linkStatsLoopLimitUs(uint8_t bucket) {
+    if (bucket >= LINK_STATS_LOOP_BUCKETS - 1) {
+        return UINT32_MAX;
+    }
+    return LatencyHistogram::bucketLimitUs(FIRST_FOLDED + bucket);
+}
+
+uint8_t linkStatsEncode(const LinkCounters& link, uint32_t maxUpdateGapUs, const LatencyHistogram& loop,
+                        uint8_t* out) {
+    uint8_t* p = out;
+    *p++ = LINK_STATS_VERSION;
+    p = put32(p, link.framesSent);
+    p = put32(p, link.framesReceived);
+    p = put32(p, link.bytesSent);
+    p = put32(p, link.bytesReceived);
+    p = put16(p, link.crcErrors);
+    p = put16(p, link.retries);
+    p = put32(p, maxUpdateGapUs);
+    p = put32(p, loop.max());
+
+    uint32_t counts[LINK_STATS_LOOP_BUCKETS] = {};
+    for (uint8_t i = 0; i < LatencyHistogram::BUCKETS; i++) {
+        counts[reportBucket(i)] += loop.bucket(i);
+    }
+    uint32_t total = loop.count();
+    for (uint8_t i = 0; i < LINK_STATS_LOOP_BUCKETS; i++) {
+        // 64-bit: counts since boot times 255 overflow after a few hours
+        *p++ = total ? (uint8_t)(((uint64_t)counts[i] * 255 + total / 2) / total) : 0;
+    }
+    return (uint8_t)(p - out);
+}
+
+bool linkStatsParse(const uint8_t* data, uint16_t length, LinkStatsReport& out) {
+    if (length < LINK_STATS_LENGTH || data[0] != LINK_STATS_VERSION) {
+        return false;
+    }
+    const uint8_t* p = data + 1;
+    out.link.framesSent = get32(p);
+    out.link.framesReceived = get32(p + 4);
+    out.link.bytesSent = get32(p + 8);
+    out.link.bytesReceived = get32(p + 12);
+    out.link.crcErrors = get16(p + 16);
+    out.link.retries = get16(p + 18);
+    out.maxUpdateGapUs = get32(p + 20);
+    out.loopMaxUs = get32(p + 24);
+    for (uint8_t i = 0; i < LINK_STATS_LOOP_BUCKETS; i++) {
+        out.loopShare[i] = p[28 + i];
+    }
+    return true;
+}
+
+uint32_t linkStatsLoopPercentileUs(const LinkStatsReport& report, float q) {
+    uint32_t rank = (uint32_t)(q * 255 + 0.5f);
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < LINK_STATS_LOOP_BUCKETS; i++) {
+        seen += report.loopShare[i];
+        if (seen >= rank && report.loopShare[i]) {
+            uint32_t limit = linkStatsLoopLimitUs(i);
+            return limit < report.loopMaxUs ? limit : report.loopMaxUs;
+        }
+    }
+    return report.loopMaxUs;
+}
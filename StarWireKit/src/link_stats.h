@@ -0,0 +1,88 @@
+#ifndef LINK_STATS_H
+#define LINK_STATS_H
+
+/*
+ * Link health of one bus node and the frame that carries it.
+ *
+ * When the grid lags, these tell CRC failures, busy-medium retries and a
+ * slow loop apart. LinkCounters are kept by com-prot on every node (builds
+ * with COM_PROT_LINK_STATS); the sketch adds how often it gets round to
+ * slave.update() (BusServiceStats) and its loop time (LatencyHistogram).
+ * Against a com-prot without them the sketch counts the frames it hands
+ * over and the ones its debug hook sees (linkCountSent/Received); frames the
+ * library handles alone, CRC errors and retries are not visible there.
+ * The master asks one slave at a time with
+ *   [COM_PROT_COMMAND, 0, STARWIRE_CMD_LINK_STATS]
+ * and the slave answers
+ *   [COM_PROT_RESPONSE, STARWIRE_CMD_LINK_STATS, version,
+ *    framesSent:4, framesReceived:4, bytesSent:4, bytesReceived:4,
+ *    crcErrors:2, retries:2, maxUpdateGapUs:4, loopMaxUs:4, loopShare:8]
+ * little endian. Everything counts since boot and wraps, so the master
+ * diffs two reports for rates. loopShare is the loop time histogram folded
+ * to LINK_STATS_LOOP_BUCKETS log2 buckets, each as a share of 255.
+ */
+
+#include <stdint.h>
+
+#include "latency_histogram.h"
+#include "starwire_frames.h"
+
+struct LinkCounters {
+    uint32_t framesSent = 0;     // transmissions started
+    uint32_t framesReceived = 0; // intact frames for us (unicast or broadcast)
+    uint32_t bytesSent = 0;      // on the wire, frame overhead included
+    uint32_t bytesReceived = 0;
+    uint32_t crcErrors = 0;      // frames for us that failed the CRC (noise, collisions)
+    uint32_t retries = 0;        // attempts postponed because the medium was busy
+};
+
+/** @brief Counts a frame the sketch handed to com-prot; @p payloadLength includes the com-prot header. */
+inline void linkCountSent(LinkCounters& link, uint16_t payloadLength) {
+    link.framesSent++;
+    link.bytesSent += payloadLength + STARWIRE_FRAME_OVERHEAD;
+}
+
+/** @brief Counts a frame the sketch's debug hook saw. */
+inline void linkCountReceived(LinkCounters& link, uint16_t payloadLength) {
+    link.framesReceived++;
+    link.bytesReceived += payloadLength + STARWIRE_FRAME_OVERHEAD;
+}
+
+static const uint8_t LINK_STATS_VERSION = 1;
+static const uint8_t LINK_STATS_LOOP_BUCKETS = 8;
+static const uint8_t LINK_STATS_LENGTH = 37; // report bytes after the 2-byte response header
+
+/** @brief One decoded report. crcErrors and retries only keep their low 16 bits. */
+struct LinkStatsReport {
+    LinkCounters link;
+    uint32_t maxUpdateGapUs;
+    uint32_t loopMaxUs;
+    uint8_t loopShare[LINK_STATS_LOOP_BUCKETS];
+};
+
+/**
+ * @brief Upper edge in us of report loop bucket @p bucket: < 128 us, then
+ * one log2 step each up to 8 ms; the last one is open.
+ */
+uint32_t linkStatsLoopLimitUs(uint8_t bucket);
+
+/**
+ * @brief Writes a report.
+ * @param maxUpdateGapUs Longest time between two slave.update() calls.
+ * @param out At least LINK_STATS_LENGTH bytes.
+ * @return Number of bytes written.
+ */
+uint8_t linkStatsEncode(const LinkCounters& link, uint32_t maxUpdateGapUs, const LatencyHistogram& loop,
+                        uint8_t* out);
+
+/**
+ * @brief Reads a received report.
+ * @param data Bytes after the 2-byte response header.
+ * @return false if malformed or from a newer version.
+ */
+bool linkStatsParse(const uint8_t* data, uint16_t length, LinkStatsReport& out);
+
+/** @brief Loop time below which a fraction @p q of loops fall, as a report bucket edge. */
+uint32_t linkStatsLoopPercentileUs(const LinkStatsReport& report, float q);
+
+#endif // LINK_STATS_H
@@ -0,0 +1,94 @@
+#ifndef MESSAGE_BUILDER_H
+#define MESSAGE_BUILDER_H
+
+/*
+ * Fixed-capacity frame builder for the send path.
+ *
+ * Lives on the stack (or in a static), so sending a frame never touches the
+ * heap; long sessions on the ESP8266 otherwise fragment it one new[]/delete[]
+ * per message. Writes past the capacity are dropped and flagged instead of
+ * overflowing, check ok() before sending.
+ *
+ *   MessageBuilder<> message;
+ *   message.command(slaveType, CMD_LED_CONTROL).put(ledState);
+ *   if (message.ok()) bus.send_packet(0, message.data(), message.length());
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "starwire_frames.h"
+
+template <uint8_t Capacity = STARWIRE_MAX_PAYLOAD>
+class MessageBuilder {
+public:
+    static_assert(Capacity > 0, "MessageBuilder needs room for at least the message type");
+
+    MessageBuilder() : _length(0), _overflow(false) {}
+
+    MessageBuilder& clear() {
+        _length = 0;
+        _overflow = false;
+        return *this;
+    }
+
+    /** @brief Starts a [STARWIRE_MSG_COMMAND, targetType, command] frame. */
+    MessageBuilder& command(uint8_t targetType, uint8_t command) {
+        return clear().put(STARWIRE_MSG_COMMAND).put(targetType).put(command);
+    }
+
+    /** @brief Starts a [STARWIRE_MSG_RESPONSE, command] frame. */
+    MessageBuilder& response(uint8_t command) {
+        return clear().put(STARWIRE_MSG_RESPONSE).put(command);
+    }
+
+    /** @brief Starts a [STARWIRE_MSG_HEARTBEAT, slaveId, slaveType] frame. */
+    MessageBuilder& heartbeat(uint8_t slaveId, uint8_t slaveType) {
+        return clear().put(STARWIRE_MSG_HEARTBEAT).put(slaveId).put(slaveType);
+    }
+
+    MessageBuilder& put(uint8_t value) {
+        if (_length < Capacity) {
+            _buffer[_length++] = value;
+        } else {
+            _overflow = true;
+        }
+        return *this;
+    }
+
+    /** @brief Appends @p length bytes; a null @p data appends nothing. */
+    MessageBuilder& put(const uint8_t* data, uint8_t length) {
+        if (!data || length == 0) {
+            return *this;
+        }
+        if (length > remaining()) {
+            _overflow = true;
+            return *this;
+        }
+        memcpy(_buffer + _length, data, length);
+        _length += length;
+        return *this;
+    }
+
+    /** @brief Appends the raw bytes of @p value (host byte order, like the sketches' memcpy). */
+    template <typename T>
+    MessageBuilder& putValue(const T& value) {
+        return put(reinterpret_cast<const uint8_t*>(&value), (uint8_t)sizeof(T));
+    }
+
+    const uint8_t* data() const { return _buffer; }
+    uint8_t* data() { return _buffer; }
+    uint8_t length() const { return _length; }
+    uint8_t remaining() const { return Capacity - _length; }
+    static uint8_t capacity() { return Capacity; }
+
+    /** @brief false if a put() did not fit; the frame is then incomplete and must not be sent. */
+    bool ok() const { return !_overflow; }
+
+private:
+    uint8_t _buffer[Capacity];
+    uint8_t _length;
+    bool _overflow;
+};
+
+#endif // MESSAGE_BUILDER_H
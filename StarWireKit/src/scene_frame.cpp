@@ -0,0 +1,116 @@
+#include "scene_frame.h"
+
+static inline uint8_t nibbleAt(const uint8_t* nibbles, uint8_t index) {
+    uint8_t packed = nibbles[index >> 1];
+    return (index & 1) ? (packed >> 4) : (packed & 0x0F);
+}
+
+SceneBuilder::SceneBuilder() {
+    clear();
+}
+
+void SceneBuilder::clear() {
+    _typeMask = 0;
+    _idCount = 0;
+}
+
+uint8_t SceneBuilder::typeCount() const {
+    uint8_t count = 0;
+    for (uint8_t mask = _typeMask; mask; mask &= mask - 1) {
+        count++;
+    }
+    return count;
+}
+
+bool SceneBuilder::setType(uint8_t type, uint8_t cmd4) {
+    if (type < 1 || type > MAX_TYPES) {
+        return false;
+    }
+    uint8_t bit = 1 << (type - 1);
+    if (!(_typeMask & bit) && encodedLength(typeCount() + 1, _idCount) > STARWIRE_MAX_COMMAND_DATA) {
+        return false;
+    }
+    _typeMask |= bit;
+    _typeCmd[type - 1] = cmd4 & 0x0F;
+    return true;
+}
+
+bool SceneBuilder::setSlave(uint8_t slaveId, uint8_t cmd4) {
+    for (uint8_t i = 0; i < _idCount; i++) {
+        if (_ids[i] == slaveId) {
+            _idCmd[i] = cmd4 & 0x0F;
+            return true;
+        }
+    }
+    if (_idCount >= MAX_IDS || encodedLength(typeCount(), _idCount + 1) > STARWIRE_MAX_COMMAND_DATA) {
+        return false;
+    }
+    _ids[_idCount] = slaveId;
+    _idCmd[_idCount] = cmd4 & 0x0F;
+    _idCount++;
+    return true;
+}
+
+uint8_t SceneBuilder::encode(uint8_t* out) const {
+    out[0] = _typeMask;
+    out[1] = _idCount;
+    for (uint8_t i = 0; i < _idCount; i++) {
+        out[2 + i] = _ids[i];
+    }
+
+    uint8_t* nibbles = out + 2 + _idCount;
+    uint8_t index = 0;
+    auto put = [&](uint8_t cmd4) {
+        if (index & 1) {
+            nibbles[index >> 1] |= cmd4 << 4;
+        } else {
+            nibbles[index >> 1] = cmd4;
+        }
+        index++;
+    };
+    for (uint8_t t = 0; t < MAX_TYPES; t++) {
+        if (_typeMask & (1 << t)) {
+            put(_typeCmd[t]);
+        }
+    }
+    for (uint8_t i = 0; i < _idCount; i++) {
+        put(_idCmd[i]);
+    }
+    return 2 + _idCount + (index + 1) / 2;
+}
+
+bool sceneFind(const uint8_t* data, uint16_t length, uint8_t slaveId, uint8_t slaveType, uint8_t* cmd4) {
+    if (length < 2) {
+        return false;
+    }
+    uint8_t typeMask = data[0];
+    uint8_t idCount = data[1];
+    uint8_t types = 0;
+    for (uint8_t mask = typeMask; mask; mask &= mask - 1) {
+        types++;
+    }
+    if (length < SceneBuilder::encodedLength(types, idCount)) {
+        return false;
+    }
+
+    const uint8_t* ids = data + 2;
+    const uint8_t* nibbles = ids + idCount;
+    for (uint8_t i = 0; i < idCount; i++) {
+        if (ids[i] == slaveId) {
+            *cmd4 = nibbleAt(nibbles, types + i);
+            return true;
+        }
+    }
+
+    if (slaveType < 1 || slaveType > SceneBuilder::MAX_TYPES || !(typeMask & (1 << (slaveType - 1)))) {
+        return false;
+    }
+    // Position among the selected types = set bits below ours.
+    uint8_t below = typeMask & ((1 << (slaveType - 1)) - 1);
+    uint8_t index = 0;
+    for (; below; below &= below - 1) {
+        index++;
+    }
+    *cmd4 = nibbleAt(nibbles, index);
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef SCENE_FRAME_H
+#define SCENE_FRAME_H
+
+/*
+ * Scene frame: one broadcast that sets the 4-bit command of many slaves.
+ *
+ * Data layout (after [COM_PROT_COMMAND, 0, STARWIRE_CMD_SCENE]):
+ *   [typeMask][idCount][id 0 .. id n-1][packed cmd4 nibbles]
+ * typeMask bit (t - 1) selects every slave of type t (1..8). Nibbles come
+ * two per byte, low nibble first: one per selected type in ascending type
+ * order, then one per listed id. A slave listed by id uses that entry,
+ * otherwise the entry of its type, otherwise the scene does not concern it.
+ *
+ * A full 8-type grid refresh is 14 data bytes, a per-slave scene fits up to
+ * 24 ids (21 next to all eight types) in one frame.
+ */
+
+#include <stdint.h>
+
+#include "starwire_frames.h"
+
+class SceneBuilder {
+public:
+    static const uint8_t MAX_TYPES = 8;
+    static const uint8_t MAX_IDS = 24;
+
+    SceneBuilder();
+
+    void clear();
+
+    /** @brief Sets @p cmd4 for every slave of @p type (1..8). @return false if out of range or full. */
+    bool setType(uint8_t type, uint8_t cmd4);
+
+    /** @brief Sets @p cmd4 for one slave; replaces an earlier entry. @return false if the frame is full. */
+    bool setSlave(uint8_t slaveId, uint8_t cmd4);
+
+    bool empty() const { return _typeMask == 0 && _idCount == 0; }
+    uint8_t typeCount() const;
+    uint8_t idCount() const { return _idCount; }
+
+    /** @brief Data bytes encode() will produce. */
+    uint8_t length() const { return encodedLength(typeCount(), _idCount); }
+
+    /**
+     * @brief Writes the scene data to @p out.
+     * @param out At least STARWIRE_MAX_COMMAND_DATA bytes.
+     * @return Number of bytes written.
+     */
+    uint8_t encode(uint8_t* out) const;
+
+    static uint8_t encodedLength(uint8_t types, uint8_t ids) {
+        return 2 + ids + (uint8_t)((types + ids + 1) / 2);
+    }
+
+private:
+    uint8_t _typeMask;
+    uint8_t _typeCmd[MAX_TYPES];
+    uint8_t _idCount;
+    uint8_t _ids[MAX_IDS];
+    uint8_t _idCmd[MAX_IDS];
+};
+
+/**
+ * @brief Looks up the entry for one slave in received scene data.
+ * @param data Bytes after the 3-byte command header.
+ * @param cmd4 Set to the slave's command when found.
+ * @return false if the scene has no entry for this slave or is malformed.
+ */
+bool sceneFind(const uint8_t* data, uint16_t length, uint8_t slaveId, uint8_t slaveType, uint8_t* cmd4);
+
+#endif // SCENE_FRAME_H
@@ -0,0 +1,160 @@
+#include "slave_registry.h"
+
+#include <string.h>
+
+SlaveRegistry::SlaveRegistry(uint32_t timeoutMs) : _timeoutMs(timeoutMs) {
+    // Every deadline has to land less than one lap ahead of the cursor.
+    _tickMs = (timeoutMs + WHEEL_SLOTS - 2) / (WHEEL_SLOTS - 1);
+    if (_tickMs == 0) {
+        _tickMs = 1;
+    }
+    _timeoutTicks = (timeoutMs + _tickMs - 1) / _tickMs;
+    clear();
+}
+
+void SlaveRegistry::clear() {
+    _clockMs = 0;
+    _remainderMs = 0;
+    _nowTick = 0;
+    _cursorTick = 0;
+    _started = false;
+    memset(_type, 0, sizeof(_type));
+    memset(_deadline, 0, sizeof(_deadline));
+    memset(_next, NONE, sizeof(_next));
+    memset(_prev, NONE, sizeof(_prev));
+    memset(_wheel, NONE, sizeof(_wheel));
+    memset(_online, 0, sizeof(_online));
+    memset(_byType, 0, sizeof(_byType));
+    memset(_typeCount, 0, sizeof(_typeCount));
+    _count = 0;
+}
+
+void SlaveRegistry::advance(uint32_t nowMs) {
+    if (!_started) {
+        _clockMs = nowMs;
+        _started = true;
+        return;
+    }
+    _remainderMs += nowMs - _clockMs;
+    _clockMs = nowMs;
+    _nowTick += _remainderMs / _tickMs;
+    _remainderMs %= _tickMs;
+}
+
+void SlaveRegistry::link(uint8_t slaveId) {
+    uint8_t slot = _deadline[slaveId] % WHEEL_SLOTS;
+    _prev[slaveId] = NONE;
+    _next[slaveId] = _wheel[slot];
+    if (_wheel[slot] != NONE) {
+        _prev[_wheel[slot]] = slaveId;
+    }
+    _wheel[slot] = slaveId;
+}
+
+void SlaveRegistry::unlink(uint8_t slaveId) {
+    if (_prev[slaveId] != NONE) {
+        _next[_prev[slaveId]] = _next[slaveId];
+    } else {
+        _wheel[_deadline[slaveId] % WHEEL_SLOTS] = _next[slaveId];
+    }
+    if (_next[slaveId] != NONE) {
+        _prev[_next[slaveId]] = _prev[slaveId];
+    }
+    _next[slaveId] = NONE;
+    _prev[slaveId] = NONE;
+}
+
+bool SlaveRegistry::heartbeat(uint8_t slaveId, uint8_t slaveType, uint32_t nowMs, uint32_t timeoutMs) {
+    if (slaveId == NONE) {
+        return false;
+    }
+    advance(nowMs);
+
+    bool fresh = !isOnline(slaveId);
+    if (!fresh) {
+        unlink(slaveId);
+        if (_type[slaveId] != slaveType && _type[slaveId] < MAX_TYPES) {
+            clearBit(_byType[_type[slaveId]], slaveId);
+            _typeCount[_type[slaveId]]--;
+        }
+    }
+    if ((fresh || _type[slaveId] != slaveType) && slaveType < MAX_TYPES) {
+        setBit(_byType[slaveType], slaveId);
+        _typeCount[slaveType]++;
+    }
+    if (fresh) {
+        setBit(_online, slaveId);
+        _count++;
+    }
+    _type[slaveId] = slaveType;
+    // The partial tick we are in counts as started, so never expire early.
+    uint32_t timeoutTicks = timeoutMs ? (timeoutMs + _tickMs - 1) / _tickMs : _timeoutTicks;
+    _deadline[slaveId] = _nowTick + timeoutTicks + (_remainderMs ? 1 : 0);
+    link(slaveId);
+    return fresh;
+}
+
+void SlaveRegistry::remove(uint8_t slaveId) {
+    if (!isOnline(slaveId)) {
+        return;
+    }
+    unlink(slaveId);
+    clearBit(_online, slaveId);
+    _count--;
+    if (_type[slaveId] < MAX_TYPES) {
+        clearBit(_byType[_type[slaveId]], slaveId);
+        _typeCount[_type[slaveId]]--;
+    }
+}
+
+uint8_t SlaveRegistry::expire(uint32_t nowMs, ExpiredHandler handler) {
+    advance(nowMs);
+    // Slots from the cursor up to the current tick can hold expired slaves.
+    // After a long pause every slot is due, but then entries that sit a lap
+    // ahead are still checked against their own deadline.
+    if ((int32_t)(_nowTick - _cursorTick) < 0) {
+        return 0;
+    }
+    uint32_t due = _nowTick - _cursorTick + 1;
+    if (due > WHEEL_SLOTS) {
+        due = WHEEL_SLOTS;
+    }
+
+    uint8_t dropped = 0;
+    for (uint32_t i = 0; i < due; i++) {
+        uint8_t id = _wheel[(_cursorTick + i) % WHEEL_SLOTS];
+        while (id != NONE) {
+            uint8_t next = _next[id];
+            if ((int32_t)(_deadline[id] - _nowTick) <= 0) {
+                uint8_t type = _type[id];
+                remove(id);
+                dropped++;
+                if (handler) {
+                    handler(id, type);
+                }
+            }
+            id = next;
+        }
+    }
+    _cursorTick = _nowTick + 1;
+    return dropped;
+}
+
+bool SlaveRegistry::hasSlaveOfType(uint8_t slaveType) const {
+    if (slaveType < MAX_TYPES) {
+        return _typeCount[slaveType] != 0;
+    }
+    return !slavesOfType(slaveType).empty();
+}
+
+uint8_t SlaveRegistry::countOfType(uint8_t slaveType) const {
+    if (slaveType < MAX_TYPES) {
+        return _typeCount[slaveType];
+    }
+    uint8_t count = 0;
+    for (Slave slave : slavesOfType(slaveType)) {
+        (void)slave;
+        count++;
+    }
+    return count;
+}
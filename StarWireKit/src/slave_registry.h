@@ -0,0 +1,179 @@
+#ifndef SLAVE_REGISTRY_H
+#define SLAVE_REGISTRY_H
+
+/*
+ * Online slaves on the master, indexed directly by the 8-bit PJON id.
+ *
+ * Heartbeats, "is slave n online", "is any slave of type t online" and
+ * expiry are all O(1) no matter how many slaves are on the bus:
+ *   - per-id arrays instead of a list to scan,
+ *   - an online bitset per type (plus a count) for type queries,
+ *   - a timing wheel for timeouts: each slave sits in the slot of the tick
+ *     its heartbeat runs out in, so expire() only looks at slots that came
+ *     due since the last call instead of at every slave.
+ * Expiry is up to one wheel tick (timeout / 31) late. Slaves can bring a
+ * longer timeout of their own (an announced heartbeat interval); they sit
+ * a lap or more ahead and are skipped until due. Time only moves by
+ * millis() differences, so the 49-day millis() wrap is harmless.
+ *
+ * Fixed size (~2.3 KB), no heap.
+ */
+
+#include <stdint.h>
+
+class SlaveRegistry {
+public:
+    static const uint8_t MAX_TYPES = 16;     // types 0..15 are indexed, others fall back to a scan
+    static const uint8_t WHEEL_SLOTS = 32;
+
+    typedef void (*ExpiredHandler)(uint8_t slaveId, uint8_t slaveType);
+
+    explicit SlaveRegistry(uint32_t timeoutMs = 5000);
+
+    void clear();
+
+    /**
+     * @brief Records a heartbeat at @p nowMs (millis()).
+     * @param timeoutMs This slave's timeout until its next heartbeat, 0 = the registry's.
+     * @return true if the slave was not online before.
+     */
+    bool heartbeat(uint8_t slaveId, uint8_t slaveType, uint32_t nowMs, uint32_t timeoutMs = 0);
+
+    /** @brief Takes a slave offline right away. */
+    void remove(uint8_t slaveId);
+
+    /**
+     * @brief Drops slaves whose last heartbeat is older than the timeout.
+     * @param handler Called for every slave that went offline, may be nullptr.
+     * @return Number of slaves dropped.
+     */
+    uint8_t expire(uint32_t nowMs, ExpiredHandler handler = nullptr);
+
+    bool isOnline(uint8_t slaveId) const { return _online[slaveId >> 5] & (1UL << (slaveId & 31)); }
+    uint8_t typeOf(uint8_t slaveId) const { return _type[slaveId]; }
+
+    bool hasSlaveOfType(uint8_t slaveType) const;
+    uint8_t countOfType(uint8_t slaveType) const;
+    uint8_t count() const { return _count; }
+    uint32_t timeoutMs() const { return _timeoutMs; }
+
+    /** @brief One online slave, as yielded by the views and visitors. */
+    struct Slave {
+        uint8_t id;
+        uint8_t type;
+    };
+
+    /**
+     * @brief Range over the online slaves (optionally of one type), in id order.
+     *
+     * Walks the registry's bitsets in place; nothing is copied, so it is only
+     * valid until the next heartbeat()/expire().
+     *
+     *   for (SlaveRegistry::Slave slave : registry.slavesOfType(4)) { ... }
+     */
+    class View {
+    public:
+        class Iterator {
+        public:
+            Iterator(const SlaveRegistry* registry, const uint32_t* bits, int16_t filter, uint16_t id)
+                : _registry(registry), _bits(bits), _filter(filter), _id(id) {
+                seek();
+            }
+
+            Slave operator*() const { return {(uint8_t)_id, _registry->_type[_id]}; }
+            Iterator& operator++() {
+                _id++;
+                seek();
+                return *this;
+            }
+            bool operator!=(const Iterator& other) const { return _id != other._id; }
+
+        private:
+            void seek() {
+                while (_id < 256) {
+                    uint32_t pending = _bits[_id >> 5] >> (_id & 31);
+                    if (!pending) {
+                        _id = (_id | 31) + 1;
+                        continue;
+                    }
+                    _id += __builtin_ctz(pending);
+                    if (_filter < 0 || _registry->_type[_id] == _filter) {
+                        return;
+                    }
+                    _id++;
+                }
+            }
+
+            const SlaveRegistry* _registry;
+            const uint32_t* _bits;
+            int16_t _filter;
+            uint16_t _id;
+        };
+
+        View(const SlaveRegistry* registry, const uint32_t* bits, int16_t filter)
+            : _registry(registry), _bits(bits), _filter(filter) {}
+
+        Iterator begin() const { return Iterator(_registry, _bits, _filter, 0); }
+        Iterator end() const { return Iterator(_registry, _bits, _filter, 256); }
+        bool empty() const { return !(begin() != end()); }
+
+    private:
+        const SlaveRegistry* _registry;
+        const uint32_t* _bits;
+        int16_t _filter;
+    };
+
+    View slaves() const { return View(this, _online, -1); }
+
+    View slavesOfType(uint8_t slaveType) const {
+        // Indexed types walk their own bitset, others filter the online set.
+        return slaveType < MAX_TYPES ? View(this, _byType[slaveType], -1) : View(this, _online, slaveType);
+    }
+
+    /** @brief Calls fn(id, type) for every online slave, in id order. */
+    template <typename Fn>
+    void forEachSlave(Fn fn) const {
+        for (Slave slave : slaves()) {
+            fn(slave.id, slave.type);
+        }
+    }
+
+    /** @brief Calls fn(id, type) for every online slave of @p slaveType, in id order. */
+    template <typename Fn>
+    void forEachSlave(uint8_t slaveType, Fn fn) const {
+        for (Slave slave : slavesOfType(slaveType)) {
+            fn(slave.id, slave.type);
+        }
+    }
+
+private:
+    static const uint8_t NONE = 0; // id 0 is the broadcast address, never a slave
+
+    void advance(uint32_t nowMs);
+    void link(uint8_t slaveId);
+    void unlink(uint8_t slaveId);
+    void setBit(uint32_t* bits, uint8_t slaveId) { bits[slaveId >> 5] |= 1UL << (slaveId & 31); }
+    void clearBit(uint32_t* bits, uint8_t slaveId) { bits[slaveId >> 5] &= ~(1UL << (slaveId & 31)); }
+
+    uint32_t _timeoutMs;
+    uint32_t _tickMs;
+    uint32_t _timeoutTicks;
+    uint32_t _clockMs;      // nowMs of the last call
+    uint32_t _remainderMs;  // part of a tick not counted yet
+    uint32_t _nowTick;
+    uint32_t _cursorTick;   // next wheel tick expire() has to look at
+    bool _started;
+
+    uint8_t _type[256];
+    uint32_t _deadline[256]; // tick the slave expires after
+    uint8_t _next[256];     // wheel slot lists, NONE terminated
+    uint8_t _prev[256];
+    uint8_t _wheel[WHEEL_SLOTS];
+
+    uint32_t _online[8];
+    uint32_t _byType[MAX_TYPES][8];
+    uint8_t _typeCount[MAX_TYPES];
+    uint8_t _count;
+};
+
+#endif // SLAVE_REGISTRY_H
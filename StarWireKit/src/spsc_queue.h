@@ -0,0 +1,63 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+/*
+ * Lock-free single-producer/single-consumer ring.
+ *
+ * One side (a timer ISR or a bus task) only calls push(), the other (the
+ * sketch loop) only calls pop(). Each index is written by one side only and
+ * published with release/acquire, so no interrupts are masked and no mutex
+ * is taken; it only needs atomic byte loads and stores, which the ESP8266
+ * has as well as the ESP32 and the host.
+ */
+
+#include <stdint.h>
+#include <atomic>
+
+template <typename T, uint8_t Size>
+class SpscQueue {
+public:
+    static_assert(Size >= 2 && Size <= 128 && (Size & (Size - 1)) == 0, "Size must be a power of two, 2..128");
+
+    SpscQueue() : _head(0), _tail(0), _dropped(0) {}
+
+    /** @brief Producer side. @return false (and counts a drop) if full. */
+    bool push(const T& item) {
+        uint8_t tail = _tail.load(std::memory_order_relaxed);
+        if ((uint8_t)(tail - _head.load(std::memory_order_acquire)) >= Size) {
+            _dropped = _dropped + 1;
+            return false;
+        }
+        _items[tail & (Size - 1)] = item;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief Consumer side. @return false if empty. */
+    bool pop(T& item) {
+        uint8_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = _items[head & (Size - 1)];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint8_t size() const {
+        return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    static uint8_t capacity() { return Size; }
+
+    /** @brief Items the producer could not queue since boot. */
+    uint32_t dropped() const { return _dropped; }
+
+private:
+    T _items[Size];
+    std::atomic<uint8_t> _head;  // written by the consumer only
+    std::atomic<uint8_t> _tail;  // written by the producer only
+    volatile uint32_t _dropped;  // written by the producer only
+};
+
+#endif // SPSC_QUEUE_H
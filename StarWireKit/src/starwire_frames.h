@@ -0,0 +1,38 @@
+#ifndef STARWIRE_FRAMES_H
+#define STARWIRE_FRAMES_H
+
+/*
+ * Command codes of the multi-slave frames built on top of com-prot.
+ *
+ * They travel as ordinary com-prot commands sent to the broadcast id:
+ *   [COM_PROT_COMMAND, 0, code, data...]
+ * Slaves pick them up in their debug receive handler (which sees every
+ * frame) and never register a command handler for them. The codes sit
+ * above the 4-bit powerplant command space.
+ */
+
+#include <stdint.h>
+
+static const uint8_t STARWIRE_BROADCAST_ID = 0;   // PJON_BROADCAST
+
+// com-prot message types, first payload byte of every frame.
+static const uint8_t STARWIRE_MSG_HEARTBEAT = 0x03; // [type, slaveId, slaveType]
+static const uint8_t STARWIRE_MSG_COMMAND = 0x04;   // [type, targetType (0 = unicast), command, data...]
+static const uint8_t STARWIRE_MSG_RESPONSE = 0x05;  // [type, command, data...]
+
+static const uint8_t STARWIRE_CMD_SCENE = 0x50;   // per-slave/per-type cmd4 batch, see scene_frame.h
+static const uint8_t STARWIRE_CMD_FLEET_SYNC = 0x51; // cmd4 of every slave indexed by id, see fleet_state.h
+static const uint8_t STARWIRE_CMD_TELEMETRY = 0x52; // slave -> master response, see telemetry.h
+static const uint8_t STARWIRE_CMD_TDMA_SYNC = 0x53; // master beacon of the slotted mode, see tdma.h
+static const uint8_t STARWIRE_CMD_LINK_STATS = 0x54; // master asks, slave responds with its link counters, see link_stats.h
+
+// Frame overhead com-prot uses (9 bytes: ids, header, length, CRC8, CRC-32).
+static const uint8_t STARWIRE_FRAME_OVERHEAD = 9;
+
+// PJON_PACKET_MAX_LENGTH (50) minus the frame overhead.
+static const uint8_t STARWIRE_MAX_PAYLOAD = 50 - STARWIRE_FRAME_OVERHEAD;
+
+// What is left for data after the 3-byte command header.
+static const uint8_t STARWIRE_MAX_COMMAND_DATA = STARWIRE_MAX_PAYLOAD - 3;
+
+#endif // STARWIRE_FRAMES_H
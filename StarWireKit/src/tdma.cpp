@@ -0,0 +1,52 @@
+#include "tdma.h"
+
+uint8_t tdmaEncodeSync(const TdmaLayout& layout, uint8_t cycle, uint8_t* out) {
+    out[0] = cycle;
+    out[1] = layout.firstSlaveId;
+    out[2] = layout.slotCount;
+    out[3] = (uint8_t)(layout.slotUs / 100);
+    out[4] = (uint8_t)(layout.beaconUs / 100);
+    out[5] = (uint8_t)(layout.masterWindowUs / 1000);
+    return TDMA_SYNC_LENGTH;
+}
+
+bool tdmaParseSync(const uint8_t* data, uint16_t length, TdmaLayout& layout, uint8_t* cycle) {
+    if (length < TDMA_SYNC_LENGTH || data[2] == 0 || data[3] == 0) {
+        return false;
+    }
+    *cycle = data[0];
+    layout.firstSlaveId = data[1];
+    layout.slotCount = data[2];
+    layout.slotUs = data[3] * 100;
+    layout.beaconUs = data[4] * 100;
+    layout.masterWindowUs = data[5] * 1000UL;
+    return true;
+}
+
+void TdmaClock::sync(uint32_t beaconEndUs, const TdmaLayout& layout, uint8_t cycle) {
+    _layout = layout;
+    _beaconEndUs = beaconEndUs;
+    _cycle = cycle;
+    _synced = true;
+}
+
+uint32_t TdmaClock::startUs(uint32_t nowUs, uint32_t offsetUs, uint32_t lengthUs, uint32_t airUs) const {
+    uint32_t cycleUs = _layout.cycleUs();
+    // Start of the cycle we are in, extrapolated if beacons went missing
+    uint32_t cycleStart = _beaconEndUs + (nowUs - _beaconEndUs) / cycleUs * cycleUs;
+    uint32_t windowStart = cycleStart + offsetUs;
+    uint32_t sinceWindow = nowUs - windowStart;
+
+    if ((int32_t)sinceWindow < 0) {
+        return windowStart;
+    }
+    if (airUs + _layout.guardUs > lengthUs) {
+        // Never fits: at least start it first thing (within a guard time,
+        // timers do not hit the window start to the microsecond)
+        return sinceWindow <= _layout.guardUs ? nowUs : windowStart + cycleUs;
+    }
+    if (sinceWindow <= lengthUs - airUs - _layout.guardUs) {
+        return nowUs;
+    }
+    return windowStart + cycleUs;
+}
@@ -0,0 +1,143 @@
+#ifndef TDMA_H
+#define TDMA_H
+
+/*
+ * Time-slotted bus access driven by a master beacon.
+ *
+ * With a dozen plants chattering, PJON's carrier sense and back-off spend
+ * the bus on retries and give no latency bound. In slotted mode the master
+ * broadcasts a sync frame every cycle:
+ *   [COM_PROT_COMMAND, 0, STARWIRE_CMD_TDMA_SYNC,
+ *    cycle, firstSlaveId, slotCount, slot/100 us, beacon/100 us, window/ms]
+ * and everything else is timed from the end of that frame, which every
+ * receiver sees at the same moment:
+ *   | master window | slot firstSlaveId | slot +1 | ... | next beacon |
+ * Commands only start inside the master window, each slave only inside its
+ * own slot (heartbeats, telemetry, responses), and a frame only starts if
+ * it ends a guard time before its window does. The beacon part is padded
+ * to beacon us, so a cycle is always cycleUs() long and a slave that
+ * missed a beacon keeps its slots for SYNC_LOSS_CYCLES cycles.
+ *
+ * Ids outside the slot range, and slaves that have not heard a beacon,
+ * send as before (carrier sense only).
+ *
+ * The timing lives in the bus layer: the BusSimulator com-prot shim runs
+ * it (COM_PROT_TDMA); the pinned com-prot does not yet.
+ */
+
+#include <stdint.h>
+
+#include "starwire_frames.h"
+
+struct TdmaLayout {
+    uint8_t firstSlaveId = 2;          // owns the first slot
+    uint8_t slotCount = 32;            // slaves firstSlaveId .. firstSlaveId + slotCount - 1
+    uint16_t slotUs = 8000;            // a heartbeat with telemetry (~6.9 ms in SWBB mode 1) + guard
+    uint16_t beaconUs = 8500;          // air time of the sync frame, padded
+    uint32_t masterWindowUs = 150000;  // command frames
+    uint16_t guardUs = 500;            // free time a frame leaves before its window ends, not sent
+
+    uint32_t cycleUs() const { return masterWindowUs + (uint32_t)slotCount * slotUs + beaconUs; }
+    bool hasSlot(uint8_t slaveId) const {
+        return slaveId >= firstSlaveId && slaveId - firstSlaveId < slotCount;
+    }
+};
+
+/** @brief Data bytes of a sync frame. */
+static const uint8_t TDMA_SYNC_LENGTH = 6;
+
+/**
+ * @brief Writes the sync frame data (after the 3-byte command header).
+ * @param out At least TDMA_SYNC_LENGTH bytes.
+ * @return Number of bytes written.
+ */
+uint8_t tdmaEncodeSync(const TdmaLayout& layout, uint8_t cycle, uint8_t* out);
+
+/**
+ * @brief Reads received sync frame data. The guard time is the receiver's own.
+ * @param data Bytes after the 3-byte command header.
+ * @return false if malformed.
+ */
+bool tdmaParseSync(const uint8_t* data, uint16_t length, TdmaLayout& layout, uint8_t* cycle);
+
+/**
+ * @brief One side's view of the running cycle, resynchronised on every beacon.
+ *
+ * Times are micros(); only differences are used, so the wrap is harmless.
+ */
+class TdmaClock {
+public:
+    static const uint8_t SYNC_LOSS_CYCLES = 3;
+
+    TdmaClock() : _beaconEndUs(0), _cycle(0), _synced(false) {}
+
+    /** @brief A beacon ended at @p beaconEndUs (the master: its own beacon went out). */
+    void sync(uint32_t beaconEndUs, const TdmaLayout& layout, uint8_t cycle);
+    void reset() { _synced = false; }
+
+    /** @brief Heard a beacon within the last SYNC_LOSS_CYCLES cycles. */
+    bool synced(uint32_t nowUs) const {
+        return _synced && nowUs - _beaconEndUs < SYNC_LOSS_CYCLES * _layout.cycleUs();
+    }
+
+    /** @brief Earliest start at or after @p nowUs for a command frame of @p airUs. */
+    uint32_t masterStartUs(uint32_t nowUs, uint32_t airUs) const {
+        return startUs(nowUs, 0, _layout.masterWindowUs, airUs);
+    }
+
+    /**
+     * @brief Earliest start at or after @p nowUs in the slave's slot.
+     *
+     * A frame longer than the slot (a link stats response) starts within a
+     * guard time of the slot start and overruns it; carrier sense holds the
+     * next slot's owner back.
+     * Only meaningful if layout().hasSlot(slaveId).
+     */
+    uint32_t slotStartUs(uint8_t slaveId, uint32_t nowUs, uint32_t airUs) const {
+        uint32_t offset = _layout.masterWindowUs + (uint32_t)(slaveId - _layout.firstSlaveId) * _layout.slotUs;
+        return startUs(nowUs, offset, _layout.slotUs, airUs);
+    }
+
+    /** @brief When the beacon after the last one has to start to end one cycle later. */
+    uint32_t nextBeaconUs(uint32_t beaconAirUs) const {
+        return _beaconEndUs + _layout.cycleUs() - beaconAirUs;
+    }
+
+    const TdmaLayout& layout() const { return _layout; }
+    uint8_t cycle() const { return _cycle; }
+
+private:
+    uint32_t startUs(uint32_t nowUs, uint32_t offsetUs, uint32_t lengthUs, uint32_t airUs) const;
+
+    TdmaLayout _layout;
+    uint32_t _beaconEndUs;
+    uint8_t _cycle;
+    bool _synced;
+};
+
+/**
+ * @brief Worst case from sendCommand() to the end of the frame at the slave.
+ *
+ * Holds while no more than tdmaWindowCapacity() commands wait at once: a
+ * command that just missed the last start in one window goes out at the
+ * start of the next. @p startDelayUs is the random wait before a start
+ * (SWBB_COLLISION_DELAY).
+ */
+inline uint32_t tdmaCommandBoundUs(const TdmaLayout& layout, uint32_t airUs, uint32_t startDelayUs = 0) {
+    return layout.cycleUs() - layout.masterWindowUs + layout.guardUs + 2 * airUs + startDelayUs;
+}
+
+/** @brief Worst case from a slave queueing a frame to its end at the master, one frame per slot. */
+inline uint32_t tdmaSlotBoundUs(const TdmaLayout& layout, uint32_t airUs, uint32_t startDelayUs = 0) {
+    return layout.cycleUs() - layout.slotUs + layout.guardUs + 2 * airUs + startDelayUs;
+}
+
+/** @brief Command frames of @p airUs that fit one master window (@p gapUs between them). */
+inline uint16_t tdmaWindowCapacity(const TdmaLayout& layout, uint32_t airUs, uint32_t gapUs) {
+    if (airUs + layout.guardUs > layout.masterWindowUs) {
+        return 0;
+    }
+    return (uint16_t)((layout.masterWindowUs - layout.guardUs - airUs) / (airUs + gapUs) + 1);
+}
+
+#endif // TDMA_H
@@ -0,0 +1,98 @@
+#include "telemetry.h"
+
+#include <string.h>
+
+static const uint8_t KEYFRAME = 0x80;
+
+TelemetryEncoder::TelemetryEncoder(uint8_t keyframeInterval)
+    : _keyframeInterval(keyframeInterval ? keyframeInterval : 1) {
+    reset();
+}
+
+void TelemetryEncoder::reset() {
+    _sinceKeyframe = 0;
+    _seq = 0;
+    _output = 0;
+    _status = 0;
+    _started = false;
+}
+
+uint8_t TelemetryEncoder::encode(uint8_t output, uint8_t status, uint8_t* out) {
+    status &= 0x0F;
+    int16_t delta = (int16_t)output - _output;
+    _sinceKeyframe++;
+
+    if (_started && status == _status && _sinceKeyframe < _keyframeInterval) {
+        if (delta == 0) {
+            return 0;
+        }
+        if (delta >= -8 && delta <= 7) {
+            _seq = (_seq + 1) & 0x07;
+            _output = output;
+            out[0] = (uint8_t)((_seq << 4) | (delta & 0x0F));
+            return 1;
+        }
+    }
+
+    _seq = (_seq + 1) & 0x07;
+    _output = output;
+    _status = status;
+    _sinceKeyframe = 0;
+    _started = true;
+    out[0] = (uint8_t)(KEYFRAME | (_seq << 4) | status);
+    out[1] = output;
+    return 2;
+}
+
+TelemetryTable::TelemetryTable() {
+    clear();
+}
+
+void TelemetryTable::clear() {
+    memset(_output, 0, sizeof(_output));
+    memset(_status, 0, sizeof(_status));
+    memset(_seq, 0, sizeof(_seq));
+    memset(_valid, 0, sizeof(_valid));
+    _keyframes = 0;
+    _deltas = 0;
+    _gaps = 0;
+}
+
+bool TelemetryTable::update(uint8_t slaveId, const uint8_t* data, uint8_t length) {
+    if (length == 0) {
+        return false;
+    }
+    uint8_t header = data[0];
+    uint8_t seq = (header >> 4) & 0x07;
+    uint8_t output = _output[slaveId];
+    uint8_t status = _status[slaveId];
+
+    if (header & KEYFRAME) {
+        if (length < 2) {
+            return false;
+        }
+        output = data[1];
+        status = header & 0x0F;
+        _valid[slaveId >> 5] |= 1UL << (slaveId & 31);
+        _keyframes++;
+    } else {
+        // A delta only applies on top of the value right before it
+        if (!valid(slaveId) || seq != ((_seq[slaveId] + 1) & 0x07)) {
+            if (valid(slaveId)) {
+                forget(slaveId);
+                _gaps++;
+            }
+            _seq[slaveId] = seq;
+            return false;
+        }
+        int8_t delta = (int8_t)(header << 4) >> 4;
+        output = (uint8_t)(output + delta);
+        _deltas++;
+    }
+
+    _seq[slaveId] = seq;
+    bool changed = output != _output[slaveId] || status != _status[slaveId];
+    _output[slaveId] = output;
+    _status[slaveId] = status;
+    return changed;
+}
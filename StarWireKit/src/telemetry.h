@@ -0,0 +1,96 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+/*
+ * Plant telemetry: measured output (8 bit) and a status nibble per slave,
+ * carried on the heartbeat the slave sends anyway.
+ *
+ * The master only reads the heartbeat header
+ * [COM_PROT_HEARTBEAT, slaveId, slaveType(, interval)] (heartbeat_schedule.h),
+ * so the telemetry is appended behind it, delta encoded against the last
+ * value sent:
+ *   unchanged                nothing, a plain 3-byte heartbeat
+ *   output moved by -8..+7   [0 | seq:3 | delta:4]
+ *   anything else            [1 | seq:3 | status:4][output]
+ * seq counts the telemetry updates sent. A lost heartbeat shows up as
+ * a seq gap on the next delta; the decoder then drops deltas until the next
+ * full value, which the encoder repeats every keyframeInterval heartbeats.
+ *
+ * Slaves whose com-prot build cannot extend the heartbeat send the same
+ * bytes as [COM_PROT_RESPONSE, STARWIRE_CMD_TELEMETRY, ...] instead, only
+ * when there is something to send.
+ */
+
+#include <stdint.h>
+
+#include "starwire_frames.h"
+
+class TelemetryEncoder {
+public:
+    static const uint8_t MAX_LENGTH = 2;
+
+    explicit TelemetryEncoder(uint8_t keyframeInterval = 10);
+
+    /** @brief Sends the full value with the next heartbeat. */
+    void reset();
+
+    /**
+     * @brief Bytes to append to the heartbeat being sent now.
+     * @param out At least MAX_LENGTH bytes.
+     * @return 0 (unchanged), 1 (delta) or 2 (full value).
+     */
+    uint8_t encode(uint8_t output, uint8_t status, uint8_t* out);
+
+    uint8_t keyframeInterval() const { return _keyframeInterval; }
+
+private:
+    uint8_t _keyframeInterval;
+    uint8_t _sinceKeyframe;
+    uint8_t _seq;
+    uint8_t _output;
+    uint8_t _status;
+    bool _started;
+};
+
+/**
+ * @brief Latest telemetry of every slave on the master, indexed by PJON id.
+ *
+ * Fixed size (~1 KB), no heap.
+ */
+class TelemetryTable {
+public:
+    TelemetryTable();
+
+    void clear();
+
+    /**
+     * @brief Applies the telemetry bytes of one heartbeat or telemetry response.
+     * @param data Bytes after the heartbeat header (parseHeartbeat()) or [COM_PROT_RESPONSE, STARWIRE_CMD_TELEMETRY].
+     * @return true if the slave's output or status changed.
+     */
+    bool update(uint8_t slaveId, const uint8_t* data, uint8_t length);
+
+    /** @brief Drops a slave's reading, e.g. when it timed out. */
+    void forget(uint8_t slaveId) { _valid[slaveId >> 5] &= ~(1UL << (slaveId & 31)); }
+
+    /** @brief A full value arrived and no delta since went missing. */
+    bool valid(uint8_t slaveId) const { return _valid[slaveId >> 5] & (1UL << (slaveId & 31)); }
+
+    uint8_t output(uint8_t slaveId) const { return _output[slaveId]; }
+    uint8_t status(uint8_t slaveId) const { return _status[slaveId]; }
+
+    uint32_t keyframes() const { return _keyframes; }
+    uint32_t deltas() const { return _deltas; }
+    uint32_t gaps() const { return _gaps; } // readings invalidated by a lost heartbeat
+
+private:
+    uint8_t _output[256];
+    uint8_t _status[256];
+    uint8_t _seq[256];
+    uint32_t _valid[8];
+    uint32_t _keyframes;
+    uint32_t _deltas;
+    uint32_t _gaps;
+};
+
+#endif // TELEMETRY_H
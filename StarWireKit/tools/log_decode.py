@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+
+"""
+StarWire binary log decoder
+Turns the record stream written by BinaryLog::drain() (binary_log.h) back
+into text. Plain text in between, such as boot messages, is passed through.
+
+    python3 log_decode.py --events ../../OneWireSlave/include/log_events.h --port /dev/ttyUSB0
+    pio device monitor --raw | python3 log_decode.py --events ../../OneWireSlave/include/log_events.h
+"""
+
+import argparse
+import re
+import sys
+
+SYNC = 0xA5
+LEVELS = {1: "E", 2: "W", 3: "I", 4: "D"}
+EVENT_LINE = re.compile(r'^\s*(\w+)\s*=\s*(\w+)\s*,?\s*//\s*"(.*)"')
+
+
+def load_events(path):
+    """Map event id -> (name, format) from the enum comments in an events header"""
+    events = {}
+    with open(path, encoding="utf-8") as header:
+        for line in header:
+            match = EVENT_LINE.match(line)
+            if match:
+                events[int(match.group(2), 0)] = (match.group(1), match.group(3))
+    return events
+
+
+def read_varint(data, pos):
+    """Returns (value, next position) or (None, pos) if the data ends first"""
+    value = 0
+    shift = 0
+    while pos < len(data) and shift <= 28:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value, pos
+        shift += 7
+    return None, pos
+
+
+def parse_record(data, pos):
+    """Parses a record starting at data[pos] == SYNC.
+    Returns (record, next position), (None, pos) if incomplete, or False if invalid."""
+    if pos + 3 > len(data):
+        return None, pos
+    event = data[pos + 1]
+    level = data[pos + 2] >> 4
+    argc = data[pos + 2] & 0x0F
+    if level not in LEVELS or argc > 4:
+        return False, pos
+    time_ms, cursor = read_varint(data, pos + 3)
+    if time_ms is None:
+        return (None, pos) if cursor >= len(data) else (False, pos)
+    args = []
+    for _ in range(argc):
+        raw, cursor = read_varint(data, cursor)
+        if raw is None:
+            return (None, pos) if cursor >= len(data) else (False, pos)
+        args.append((raw >> 1) ^ -(raw & 1))
+    if cursor >= len(data):
+        return None, pos
+    check = 0
+    for byte in data[pos + 1:cursor]:
+        check ^= byte
+    if check != data[cursor]:
+        return False, pos
+    return (time_ms, LEVELS[level], event, args), cursor + 1
+
+
+def format_record(record, events):
+    time_ms, level, event, args = record
+    name, fmt = events.get(event, (None, None))
+    if fmt is None:
+        text = f"event {event} {args}"
+    else:
+        try:
+            text = fmt.format(*args)
+        except (IndexError, ValueError):
+            text = f"{name} {args}"
+    return f"{time_ms / 1000:10.3f} {level} {text}"
+
+
+class Decoder:
+    def __init__(self, events, out):
+        self.events = events
+        self.out = out
+        self.buffer = bytearray()
+        self.text = bytearray()
+
+    def feed(self, chunk):
+        self.buffer += chunk
+        pos = 0
+        while pos < len(self.buffer):
+            if self.buffer[pos] != SYNC:
+                self.passthrough(self.buffer[pos])
+                pos += 1
+                continue
+            record, end = parse_record(self.buffer, pos)
+            if record is None:
+                break  # wait for the rest of the record
+            if record is False:
+                self.passthrough(self.buffer[pos])
+                pos += 1
+                continue
+            self.flush_text()
+            self.out.write(format_record(record, self.events) + "\n")
+            pos = end
+        del self.buffer[:pos]
+        self.out.flush()
+
+    def passthrough(self, byte):
+        if byte == ord("\n"):
+            self.flush_text()
+        elif byte != ord("\r"):
+            self.text.append(byte)
+
+    def flush_text(self):
+        if self.text:
+            self.out.write(self.text.decode("ascii", "replace") + "\n")
+            self.text.clear()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a StarWire binary log stream")
+    parser.add_argument("--events", required=True, help="Header with the LogEvent enum, e.g. OneWireSlave/include/log_events.h")
+    parser.add_argument("--port", help="Serial port to read (needs pyserial); default is stdin")
+    parser.add_argument("--baud", type=int, default=115200, help="Serial baud rate")
+    parser.add_argument("input", nargs="?", help="Captured log file instead of stdin")
+    args = parser.parse_args()
+
+    decoder = Decoder(load_events(args.events), sys.stdout)
+
+    if args.port:
+        import serial
+        with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+            while True:
+                decoder.feed(port.read(256))
+    else:
+        source = open(args.input, "rb") if args.input else sys.stdin.buffer
+        with source:
+            while True:
+                chunk = source.read1(256) if hasattr(source, "read1") else source.read(256)
+                if not chunk:
+                    break
+                decoder.feed(chunk)
+        decoder.flush_text()
+        sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except KeyboardInterrupt:
+        pass
@@ -9,6 +9,10 @@
 #include <ota.h>
 #include "secrets.h"
 
+#include <heap_watermark.h>
+#include <message_builder.h>
+#include <slave_registry.h>
+
 #define PJON_INCLUDE_SWBB
 #include <PJONSoftwareBitBang.h>
 
@@ -24,15 +28,13 @@ PJON<SoftwareBitBang> bus(1); // Master ID = 1
 #define CMD_TEMP_REQUEST   0x20
 #define CMD_CUSTOM         0x30
 
-// Slave tracking
-struct SlaveInfo {
-    uint8_t id;
-    uint8_t type;
-    unsigned long lastSeen;
-};
+// Slave tracking: indexed by PJON ID, 5 second heartbeat timeout
+SlaveRegistry slaves(5000);
+unsigned long lastHeapSample = 0;
 
-std::vector<SlaveInfo> slaves;
-unsigned long lastSlaveCheck = 0;
+// Heap low-water marks, to confirm sending does not allocate over long sessions
+HeapWatermark heapWatermark;
+uint32_t messagesSent = 0;
 
 void receiver_function(uint8_t *payload, uint16_t length, const PJON_Packet_Info &packet_info) {
     Serial.printf("[RX] From %d: ", packet_info.tx.id);
@@ -53,18 +55,7 @@ void receiver_function(uint8_t *payload, uint16_t length, const PJON_Packet_Info
         uint8_t slaveType = payload[2];
         
         // Update or add slave
-        bool found = false;
-        for (auto& slave : slaves) {
-            if (slave.id == slaveId) {
-                slave.lastSeen = millis();
-                slave.type = slaveType;
-                found = true;
-                break;
-            }
-        }
-        
-        if (!found) {
-            slaves.push_back({slaveId, slaveType, millis()});
+        if (slaves.heartbeat(slaveId, slaveType, millis())) {
             Serial.printf("New slave discovered: ID=%d, Type=%d\n", slaveId, slaveType);
             WebSerial.printf("New slave: ID=%d, Type=%d\n", slaveId, slaveType);
             WebSerial.flush();
@@ -99,84 +90,78 @@ void setup() {
 }
 
 void sendBroadcastCommand(uint8_t slaveType, uint8_t command, uint8_t* data = nullptr, uint8_t dataLen = 0) {
-    uint8_t messageLen = 3 + dataLen; // MSG_COMMAND + slaveType + command + data
-    uint8_t* message = new uint8_t[messageLen];
-    
-    message[0] = MSG_COMMAND;
-    message[1] = slaveType;  // Target slave type
-    message[2] = command;
-    
-    if (data && dataLen > 0) {
-        memcpy(&message[3], data, dataLen);
+    MessageBuilder<> message; // MSG_COMMAND + slaveType + command + data
+    message.command(slaveType, command).put(data, dataLen);
+    if (!message.ok()) {
+        Serial.printf("[TX] Broadcast dropped, %d data bytes do not fit\n", dataLen);
+        return;
     }
     
     Serial.printf("[TX] Broadcasting to type %d: ", slaveType);
-    for (uint8_t i = 0; i < messageLen; i++) {
-        Serial.printf("0x%02X ", message[i]);
+    for (uint8_t i = 0; i < message.length(); i++) {
+        Serial.printf("0x%02X ", message.data()[i]);
     }
     Serial.println();
     
     WebSerial.printf("[TX] Broadcast to type %d: ", slaveType);
-    for (uint8_t i = 0; i < messageLen; i++) {
-        WebSerial.printf("0x%02X ", message[i]);
+    for (uint8_t i = 0; i < message.length(); i++) {
+        WebSerial.printf("0x%02X ", message.data()[i]);
     }
     WebSerial.println();
     WebSerial.flush();
     
     // Send broadcast
-    uint16_t result = bus.send_packet(10, message, messageLen);
+    uint16_t result = bus.send_packet(10, message.data(), message.length());
+    messagesSent++;
     
     Serial.printf("Broadcast result: %d %s\n", result, (result == PJON_ACK) ? "SUCCESS" : "FAILED");
     WebSerial.printf("Result: %s\n", (result == PJON_ACK) ? "SUCCESS" : "FAILED");
     WebSerial.flush();
-    
-    delete[] message;
 }
 
 void sendUnicastCommand(uint8_t slaveId, uint8_t command, uint8_t* data = nullptr, uint8_t dataLen = 0) {
-    uint8_t messageLen = 3 + dataLen; // MSG_COMMAND + 0 + command + data
-    uint8_t* message = new uint8_t[messageLen];
-    
-    message[0] = MSG_COMMAND;
-    message[1] = 0;  // 0 = unicast
-    message[2] = command;
-    
-    if (data && dataLen > 0) {
-        memcpy(&message[3], data, dataLen);
+    MessageBuilder<> message; // MSG_COMMAND + 0 (unicast) + command + data
+    message.command(0, command).put(data, dataLen);
+    if (!message.ok()) {
+        Serial.printf("[TX] Unicast dropped, %d data bytes do not fit\n", dataLen);
+        return;
     }
     
     Serial.printf("[TX] Unicast to slave %d: ", slaveId);
-    for (uint8_t i = 0; i < messageLen; i++) {
-        Serial.printf("0x%02X ", message[i]);
+    for (uint8_t i = 0; i < message.length(); i++) {
+        Serial.printf("0x%02X ", message.data()[i]);
     }
     Serial.println();
     
     WebSerial.printf("[TX] Unicast to slave %d: ", slaveId);
-    for (uint8_t i = 0; i < messageLen; i++) {
-        WebSerial.printf("0x%02X ", message[i]);
+    for (uint8_t i = 0; i < message.length(); i++) {
+        WebSerial.printf("0x%02X ", message.data()[i]);
     }
     WebSerial.println();
     WebSerial.flush();
     
     // Send unicast
-    uint16_t result = bus.send(slaveId, message, messageLen);
+    uint16_t result = bus.send(slaveId, message.data(), message.length());
+    messagesSent++;
     
     Serial.printf("Unicast result: %d %s\n", result, (result == PJON_ACK) ? "SUCCESS" : "FAILED");
     WebSerial.printf("Result: %s\n", (result == PJON_ACK) ? "SUCCESS" : "FAILED");
     WebSerial.flush();
-    
-    delete[] message;
 }
 
-void removeTimedOutSlaves() {
-    unsigned long currentTime = millis();
-    slaves.erase(
-        std::remove_if(slaves.begin(), slaves.end(),
-            [currentTime](const SlaveInfo& slave) {
-                return (currentTime - slave.lastSeen) > 5000; // 5 second timeout
-            }),
-        slaves.end()
-    );
+void reportHeap() {
+    Serial.printf("Heap: free %u (min %u, drift %d), largest block min %u, %u messages sent\n",
+                  heapWatermark.lastFree(), heapWatermark.minFree(), heapWatermark.drift(),
+                  heapWatermark.minLargestBlock(), messagesSent);
+    WebSerial.printf("Heap: free %u (min %u), block min %u, msgs %u\n",
+                     heapWatermark.lastFree(), heapWatermark.minFree(),
+                     heapWatermark.minLargestBlock(), messagesSent);
+    WebSerial.flush();
+}
+
+void onSlaveTimedOut(uint8_t slaveId, uint8_t slaveType) {
+    Serial.printf("Slave timed out: ID=%d, Type=%d\n", slaveId, slaveType);
+    WebSerial.printf("Slave lost: ID=%d, Type=%d\n", slaveId, slaveType);
 }
 
 void loop() {
@@ -184,35 +169,30 @@ void loop() {
     bus.update();
     bus.receive();
     
-    // Remove timed out slaves every second
-    if (millis() - lastSlaveCheck > 1000) {
-        removeTimedOutSlaves();
-        lastSlaveCheck = millis();
+    // Remove timed out slaves; only looks at wheel slots that came due
+    slaves.expire(millis(), onSlaveTimedOut);
+    
+    if (millis() - lastHeapSample > 1000) {
+        heapWatermark.sample(ESP.getFreeHeap(), ESP.getMaxFreeBlockSize());
+        lastHeapSample = millis();
     }
     
     // Send test commands every 10 seconds
     static unsigned long lastCommand = 0;
     if (millis() - lastCommand > 9300) {
         
-        Serial.printf("Active slaves: %d\n", slaves.size());
-        WebSerial.printf("Active slaves: %d\n", slaves.size());
+        Serial.printf("Active slaves: %d\n", slaves.count());
+        WebSerial.printf("Active slaves: %d\n", slaves.count());
         
-        for (const auto& slave : slaves) {
-            Serial.printf("  Slave ID=%d, Type=%d\n", slave.id, slave.type);
-            WebSerial.printf("  ID=%d, Type=%d\n", slave.id, slave.type);
-        }
+        slaves.forEachSlave([](uint8_t id, uint8_t type) {
+            Serial.printf("  Slave ID=%d, Type=%d\n", id, type);
+            WebSerial.printf("  ID=%d, Type=%d\n", id, type);
+        });
         WebSerial.flush();
+        reportHeap();
         
         // Test 1: LED toggle broadcast to type 1 slaves
-        bool hasType1 = false;
-        for (const auto& slave : slaves) {
-            if (slave.type == 1) {
-                hasType1 = true;
-                break;
-            }
-        }
-        
-        if (hasType1) {
+        if (slaves.hasSlaveOfType(1)) {
             uint8_t ledState = (millis() / 10000) % 2;
             Serial.printf("Sending LED broadcast (state=%d) to type 1 slaves\n", ledState);
             WebSerial.printf("LED broadcast: %s\n", ledState ? "ON" : "OFF");
@@ -220,30 +200,14 @@ void loop() {
         }
         
         // Test 2: Temperature request broadcast to type 2 slaves
-        bool hasType2 = false;
-        for (const auto& slave : slaves) {
-            if (slave.type == 2) {
-                hasType2 = true;
-                break;
-            }
-        }
-        
-        if (hasType2) {
+        if (slaves.hasSlaveOfType(2)) {
             Serial.println("Sending temperature request broadcast to type 2 slaves");
             WebSerial.println("Temperature request broadcast");
             sendBroadcastCommand(2, CMD_TEMP_REQUEST);
         }
         
         // Test 3: Custom command unicast to specific slave
-        bool hasSlaveId10 = false;
-        for (const auto& slave : slaves) {
-            if (slave.id == 10) {
-                hasSlaveId10 = true;
-                break;
-            }
-        }
-        
-        if (hasSlaveId10) {
+        if (slaves.isOnline(10)) {
             uint8_t customData[] = {0xAA, 0xBB, 0xCC, 0xDD};
             Serial.println("Sending custom unicast command to slave 10");
             WebSerial.println("Custom unicast to slave 10");
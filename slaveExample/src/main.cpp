@@ -9,6 +9,9 @@
 #include <ota.h>
 #include "secrets.h"
 
+#include <heap_watermark.h>
+#include <message_builder.h>
+
 #define PJON_INCLUDE_SWBB
 #include <PJONSoftwareBitBang.h>
 
@@ -46,6 +49,9 @@ unsigned long blinkStartTime = 0;
 unsigned long lastHeartbeat = 0;
 const unsigned long heartbeatInterval = 1000; // 1 second
 
+// Heap low-water marks, to confirm sending does not allocate over long sessions
+HeapWatermark heapWatermark;
+
 void receiver_function(uint8_t *payload, uint16_t length, const PJON_Packet_Info &packet_info) {
     Serial.printf("[RX] From %d: ", packet_info.tx.id);
     for (uint16_t i = 0; i < length; i++) {
@@ -90,13 +96,11 @@ void receiver_function(uint8_t *payload, uint16_t length, const PJON_Packet_Info
                         Serial.printf("Temperature request - sending %.2f°C\n", temperature);
                         WebSerial.printf("Temp: %.2f°C\n", temperature);
                         
-                        // Send response back
-                        uint8_t response[6];
-                        response[0] = MSG_COMMAND;
-                        response[1] = 0; // Response (unicast)
-                        memcpy(&response[2], &temperature, sizeof(temperature));
+                        // Send response back: MSG_COMMAND + 0 (unicast) + float
+                        MessageBuilder<6> response;
+                        response.put(MSG_COMMAND).put(0).putValue(temperature);
                         
-                        uint16_t result = bus.send(1, response, sizeof(response)); // Send to master (ID=1)
+                        uint16_t result = bus.send(1, response.data(), response.length()); // Send to master (ID=1)
                         Serial.printf("Temperature response sent: %s\n", (result == PJON_ACK) ? "SUCCESS" : "FAILED");
                         WebSerial.flush();
                     }
@@ -136,11 +140,12 @@ void receiver_function(uint8_t *payload, uint16_t length, const PJON_Packet_Info
 }
 
 void sendHeartbeat() {
-    uint8_t heartbeat[3] = {MSG_HEARTBEAT, SLAVE_ID, SLAVE_TYPE};
+    MessageBuilder<3> heartbeat;
+    heartbeat.heartbeat(SLAVE_ID, SLAVE_TYPE);
     
     WebSerial.printf("[TX] Heartbeat: ID=%d, Type=%d\n", SLAVE_ID, SLAVE_TYPE);
     
-    uint16_t result = bus.send(1, heartbeat, sizeof(heartbeat)); // Send to master (ID=1)
+    uint16_t result = bus.send(1, heartbeat.data(), heartbeat.length()); // Send to master (ID=1)
     
     // Only log failed heartbeats to reduce spam
 }
@@ -216,8 +221,11 @@ void loop() {
     // Status indication
     static unsigned long lastStatus = 0;
     if (millis() - lastStatus > 30000) { // Every 30 seconds
-        Serial.println("Slave alive and listening");
-        WebSerial.println("Slave alive");
+        heapWatermark.sample(ESP.getFreeHeap(), ESP.getMaxFreeBlockSize());
+        Serial.printf("Slave alive and listening, heap free %u (min %u, drift %d), largest block min %u\n",
+                      heapWatermark.lastFree(), heapWatermark.minFree(), heapWatermark.drift(),
+                      heapWatermark.minLargestBlock());
+        WebSerial.printf("Slave alive, heap min %u\n", heapWatermark.minFree());
         WebSerial.flush();
         lastStatus = millis();
     }